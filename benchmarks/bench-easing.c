@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ * SPDX-License-Identifier: GPL-3.0+
+ *
+ * Micro benchmark for the easing functions. Simulates a number of
+ * views animating several properties each for a couple of frames.
+ */
+
+#include "anim/easing.h"
+
+#define N_ANIMATIONS 64
+#define N_PROPERTIES 4
+#define N_FRAMES     10000
+#define N_VALUES     (N_ANIMATIONS * N_PROPERTIES)
+
+typedef enum {
+  BENCH_MODE_EASE,
+  BENCH_MODE_EASE_FAST,
+  BENCH_MODE_BATCH,
+} BenchMode;
+
+static const char *mode_names[] = { "ease", "ease-fast", "batch" };
+
+static volatile double sink;
+
+
+static double
+run (PhocEasing easing, BenchMode mode)
+{
+  double values[N_VALUES], results[N_VALUES];
+  g_autoptr (GTimer) timer = g_timer_new ();
+  double sum = 0;
+
+  for (guint frame = 0; frame < N_FRAMES; frame++) {
+    /* Stagger the animations so they're all at a different progress */
+    for (guint i = 0; i < N_VALUES; i++)
+      values[i] = (double)((frame + i * 37) % N_FRAMES) / (N_FRAMES - 1);
+
+    switch (mode) {
+    case BENCH_MODE_EASE:
+      for (guint i = 0; i < N_VALUES; i++)
+        results[i] = phoc_easing_ease (easing, values[i]);
+      break;
+    case BENCH_MODE_EASE_FAST:
+      for (guint i = 0; i < N_VALUES; i++)
+        results[i] = phoc_easing_ease_fast (easing, values[i]);
+      break;
+    case BENCH_MODE_BATCH:
+      phoc_easing_ease_batch (easing, values, results, N_VALUES);
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+    sum += results[frame % N_VALUES];
+  }
+  sink = sum;
+
+  return g_timer_elapsed (timer, NULL) * 1e9 / ((double) N_FRAMES * N_VALUES);
+}
+
+
+gint
+main (gint argc, gchar *argv[])
+{
+  GEnumClass *enum_class = g_type_class_ref (PHOC_TYPE_EASING);
+
+  g_print ("%-32s", "easing (ns/value)");
+  for (BenchMode mode = BENCH_MODE_EASE; mode <= BENCH_MODE_BATCH; mode++)
+    g_print ("%12s", mode_names[mode]);
+  g_print ("\n");
+
+  for (guint i = 0; i < enum_class->n_values; i++) {
+    PhocEasing easing = enum_class->values[i].value;
+
+    g_print ("%-32s", enum_class->values[i].value_nick);
+    for (BenchMode mode = BENCH_MODE_EASE; mode <= BENCH_MODE_BATCH; mode++)
+      g_print ("%12.2f", run (easing, mode));
+    g_print ("\n");
+  }
+
+  g_type_class_unref (enum_class);
+
+  return 0;
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ * SPDX-License-Identifier: GPL-3.0+
+ *
+ * A draggable layer surface on top of some toplevels that keeps
+ * sliding in and out like phosh's top and home bars.
+ */
+
+#include "benchlib.h"
+#include "testlib-layer-shell.h"
+
+#define HEIGHT 600
+#define FOLDED  50
+
+typedef struct {
+  gboolean done;
+  uint32_t state;
+} SlideState;
+
+
+static void
+drag_surface_handle_drag_end (void                                    *data,
+                              struct zphoc_draggable_layer_surface_v1 *drag_surface,
+                              uint32_t                                 state)
+{
+  SlideState *slide = data;
+
+  slide->state = state;
+  slide->done = TRUE;
+}
+
+
+static void
+drag_surface_handle_dragged (void                                    *data,
+                             struct zphoc_draggable_layer_surface_v1 *drag_surface,
+                             int32_t                                  margin)
+{
+}
+
+
+static const struct zphoc_draggable_layer_surface_v1_listener drag_surface_listener = {
+  .drag_end = drag_surface_handle_drag_end,
+  .dragged = drag_surface_handle_dragged,
+};
+
+
+static gboolean
+bench_client_layer_slide (PhocTestClientGlobals *globals, gpointer data)
+{
+  PhocBench *bench = data;
+  GRand *rand = phoc_bench_get_rand (bench);
+  guint n_views = phoc_bench_get_n_views (bench);
+  g_autoptr (GPtrArray) toplevels = NULL;
+  struct zphoc_draggable_layer_surface_v1 *drag_surface;
+  PhocTestLayerSurface *ls;
+  SlideState slide = { 0 };
+
+  /* Something to slide across */
+  toplevels = g_ptr_array_new_with_free_func ((GDestroyNotify)phoc_test_xdg_toplevel_free);
+  for (guint i = 0; i < n_views; i++) {
+    g_autofree char *title = g_strdup_printf ("toplevel-%u", i);
+
+    g_ptr_array_add (toplevels,
+                     phoc_test_xdg_toplevel_new_with_buffer (globals, 0, 0, title,
+                                                             0xFF000000 | g_rand_int (rand)));
+  }
+
+  ls = phoc_test_layer_surface_new (globals, 0, HEIGHT, 0xFF00FF00,
+                                    ZWLR_LAYER_SURFACE_V1_ANCHOR_TOP |
+                                    ZWLR_LAYER_SURFACE_V1_ANCHOR_LEFT |
+                                    ZWLR_LAYER_SURFACE_V1_ANCHOR_RIGHT,
+                                    FOLDED);
+  drag_surface = zphoc_layer_shell_effects_v1_get_draggable_layer_surface (
+    globals->layer_shell_effects, ls->layer_surface);
+  zphoc_draggable_layer_surface_v1_add_listener (drag_surface, &drag_surface_listener, &slide);
+  zphoc_draggable_layer_surface_v1_set_margins (drag_surface, -(HEIGHT - FOLDED), 0);
+  zphoc_draggable_layer_surface_v1_set_exclusive (drag_surface, FOLDED);
+  wl_surface_commit (ls->wl_surface);
+  wl_display_roundtrip (globals->display);
+
+  /* Without a margin the surface starts out unfolded */
+  slide.state = ZPHOC_DRAGGABLE_LAYER_SURFACE_V1_DRAG_END_STATE_UNFOLDED;
+  phoc_bench_start (bench);
+  while (!phoc_bench_is_done (bench)) {
+    uint32_t target = slide.state == ZPHOC_DRAGGABLE_LAYER_SURFACE_V1_DRAG_END_STATE_FOLDED ?
+      ZPHOC_DRAGGABLE_LAYER_SURFACE_V1_DRAG_END_STATE_UNFOLDED :
+      ZPHOC_DRAGGABLE_LAYER_SURFACE_V1_DRAG_END_STATE_FOLDED;
+    gint64 start = g_get_monotonic_time ();
+
+    slide.done = FALSE;
+    zphoc_draggable_layer_surface_v1_set_state (drag_surface, target);
+    wl_surface_commit (ls->wl_surface);
+
+    while (!slide.done && wl_display_dispatch (globals->display) != -1) {
+      /* Main loop */
+    }
+    g_assert_true (slide.done);
+    g_assert_cmpint (slide.state, ==, target);
+
+    phoc_bench_add_sample (bench, "slide-duration-us", g_get_monotonic_time () - start);
+  }
+
+  zphoc_draggable_layer_surface_v1_destroy (drag_surface);
+  phoc_test_layer_surface_free (ls);
+
+  return TRUE;
+}
+
+
+gint
+main (gint argc, gchar *argv[])
+{
+  g_autoptr (PhocBench) bench = phoc_bench_new ("layer-slide", &argc, &argv);
+
+  phoc_bench_run (bench, bench_client_layer_slide);
+
+  return 0;
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ * SPDX-License-Identifier: GPL-3.0+
+ *
+ * Floods the compositor with pointer strokes from a virtual pointer
+ * while a toplevel keeps redrawing. This mimics fast touch input as
+ * input devices send events at a much higher rate than the display
+ * refreshes.
+ */
+
+#include "benchlib.h"
+
+#include <linux/input-event-codes.h>
+
+#define WIDTH             800
+#define HEIGHT            600
+#define EVENTS_PER_FRAME   16
+#define FRAMES_PER_STROKE  30
+#define STEP               8
+
+
+static gboolean
+bench_client_pointer_storm (PhocTestClientGlobals *globals, gpointer data)
+{
+  PhocBench *bench = data;
+  GRand *rand = phoc_bench_get_rand (bench);
+  struct zwlr_virtual_pointer_v1 *pointer;
+  PhocTestXdgToplevelSurface *xs;
+  guint32 extent_x, extent_y;
+  int x, y;
+
+  g_assert_nonnull (globals->virtual_pointer_manager);
+
+  xs = phoc_test_xdg_toplevel_new_with_buffer (globals, WIDTH, HEIGHT, "storm", 0xFF00FF00);
+  pointer = zwlr_virtual_pointer_manager_v1_create_virtual_pointer (globals->virtual_pointer_manager,
+                                                                    NULL);
+  extent_x = globals->output.width;
+  extent_y = globals->output.height;
+  x = extent_x / 2;
+  y = extent_y / 2;
+
+  phoc_bench_start (bench);
+  for (guint frame = 0; !phoc_bench_is_done (bench); frame++) {
+    guint32 time = g_get_monotonic_time () / 1000;
+    guint32 color = 0xFF000000 | g_rand_int (rand);
+
+    if (frame % FRAMES_PER_STROKE == 0) {
+      zwlr_virtual_pointer_v1_button (pointer, time, BTN_LEFT, WL_POINTER_BUTTON_STATE_PRESSED);
+      zwlr_virtual_pointer_v1_frame (pointer);
+    }
+
+    /* A random walk so events come in like from a finger */
+    for (guint i = 0; i < EVENTS_PER_FRAME; i++) {
+      x = CLAMP (x + g_rand_int_range (rand, -STEP, STEP + 1), 0, extent_x - 1);
+      y = CLAMP (y + g_rand_int_range (rand, -STEP, STEP + 1), 0, extent_y - 1);
+      zwlr_virtual_pointer_v1_motion_absolute (pointer, time, x, y, extent_x, extent_y);
+      zwlr_virtual_pointer_v1_frame (pointer);
+    }
+
+    if (frame % FRAMES_PER_STROKE == FRAMES_PER_STROKE - 1) {
+      zwlr_virtual_pointer_v1_button (pointer, time, BTN_LEFT, WL_POINTER_BUTTON_STATE_RELEASED);
+      zwlr_virtual_pointer_v1_frame (pointer);
+    }
+
+    /* Like a client drawing the stroke */
+    *(guint32 *)(xs->buffer.shm_data + (y % xs->height) * xs->buffer.stride
+                 + (x % xs->width) * 4) = color;
+    wl_surface_attach (xs->wl_surface, xs->buffer.wl_buffer, 0, 0);
+    wl_surface_damage_buffer (xs->wl_surface, x % xs->width, y % xs->height, 1, 1);
+    phoc_bench_wait_frame (globals, xs->wl_surface);
+  }
+
+  zwlr_virtual_pointer_v1_destroy (pointer);
+  phoc_test_xdg_toplevel_free (xs);
+
+  return TRUE;
+}
+
+
+gint
+main (gint argc, gchar *argv[])
+{
+  g_autoptr (PhocBench) bench = phoc_bench_new ("pointer-storm", &argc, &argv);
+
+  phoc_bench_run (bench, bench_client_pointer_storm);
+
+  return 0;
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ * SPDX-License-Identifier: GPL-3.0+
+ *
+ * Mostly static toplevels. Run with `--unthrottled` to measure how
+ * many full repaints per second the compositor manages for a given
+ * output size, e.g.
+ *
+ *   bench-render --unthrottled --mode 1920x1080
+ */
+
+#include "benchlib.h"
+
+
+static gboolean
+bench_client_render (PhocTestClientGlobals *globals, gpointer data)
+{
+  PhocBench *bench = data;
+  GRand *rand = phoc_bench_get_rand (bench);
+  guint n_views = phoc_bench_get_n_views (bench);
+  g_autoptr (GPtrArray) toplevels = NULL;
+  PhocTestXdgToplevelSurface *xs;
+
+  toplevels = g_ptr_array_new_with_free_func ((GDestroyNotify)phoc_test_xdg_toplevel_free);
+  for (guint i = 0; i < n_views; i++) {
+    g_autofree char *title = g_strdup_printf ("toplevel-%u", i);
+    guint32 width = globals->output.width / g_rand_int_range (rand, 1, 4);
+    guint32 height = globals->output.height / g_rand_int_range (rand, 1, 4);
+
+    g_ptr_array_add (toplevels,
+                     phoc_test_xdg_toplevel_new_with_buffer (globals, width, height, title,
+                                                             0xFF000000 | g_rand_int (rand)));
+  }
+
+  phoc_bench_start (bench);
+  xs = g_ptr_array_index (toplevels, 0);
+  for (guint frame = 0; !phoc_bench_is_done (bench); frame++) {
+    /* Flip a single pixel so there's a frame even when throttled */
+    *(guint32 *)xs->buffer.shm_data = frame;
+    wl_surface_attach (xs->wl_surface, xs->buffer.wl_buffer, 0, 0);
+    wl_surface_damage_buffer (xs->wl_surface, 0, 0, 1, 1);
+    phoc_bench_wait_frame (globals, xs->wl_surface);
+  }
+
+  return TRUE;
+}
+
+
+gint
+main (gint argc, gchar *argv[])
+{
+  g_autoptr (PhocBench) bench = phoc_bench_new ("render", &argc, &argv);
+
+  phoc_bench_run (bench, bench_client_render);
+
+  return 0;
+}
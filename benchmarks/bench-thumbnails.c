@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ * SPDX-License-Identifier: GPL-3.0+
+ *
+ * Requests thumbnails of all toplevels in a burst like phosh's
+ * overview does while the toplevels keep redrawing.
+ */
+
+#include "benchlib.h"
+
+#define WIDTH           480
+#define HEIGHT          640
+#define THUMBNAIL_SIZE  150
+
+
+static void
+get_thumbnail (PhocTestClientGlobals *globals, PhocTestXdgToplevelSurface *xs)
+{
+  PhocTestScreencopyFrame thumbnail = { 0 };
+  struct zwlr_screencopy_frame_v1 *handle;
+
+  handle = phosh_private_get_thumbnail (globals->phosh,
+                                        xs->foreign_toplevel->handle,
+                                        THUMBNAIL_SIZE,
+                                        THUMBNAIL_SIZE);
+  phoc_test_client_capture_frame (globals, &thumbnail, handle);
+  zwlr_screencopy_frame_v1_destroy (handle);
+  phoc_test_buffer_free (&thumbnail.buffer);
+}
+
+
+static gboolean
+bench_client_thumbnails (PhocTestClientGlobals *globals, gpointer data)
+{
+  PhocBench *bench = data;
+  GRand *rand = phoc_bench_get_rand (bench);
+  guint n_views = phoc_bench_get_n_views (bench);
+  g_autoptr (GPtrArray) toplevels = NULL;
+
+  toplevels = g_ptr_array_new_with_free_func ((GDestroyNotify)phoc_test_xdg_toplevel_free);
+  for (guint i = 0; i < n_views; i++) {
+    g_autofree char *title = g_strdup_printf ("toplevel-%u", i);
+
+    g_ptr_array_add (toplevels,
+                     phoc_test_xdg_toplevel_new_with_buffer (globals, WIDTH, HEIGHT, title,
+                                                             0xFF000000 | g_rand_int (rand)));
+  }
+
+  phoc_bench_start (bench);
+  while (!phoc_bench_is_done (bench)) {
+    PhocTestXdgToplevelSurface *xs;
+    gint64 start = g_get_monotonic_time ();
+
+    for (guint i = 0; i < n_views; i++) {
+      gint64 thumbnail_start = g_get_monotonic_time ();
+
+      get_thumbnail (globals, g_ptr_array_index (toplevels, i));
+      phoc_bench_add_sample (bench, "thumbnail-us", g_get_monotonic_time () - thumbnail_start);
+    }
+    phoc_bench_add_sample (bench, "burst-us", g_get_monotonic_time () - start);
+
+    /* Make sure there's fresh content for the next burst */
+    xs = g_ptr_array_index (toplevels, g_rand_int_range (rand, 0, n_views));
+    memset (xs->buffer.shm_data, g_rand_int (rand) & 0xFF, xs->buffer.stride * xs->height);
+    wl_surface_attach (xs->wl_surface, xs->buffer.wl_buffer, 0, 0);
+    wl_surface_damage_buffer (xs->wl_surface, 0, 0, xs->width, xs->height);
+    phoc_bench_wait_frame (globals, xs->wl_surface);
+  }
+
+  return TRUE;
+}
+
+
+gint
+main (gint argc, gchar *argv[])
+{
+  g_autoptr (PhocBench) bench = phoc_bench_new ("thumbnails", &argc, &argv);
+
+  phoc_bench_run (bench, bench_client_thumbnails);
+
+  return 0;
+}
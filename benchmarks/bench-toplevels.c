@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ * SPDX-License-Identifier: GPL-3.0+
+ *
+ * A number of overlapping toplevels that redraw random parts of
+ * their surface every frame.
+ */
+
+#include "benchlib.h"
+
+#define WIDTH  320
+#define HEIGHT 240
+
+
+static void
+damage_random (GRand *rand, PhocTestXdgToplevelSurface *xs)
+{
+  int width = g_rand_int_range (rand, 1, xs->width + 1);
+  int height = g_rand_int_range (rand, 1, xs->height + 1);
+  int x = g_rand_int_range (rand, 0, xs->width - width + 1);
+  int y = g_rand_int_range (rand, 0, xs->height - height + 1);
+  guint32 color = 0xFF000000 | g_rand_int (rand);
+
+  for (int j = y; j < y + height; j++) {
+    guint32 *row = (guint32 *)(xs->buffer.shm_data + j * xs->buffer.stride);
+
+    for (int i = x; i < x + width; i++)
+      row[i] = color;
+  }
+
+  wl_surface_attach (xs->wl_surface, xs->buffer.wl_buffer, 0, 0);
+  wl_surface_damage_buffer (xs->wl_surface, x, y, width, height);
+}
+
+
+static gboolean
+bench_client_toplevels (PhocTestClientGlobals *globals, gpointer data)
+{
+  PhocBench *bench = data;
+  GRand *rand = phoc_bench_get_rand (bench);
+  guint n_views = phoc_bench_get_n_views (bench);
+  g_autoptr (GPtrArray) toplevels = NULL;
+
+  toplevels = g_ptr_array_new_with_free_func ((GDestroyNotify)phoc_test_xdg_toplevel_free);
+  for (guint i = 0; i < n_views; i++) {
+    g_autofree char *title = g_strdup_printf ("toplevel-%u", i);
+    PhocTestXdgToplevelSurface *xs;
+
+    xs = phoc_test_xdg_toplevel_new_with_buffer (globals, WIDTH, HEIGHT, title,
+                                                 0xFF000000 | g_rand_int (rand));
+    g_ptr_array_add (toplevels, xs);
+  }
+
+  phoc_bench_start (bench);
+  while (!phoc_bench_is_done (bench)) {
+    guint n_damaged = g_rand_int_range (rand, 1, n_views + 1);
+    PhocTestXdgToplevelSurface *xs = NULL;
+
+    for (guint i = 0; i < n_damaged; i++) {
+      xs = g_ptr_array_index (toplevels, g_rand_int_range (rand, 0, n_views));
+      damage_random (rand, xs);
+      /* The last one is committed when waiting for the frame */
+      if (i + 1 < n_damaged)
+        wl_surface_commit (xs->wl_surface);
+    }
+    phoc_bench_wait_frame (globals, xs->wl_surface);
+  }
+
+  return TRUE;
+}
+
+
+gint
+main (gint argc, gchar *argv[])
+{
+  g_autoptr (PhocBench) bench = phoc_bench_new ("toplevels", &argc, &argv);
+
+  phoc_bench_run (bench, bench_client_toplevels);
+
+  return 0;
+}
@@ -0,0 +1,543 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ * SPDX-License-Identifier: GPL-3.0+
+ */
+
+#include "alloc-counter.h"
+#include "benchlib.h"
+#include "output.h"
+#include "render.h"
+
+#include <glib/gstdio.h>
+#include <time.h>
+
+#include <wlr/interfaces/wlr_output.h>
+
+#define DEFAULT_N_FRAMES 300
+#define DEFAULT_N_VIEWS  8
+#define DEFAULT_SEED     0x5eed
+#define DEFAULT_MODE     "1024x768"
+
+/**
+ * PhocBench:
+ *
+ * Runs a benchmark scenario against a compositor using the headless
+ * backend and collects per frame statistics.
+ *
+ * The scenario is a test client function that generates load. Once the
+ * scenario's setup is done it calls phoc_bench_start() and from then on
+ * the wall clock time, the CPU time and the number of allocations of
+ * every rendered frame are recorded. Allocations are only counted when
+ * built with `-Dalloc-counter=true`. Scenarios can record additional
+ * metrics via phoc_bench_add_sample().
+ *
+ * By default the output renders at its refresh rate like on real
+ * hardware. In unthrottled mode every frame is a full repaint started
+ * as soon as the previous one finished so the results show the raw
+ * compositing throughput for the given output size.
+ *
+ * The results are printed as a single line of JSON on stdout so they
+ * can be collected and compared across releases.
+ */
+struct _PhocBench {
+  char               *name;
+  int                 n_frames;
+  int                 n_views;
+  int                 seed;
+  char               *mode;
+  gboolean            unthrottled;
+  char               *output_file;
+
+  GRand              *rand;
+  GTestDBus          *bus;
+  char               *tmpdir;
+  PhocTestClientFunc  client_run;
+
+  GMutex              lock;
+  GPtrArray          *metrics;
+
+  /* Frame accounting, only touched in the compositor's thread */
+  int                 recording;
+  int                 n_rendered;
+  gint64              start_us;
+  gint64              end_us;
+  gboolean            in_frame;
+  gint64              frame_start_us;
+  gint64              frame_cpu_start_us;
+  guint64             frame_allocs_start;
+  PhocOutput         *output;
+  guint               force_frame_id;
+};
+
+typedef struct {
+  char   *name;
+  GArray *values;
+} PhocBenchMetric;
+
+
+
+static gint64
+get_thread_cpu_time (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec * G_USEC_PER_SEC + ts.tv_nsec / 1000;
+}
+
+
+static void
+phoc_bench_metric_free (PhocBenchMetric *metric)
+{
+  g_free (metric->name);
+  g_array_unref (metric->values);
+  g_free (metric);
+}
+
+
+static int
+compare_double (gconstpointer a, gconstpointer b)
+{
+  double da = *(const double *)a, db = *(const double *)b;
+
+  return (da > db) - (da < db);
+}
+
+
+static double
+get_percentile (GArray *sorted, guint percentile)
+{
+  guint index;
+
+  /* Nearest rank */
+  index = (sorted->len * percentile + 99) / 100;
+  index = CLAMP (index, 1, sorted->len) - 1;
+
+  return g_array_index (sorted, double, index);
+}
+
+
+static void
+append_double (GString *str, const char *key, double value, gboolean last)
+{
+  char buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+  g_string_append_printf (str, "\"%s\": %s%s", key,
+                          g_ascii_formatd (buf, sizeof (buf), "%.2f", value),
+                          last ? "" : ", ");
+}
+
+
+static void
+append_metric (GString *str, PhocBenchMetric *metric)
+{
+  g_autoptr (GArray) sorted = g_array_copy (metric->values);
+  double sum = 0;
+
+  g_string_append_printf (str, "\"%s\": {\"n\": %u", metric->name, sorted->len);
+  if (sorted->len == 0) {
+    g_string_append (str, "}");
+    return;
+  }
+
+  g_array_sort (sorted, compare_double);
+  for (guint i = 0; i < sorted->len; i++)
+    sum += g_array_index (sorted, double, i);
+
+  g_string_append (str, ", ");
+  append_double (str, "mean", sum / sorted->len, FALSE);
+  append_double (str, "p50", get_percentile (sorted, 50), FALSE);
+  append_double (str, "p90", get_percentile (sorted, 90), FALSE);
+  append_double (str, "p99", get_percentile (sorted, 99), FALSE);
+  append_double (str, "max", g_array_index (sorted, double, sorted->len - 1), TRUE);
+  g_string_append (str, "}");
+}
+
+
+static void
+report (PhocBench *self)
+{
+  g_autoptr (GString) str = g_string_new (NULL);
+  g_autoptr (GError) err = NULL;
+  double fps = 0.0;
+
+  if (self->end_us > self->start_us)
+    fps = (double)self->n_frames * G_USEC_PER_SEC / (self->end_us - self->start_us);
+
+  g_string_append_printf (str,
+                          "{\"benchmark\": \"%s\", \"renderer\": \"%s\", "
+                          "\"mode\": \"%s\", \"unthrottled\": %s, "
+                          "\"frames\": %d, \"views\": %d, \"seed\": %d, "
+                          "\"count-allocs\": %s, ",
+                          self->name, g_getenv ("WLR_RENDERER"),
+                          self->mode, self->unthrottled ? "true" : "false",
+                          self->n_frames, self->n_views, self->seed,
+                          phoc_alloc_counter_is_enabled () ? "true" : "false");
+  append_double (str, "fps", fps, FALSE);
+  g_string_append (str, "\"metrics\": {");
+  for (guint i = 0; i < self->metrics->len; i++) {
+    append_metric (str, g_ptr_array_index (self->metrics, i));
+    if (i + 1 < self->metrics->len)
+      g_string_append (str, ", ");
+  }
+  g_string_append (str, "}}\n");
+
+  g_print ("%s", str->str);
+
+  if (self->output_file && !g_file_set_contents (self->output_file, str->str, str->len, &err))
+    g_critical ("Failed to write results to %s: %s", self->output_file, err->message);
+}
+
+
+static void
+on_render_start (PhocBench *self, PhocOutput *output)
+{
+  /* Not every render pass ends up rendering a frame */
+  self->in_frame = TRUE;
+  self->frame_start_us = g_get_monotonic_time ();
+  self->frame_cpu_start_us = get_thread_cpu_time ();
+  self->frame_allocs_start = phoc_alloc_counter_get_n_allocs ();
+}
+
+
+static gboolean
+on_force_frame (gpointer data)
+{
+  PhocBench *self = data;
+
+  self->force_frame_id = 0;
+
+  /* Repaint everything right away rather than waiting for the next vblank */
+  phoc_output_damage_whole (self->output);
+  wlr_output_send_frame (self->output->wlr_output);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+record_frame (PhocBench *self)
+{
+  gint64 now_us, cpu_us;
+  guint64 allocs;
+
+  /* Take all measurements before recording allocates */
+  now_us = g_get_monotonic_time ();
+  cpu_us = get_thread_cpu_time () - self->frame_cpu_start_us;
+  allocs = phoc_alloc_counter_get_n_allocs () - self->frame_allocs_start;
+
+  phoc_bench_add_sample (self, PHOC_BENCH_METRIC_FRAME_TIME, now_us - self->frame_start_us);
+  phoc_bench_add_sample (self, PHOC_BENCH_METRIC_CPU_TIME, cpu_us);
+  if (phoc_alloc_counter_is_enabled ())
+    phoc_bench_add_sample (self, PHOC_BENCH_METRIC_ALLOCS, allocs);
+
+  if (g_atomic_int_add (&self->n_rendered, 1) + 1 == self->n_frames)
+    self->end_us = now_us;
+}
+
+
+static void
+on_render_end (PhocBench *self, PhocOutput *output)
+{
+  if (!self->in_frame)
+    return;
+  self->in_frame = FALSE;
+
+  if (!g_atomic_int_get (&self->recording))
+    return;
+
+  if (!phoc_bench_is_done (self))
+    record_frame (self);
+
+  /* Keep going after we're done as the client might still wait for a frame */
+  if (self->unthrottled && self->force_frame_id == 0) {
+    self->output = output;
+    self->force_frame_id = g_idle_add (on_force_frame, self);
+  }
+}
+
+
+static gboolean
+bench_server_prepare (PhocServer *server, gpointer data)
+{
+  PhocBench *self = data;
+  PhocRenderer *renderer = phoc_server_get_renderer (server);
+
+  g_signal_connect_swapped (renderer, "render-start", G_CALLBACK (on_render_start), self);
+  g_signal_connect_swapped (renderer, "render-end", G_CALLBACK (on_render_end), self);
+
+  return TRUE;
+}
+
+
+static gboolean
+bench_client_run (PhocTestClientGlobals *globals, gpointer data)
+{
+  PhocBench *self = data;
+
+  return self->client_run (globals, self);
+}
+
+
+static void
+bench_setup (PhocBench *self)
+{
+  g_autoptr (GError) err = NULL;
+
+  self->bus = g_test_dbus_new (G_TEST_DBUS_NONE);
+  g_test_dbus_up (self->bus);
+
+  self->tmpdir = g_dir_make_tmp ("phoc-bench.XXXXXX", &err);
+  g_assert_no_error (err);
+
+  g_setenv ("NO_AT_BRIDGE", "1", TRUE);
+  g_setenv ("XDG_RUNTIME_DIR", self->tmpdir, TRUE);
+  g_setenv ("WLR_BACKENDS", "headless", TRUE);
+  /* Allow to benchmark other renderers but default to the one that works everywhere */
+  g_setenv ("WLR_RENDERER", "pixman", FALSE);
+}
+
+
+static void
+bench_teardown (PhocBench *self)
+{
+  g_autoptr (GDir) dir = NULL;
+  const char *name;
+
+  g_test_dbus_down (self->bus);
+  g_clear_object (&self->bus);
+
+  /* The compositor leaves its socket and lock file behind */
+  dir = g_dir_open (self->tmpdir, 0, NULL);
+  while (dir && (name = g_dir_read_name (dir))) {
+    g_autofree char *path = g_build_filename (self->tmpdir, name, NULL);
+
+    g_remove (path);
+  }
+  g_rmdir (self->tmpdir);
+  g_clear_pointer (&self->tmpdir, g_free);
+}
+
+/**
+ * phoc_bench_new:
+ * @name: The benchmark's name
+ * @argc: The number of command line arguments
+ * @argv: The command line arguments
+ *
+ * Creates a new benchmark parsing the common command line options.
+ *
+ * Returns: (transfer full): The benchmark
+ */
+PhocBench *
+phoc_bench_new (const char *name, int *argc, char ***argv)
+{
+  g_autoptr (GOptionContext) context = g_option_context_new ("- phoc benchmark");
+  g_autoptr (GError) err = NULL;
+  PhocBench *self = g_new0 (PhocBench, 1);
+  const GOptionEntry options [] = {
+    { "frames", 'f', 0, G_OPTION_ARG_INT, &self->n_frames,
+      "Number of frames to render", "N" },
+    { "views", 'n', 0, G_OPTION_ARG_INT, &self->n_views,
+      "Number of views to create", "N" },
+    { "seed", 's', 0, G_OPTION_ARG_INT, &self->seed,
+      "Seed for the random number generator", "SEED" },
+    { "mode", 'm', 0, G_OPTION_ARG_STRING, &self->mode,
+      "The output's size", "WIDTHxHEIGHT" },
+    { "unthrottled", 'u', 0, G_OPTION_ARG_NONE, &self->unthrottled,
+      "Render frames as fast as possible", NULL },
+    { "output", 'o', 0, G_OPTION_ARG_FILENAME, &self->output_file,
+      "Also write results to FILE", "FILE" },
+    { NULL }
+  };
+
+  self->name = g_strdup (name);
+  self->n_frames = DEFAULT_N_FRAMES;
+  self->n_views = DEFAULT_N_VIEWS;
+  self->seed = DEFAULT_SEED;
+
+  g_option_context_add_main_entries (context, options, NULL);
+  if (!g_option_context_parse (context, argc, argv, &err))
+    g_error ("Failed to parse options: %s", err->message);
+
+  g_assert_cmpint (self->n_frames, >, 0);
+  g_assert_cmpint (self->n_views, >, 0);
+  if (self->mode == NULL)
+    self->mode = g_strdup (DEFAULT_MODE);
+  if (!g_regex_match_simple ("^[0-9]+x[0-9]+$", self->mode, 0, 0))
+    g_error ("Invalid mode '%s'", self->mode);
+
+  self->rand = g_rand_new_with_seed (self->seed);
+  self->metrics = g_ptr_array_new_with_free_func ((GDestroyNotify)phoc_bench_metric_free);
+  g_mutex_init (&self->lock);
+
+  return self;
+}
+
+
+void
+phoc_bench_free (PhocBench *self)
+{
+  g_ptr_array_unref (self->metrics);
+  g_mutex_clear (&self->lock);
+  g_rand_free (self->rand);
+  g_free (self->output_file);
+  g_free (self->mode);
+  g_free (self->name);
+  g_free (self);
+}
+
+/**
+ * phoc_bench_run:
+ * @self: The benchmark
+ * @client_run: The scenario
+ *
+ * Starts a compositor, runs the given scenario as client and prints
+ * the results. The scenario gets passed the benchmark as data.
+ */
+void
+phoc_bench_run (PhocBench *self, PhocTestClientFunc client_run)
+{
+  g_autofree char *config = NULL;
+  PhocTestClientIface iface = {
+    .server_prepare = bench_server_prepare,
+    .client_run = bench_client_run,
+  };
+  /* Be generous, even slow machines should manage 10 fps */
+  gint timeout = TEST_PHOC_CLIENT_TIMEOUT + self->n_frames / 10;
+
+  self->client_run = client_run;
+
+  config = g_strdup_printf ("[core]\n"
+                            "xwayland=false\n"
+                            "[output:HEADLESS-1]\n"
+                            "mode=%s\n",
+                            self->mode);
+  iface.config = phoc_config_new_from_data (config);
+  g_assert_nonnull (iface.config);
+
+  bench_setup (self);
+  phoc_test_client_run (timeout, &iface, self);
+  /* The output is gone with the compositor */
+  g_clear_handle_id (&self->force_frame_id, g_source_remove);
+  bench_teardown (self);
+
+  report (self);
+}
+
+/**
+ * phoc_bench_start:
+ * @self: The benchmark
+ *
+ * Starts recording frames. Scenarios invoke this once their setup is
+ * done so e.g. initial texture uploads don't skew the results.
+ */
+void
+phoc_bench_start (PhocBench *self)
+{
+  self->start_us = g_get_monotonic_time ();
+  g_atomic_int_set (&self->recording, TRUE);
+}
+
+/**
+ * phoc_bench_is_done:
+ * @self: The benchmark
+ *
+ * Whether the requested number of frames got rendered since the
+ * benchmark was started.
+ *
+ * Returns: %TRUE if the scenario should finish
+ */
+gboolean
+phoc_bench_is_done (PhocBench *self)
+{
+  return g_atomic_int_get (&self->n_rendered) >= self->n_frames;
+}
+
+
+guint
+phoc_bench_get_n_views (PhocBench *self)
+{
+  return self->n_views;
+}
+
+
+GRand *
+phoc_bench_get_rand (PhocBench *self)
+{
+  return self->rand;
+}
+
+/**
+ * phoc_bench_add_sample:
+ * @self: The benchmark
+ * @metric: The metric's name
+ * @value: The value
+ *
+ * Records a sample for the given metric. For each metric the mean,
+ * the percentiles and the maximum are reported. This can be called
+ * from the client and the compositor.
+ */
+void
+phoc_bench_add_sample (PhocBench *self, const char *metric, double value)
+{
+  g_autoptr (GMutexLocker) locker = g_mutex_locker_new (&self->lock);
+  PhocBenchMetric *m = NULL;
+
+  for (guint i = 0; i < self->metrics->len; i++) {
+    PhocBenchMetric *candidate = g_ptr_array_index (self->metrics, i);
+
+    if (g_str_equal (candidate->name, metric)) {
+      m = candidate;
+      break;
+    }
+  }
+
+  if (m == NULL) {
+    m = g_new0 (PhocBenchMetric, 1);
+    m->name = g_strdup (metric);
+    m->values = g_array_sized_new (FALSE, FALSE, sizeof (double), self->n_frames);
+    g_ptr_array_add (self->metrics, m);
+  }
+
+  g_array_append_val (m->values, value);
+}
+
+
+static void
+frame_handle_done (void *data, struct wl_callback *callback, uint32_t time)
+{
+  gboolean *done = data;
+
+  *done = TRUE;
+  wl_callback_destroy (callback);
+}
+
+
+static const struct wl_callback_listener frame_listener = {
+  .done = frame_handle_done,
+};
+
+/**
+ * phoc_bench_wait_frame:
+ * @globals: The wayland globals
+ * @wl_surface: A mapped surface with pending damage
+ *
+ * Commits the surface's pending state and waits until the compositor
+ * rendered it. Scenarios use this to generate load at the output's
+ * refresh rate.
+ */
+void
+phoc_bench_wait_frame (PhocTestClientGlobals *globals, struct wl_surface *wl_surface)
+{
+  struct wl_callback *callback;
+  gboolean done = FALSE;
+
+  callback = wl_surface_frame (wl_surface);
+  wl_callback_add_listener (callback, &frame_listener, &done);
+  wl_surface_commit (wl_surface);
+
+  while (!done && wl_display_dispatch (globals->display) != -1) {
+    /* Main loop */
+  }
+  g_assert_true (done);
+}
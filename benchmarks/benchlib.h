@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ * SPDX-License-Identifier: GPL-3.0+
+ */
+
+#include "testlib.h"
+
+#pragma once
+
+G_BEGIN_DECLS
+
+/* Metrics recorded for every rendered frame */
+#define PHOC_BENCH_METRIC_FRAME_TIME "frame-time-us"
+#define PHOC_BENCH_METRIC_CPU_TIME   "cpu-time-us"
+#define PHOC_BENCH_METRIC_ALLOCS     "allocs"
+
+typedef struct _PhocBench PhocBench;
+
+PhocBench *phoc_bench_new              (const char            *name,
+                                        int                   *argc,
+                                        char                ***argv);
+void       phoc_bench_free             (PhocBench             *self);
+void       phoc_bench_run              (PhocBench             *self,
+                                        PhocTestClientFunc     client_run);
+void       phoc_bench_start            (PhocBench             *self);
+gboolean   phoc_bench_is_done          (PhocBench             *self);
+guint      phoc_bench_get_n_views      (PhocBench             *self);
+GRand     *phoc_bench_get_rand         (PhocBench             *self);
+void       phoc_bench_add_sample       (PhocBench             *self,
+                                        const char            *metric,
+                                        double                 value);
+void       phoc_bench_wait_frame       (PhocTestClientGlobals *globals,
+                                        struct wl_surface     *wl_surface);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (PhocBench, phoc_bench_free)
+
+G_END_DECLS
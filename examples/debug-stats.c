@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0+
+ *
+ * Prints the compositor's per output rendering statistics once a second.
+ */
+
+#define G_LOG_DOMAIN "phoc-example"
+
+#include "phoc-debug-stats-unstable-v1-client-protocol.h"
+
+#include <glib.h>
+
+#define REPORT_INTERVAL_US G_USEC_PER_SEC
+
+static struct wl_display *display;
+static struct zphoc_debug_stats_v1 *debug_stats;
+static GSList *outputs;
+
+typedef struct {
+  struct wl_output             *wl_output;
+  struct zphoc_output_stats_v1 *output_stats;
+  guint32                       name;
+
+  gint64                        since_us;
+  guint                         n_frames;
+  guint                         n_scanout;
+  guint64                       render_time_us;
+  guint                         max_render_time_us;
+  guint64                       damage_area;
+  guint64                       n_draw_calls;
+  guint64                       n_allocs;
+  guint                         max_input_latency_ms;
+  guint                         n_views;
+  guint                         n_surfaces;
+} Output;
+
+
+static void
+report (Output *output, gint64 now)
+{
+  if (output->n_frames) {
+    g_print ("output %u: %u frames (%u scanned out), render %.2f ms avg %.2f ms max, "
+             "%.0f px damage, %.1f draw calls, %.1f allocs per frame, "
+             "input latency %u ms max, %u views, %u surfaces\n",
+             output->name, output->n_frames, output->n_scanout,
+             output->render_time_us / (double)output->n_frames / 1000.0,
+             output->max_render_time_us / 1000.0,
+             output->damage_area / (double)output->n_frames,
+             output->n_draw_calls / (double)output->n_frames,
+             output->n_allocs / (double)output->n_frames,
+             output->max_input_latency_ms, output->n_views, output->n_surfaces);
+  }
+
+  output->since_us = now;
+  output->n_frames = 0;
+  output->n_scanout = 0;
+  output->render_time_us = 0;
+  output->max_render_time_us = 0;
+  output->damage_area = 0;
+  output->n_draw_calls = 0;
+  output->n_allocs = 0;
+  output->max_input_latency_ms = 0;
+}
+
+
+static void
+output_stats_handle_frame (void                         *data,
+                           struct zphoc_output_stats_v1 *output_stats,
+                           uint32_t                      render_time,
+                           uint32_t                      damage_area,
+                           uint32_t                      draw_calls,
+                           uint32_t                      allocations,
+                           uint32_t                      input_latency,
+                           uint32_t                      views,
+                           uint32_t                      surfaces,
+                           uint32_t                      scanout)
+{
+  Output *output = data;
+  gint64 now = g_get_monotonic_time ();
+
+  if (output->since_us == 0)
+    output->since_us = now;
+
+  output->n_frames++;
+  output->n_scanout += !!scanout;
+  output->render_time_us += render_time;
+  output->max_render_time_us = MAX (output->max_render_time_us, render_time);
+  output->damage_area += damage_area;
+  output->n_draw_calls += draw_calls;
+  output->n_allocs += allocations;
+  output->max_input_latency_ms = MAX (output->max_input_latency_ms, input_latency);
+  output->n_views = views;
+  output->n_surfaces = surfaces;
+
+  if (now - output->since_us >= REPORT_INTERVAL_US)
+    report (output, now);
+}
+
+
+static const struct zphoc_output_stats_v1_listener output_stats_listener = {
+  .frame = output_stats_handle_frame,
+};
+
+
+static void
+handle_global (void *data, struct wl_registry *registry,
+               uint32_t name, const char *interface, uint32_t version)
+{
+  if (strcmp (interface, zphoc_debug_stats_v1_interface.name) == 0) {
+    debug_stats = wl_registry_bind (registry, name, &zphoc_debug_stats_v1_interface, 1);
+  } else if (strcmp (interface, wl_output_interface.name) == 0) {
+    Output *output = g_new0 (Output, 1);
+
+    output->name = name;
+    output->wl_output = wl_registry_bind (registry, name, &wl_output_interface, 1);
+    outputs = g_slist_append (outputs, output);
+  }
+}
+
+static void
+handle_global_remove (void *data, struct wl_registry *registry,
+                      uint32_t name)
+{
+  // who cares
+}
+
+static const struct wl_registry_listener registry_listener = {
+  .global = handle_global,
+  .global_remove = handle_global_remove,
+};
+
+int
+main (int argc, char **argv)
+{
+  struct wl_registry *registry;
+
+  display = wl_display_connect (NULL);
+  if (display == NULL) {
+    g_critical ("Failed to create display");
+    return 1;
+  }
+
+  registry = wl_display_get_registry (display);
+  wl_registry_add_listener (registry, &registry_listener, NULL);
+  wl_display_roundtrip (display);
+
+  if (debug_stats == NULL) {
+    g_critical ("zphoc_debug_stats_v1 not available");
+    return 1;
+  }
+
+  for (GSList *l = outputs; l; l = l->next) {
+    Output *output = l->data;
+
+    output->output_stats = zphoc_debug_stats_v1_get_output_stats (debug_stats, output->wl_output);
+    zphoc_output_stats_v1_add_listener (output->output_stats, &output_stats_listener, output);
+  }
+
+  g_message ("Press CTRL-C to quit");
+  while (wl_display_dispatch (display) != -1) {
+    // This space intentionally left blank
+  }
+
+  return 0;
+}
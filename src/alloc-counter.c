@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phoc-alloc-counter"
+
+#include "phoc-config.h"
+#include "alloc-counter.h"
+
+#include <errno.h>
+#include <stdlib.h>
+
+/**
+ * PhocAllocCounter:
+ *
+ * Counts heap allocations to find code paths that allocate in hot
+ * loops like rendering a frame.
+ *
+ * GLib's allocator hooks are gone, so when built with
+ * `-Dalloc-counter=true` libc's `malloc()`, `calloc()`, `realloc()`
+ * and the aligned allocators are wrapped instead. This needs glibc's
+ * `__libc_*` entry points. This catches allocations in GLib, wlroots and
+ * pixman too. The count is kept per thread so helper threads don't
+ * skew the numbers of the compositor's main thread.
+ */
+
+#ifdef PHOC_ALLOC_COUNTER
+
+extern void *__libc_malloc (size_t size);
+extern void *__libc_calloc (size_t nmemb, size_t size);
+extern void *__libc_realloc (void *ptr, size_t size);
+extern void *__libc_memalign (size_t alignment, size_t size);
+
+static __thread guint64 n_allocs;
+
+
+void *
+malloc (size_t size)
+{
+  n_allocs++;
+  return __libc_malloc (size);
+}
+
+
+void *
+calloc (size_t nmemb, size_t size)
+{
+  n_allocs++;
+  return __libc_calloc (nmemb, size);
+}
+
+
+void *
+realloc (void *ptr, size_t size)
+{
+  n_allocs++;
+  return __libc_realloc (ptr, size);
+}
+
+
+static inline gboolean
+is_power_of_two (size_t n)
+{
+  return n != 0 && (n & (n - 1)) == 0;
+}
+
+
+void *
+memalign (size_t alignment, size_t size)
+{
+  n_allocs++;
+  return __libc_memalign (alignment, size);
+}
+
+
+void *
+aligned_alloc (size_t alignment, size_t size)
+{
+  if (!is_power_of_two (alignment)) {
+    errno = EINVAL;
+    return NULL;
+  }
+
+  n_allocs++;
+  return __libc_memalign (alignment, size);
+}
+
+
+int
+posix_memalign (void **memptr, size_t alignment, size_t size)
+{
+  void *mem;
+
+  if (!is_power_of_two (alignment) || alignment % sizeof (void *) != 0)
+    return EINVAL;
+
+  n_allocs++;
+  mem = __libc_memalign (alignment, size);
+  if (mem == NULL)
+    return ENOMEM;
+
+  *memptr = mem;
+  return 0;
+}
+
+#endif
+
+
+gboolean
+phoc_alloc_counter_is_enabled (void)
+{
+#ifdef PHOC_ALLOC_COUNTER
+  return TRUE;
+#else
+  return FALSE;
+#endif
+}
+
+/**
+ * phoc_alloc_counter_get_n_allocs:
+ *
+ * Gets the number of allocations the calling thread made so far.
+ * Take the difference of two calls to get the number of allocations
+ * of a code path.
+ *
+ * Returns: The number of allocations or `0` if the allocation counter
+ *   isn't enabled.
+ */
+guint64
+phoc_alloc_counter_get_n_allocs (void)
+{
+#ifdef PHOC_ALLOC_COUNTER
+  return n_allocs;
+#else
+  return 0;
+#endif
+}
@@ -0,0 +1,16 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+gboolean phoc_alloc_counter_is_enabled   (void);
+guint64  phoc_alloc_counter_get_n_allocs (void);
+
+G_END_DECLS
@@ -15,6 +15,9 @@
 
 #include <math.h>
 
+/* Number of intervals in the lookup tables of the expensive curves */
+#define EASING_LUT_SIZE 256
+
 static double
 phoc_linear (double t, double d)
 {
@@ -418,3 +421,169 @@ phoc_easing_ease (PhocEasing self,
     g_assert_not_reached ();
   }
 }
+
+
+static gboolean
+has_lut (PhocEasing self)
+{
+  switch (self) {
+  case PHOC_EASING_EASE_IN_EXPO:
+  case PHOC_EASING_EASE_OUT_EXPO:
+  case PHOC_EASING_EASE_IN_OUT_EXPO:
+  case PHOC_EASING_EASE_IN_ELASTIC:
+  case PHOC_EASING_EASE_OUT_ELASTIC:
+  case PHOC_EASING_EASE_IN_OUT_ELASTIC:
+    return TRUE;
+  default:
+    return FALSE;
+  }
+}
+
+
+static const double *
+get_lut (PhocEasing self)
+{
+  static double *luts[PHOC_EASING_EASE_IN_OUT_BOUNCE + 1];
+
+  g_assert (has_lut (self));
+
+  if (g_once_init_enter (&luts[self])) {
+    double *lut = g_new (double, EASING_LUT_SIZE + 1);
+
+    for (guint i = 0; i <= EASING_LUT_SIZE; i++)
+      lut[i] = phoc_easing_ease (self, (double) i / EASING_LUT_SIZE);
+
+    g_once_init_leave (&luts[self], lut);
+  }
+
+  return luts[self];
+}
+
+
+static inline double
+lookup (const double *lut, double value)
+{
+  double pos = CLAMP (value, 0.0, 1.0) * EASING_LUT_SIZE;
+  guint i = (guint) pos;
+  double frac = pos - i;
+
+  if (i >= EASING_LUT_SIZE)
+    return lut[EASING_LUT_SIZE];
+
+  return lut[i] + (lut[i + 1] - lut[i]) * frac;
+}
+
+/**
+ * phoc_easing_ease_fast:
+ * @self: a `PhocEasing`
+ * @value: a value to ease
+ *
+ * Like [func@easing_ease] but the expensive exponential and elastic
+ * curves are interpolated from a precomputed table. The error is
+ * below `0.001` and hence not visible on screen. Values at `0` and
+ * `1` are exact.
+ *
+ * @value must be in the [0, 1] range.
+ *
+ * Returns: the easing for @value
+ */
+double
+phoc_easing_ease_fast (PhocEasing self,
+                       double     value)
+{
+  if (!has_lut (self))
+    return phoc_easing_ease (self, value);
+
+  return lookup (get_lut (self), value);
+}
+
+
+#define EASE_BATCH(func)                                \
+  for (gsize i = 0; i < n_values; i++)                  \
+    results[i] = func (values[i], 1);                   \
+  break
+
+/**
+ * phoc_easing_ease_batch:
+ * @self: a `PhocEasing`
+ * @values: (array length=n_values): The values to ease
+ * @results: (array length=n_values) (out caller-allocates): Return location
+ *   for the eased values
+ * @n_values: The number of values
+ *
+ * Computes easing with @easing for all @values. This is equivalent to
+ * calling [func@easing_ease_fast] for each value but picks the easing
+ * function only once so the compiler can vectorize the loop.
+ *
+ * @values must be in the [0, 1] range. @values and @results may be
+ * the same array.
+ */
+void
+phoc_easing_ease_batch (PhocEasing    self,
+                        const double *values,
+                        double       *results,
+                        gsize         n_values)
+{
+  if (has_lut (self)) {
+    const double *lut = get_lut (self);
+
+    for (gsize i = 0; i < n_values; i++)
+      results[i] = lookup (lut, values[i]);
+    return;
+  }
+
+  switch (self) {
+  case PHOC_EASING_NONE:
+    EASE_BATCH (phoc_linear);
+  case PHOC_EASING_EASE_IN_QUAD:
+    EASE_BATCH (phoc_ease_in_quad);
+  case PHOC_EASING_EASE_OUT_QUAD:
+    EASE_BATCH (phoc_ease_out_quad);
+  case PHOC_EASING_EASE_IN_OUT_QUAD:
+    EASE_BATCH (phoc_ease_in_out_quad);
+  case PHOC_EASING_EASE_IN_CUBIC:
+    EASE_BATCH (phoc_ease_in_cubic);
+  case PHOC_EASING_EASE_OUT_CUBIC:
+    EASE_BATCH (phoc_ease_out_cubic);
+  case PHOC_EASING_EASE_IN_OUT_CUBIC:
+    EASE_BATCH (phoc_ease_in_out_cubic);
+  case PHOC_EASING_EASE_IN_QUART:
+    EASE_BATCH (phoc_ease_in_quart);
+  case PHOC_EASING_EASE_OUT_QUART:
+    EASE_BATCH (phoc_ease_out_quart);
+  case PHOC_EASING_EASE_IN_OUT_QUART:
+    EASE_BATCH (phoc_ease_in_out_quart);
+  case PHOC_EASING_EASE_IN_QUINT:
+    EASE_BATCH (phoc_ease_in_quint);
+  case PHOC_EASING_EASE_OUT_QUINT:
+    EASE_BATCH (phoc_ease_out_quint);
+  case PHOC_EASING_EASE_IN_OUT_QUINT:
+    EASE_BATCH (phoc_ease_in_out_quint);
+  case PHOC_EASING_EASE_IN_SINE:
+    EASE_BATCH (phoc_ease_in_sine);
+  case PHOC_EASING_EASE_OUT_SINE:
+    EASE_BATCH (phoc_ease_out_sine);
+  case PHOC_EASING_EASE_IN_OUT_SINE:
+    EASE_BATCH (phoc_ease_in_out_sine);
+  case PHOC_EASING_EASE_IN_CIRC:
+    EASE_BATCH (phoc_ease_in_circ);
+  case PHOC_EASING_EASE_OUT_CIRC:
+    EASE_BATCH (phoc_ease_out_circ);
+  case PHOC_EASING_EASE_IN_OUT_CIRC:
+    EASE_BATCH (phoc_ease_in_out_circ);
+  case PHOC_EASING_EASE_IN_BACK:
+    EASE_BATCH (phoc_ease_in_back);
+  case PHOC_EASING_EASE_OUT_BACK:
+    EASE_BATCH (phoc_ease_out_back);
+  case PHOC_EASING_EASE_IN_OUT_BACK:
+    EASE_BATCH (phoc_ease_in_out_back);
+  case PHOC_EASING_EASE_IN_BOUNCE:
+    EASE_BATCH (phoc_ease_in_bounce);
+  case PHOC_EASING_EASE_OUT_BOUNCE:
+    EASE_BATCH (phoc_ease_out_bounce);
+  case PHOC_EASING_EASE_IN_OUT_BOUNCE:
+    EASE_BATCH (phoc_ease_in_out_bounce);
+  default:
+    g_assert_not_reached ();
+  }
+}
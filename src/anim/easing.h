@@ -13,6 +13,13 @@
 
 G_BEGIN_DECLS
 
-double phoc_easing_ease (PhocEasing self, double value);
+double phoc_easing_ease       (PhocEasing    self,
+                               double        value);
+double phoc_easing_ease_fast  (PhocEasing    self,
+                               double        value);
+void   phoc_easing_ease_batch (PhocEasing    self,
+                               const double *values,
+                               double       *results,
+                               gsize         n_values);
 
 G_END_DECLS
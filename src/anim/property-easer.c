@@ -13,6 +13,8 @@
 #include "easing.h"
 #include "property-easer.h"
 
+#include <float.h>
+
 
 enum {
   PROP_0,
@@ -29,9 +31,22 @@ typedef struct _PhocEaseProp {
   GParamSpec *pspec;
   float start;
   float end;
+  PhocPropertyEaserFloatSetter setter;
 } PhocEaseProp;
 
 
+static GQuark
+float_setter_quark (void)
+{
+  static GQuark quark;
+
+  if (G_UNLIKELY (quark == 0))
+    quark = g_quark_from_static_string ("phoc-property-easer-float-setter");
+
+  return quark;
+}
+
+
 /**
  * PhocPropertyEaser:
  *
@@ -62,6 +77,11 @@ typedef struct _PhocEaseProp {
  *
  * The eased properties must be of type `float` or `int`. If the tracked object goes away the
  * easing stops. No ref is held on the object.
+ *
+ * As properties are updated every frame classes can avoid the overhead of
+ * `g_object_set_property()` by installing a setter for their
+ * animatable `float` properties via
+ * [func@property_easer_install_float_setter].
  */
 struct _PhocPropertyEaser {
   GObject         parent;
@@ -70,7 +90,7 @@ struct _PhocPropertyEaser {
   GObject        *target;
   PhocEasing      easing;
 
-  GHashTable     *ease_props;
+  GArray         *ease_props;
 };
 G_DEFINE_TYPE (PhocPropertyEaser, phoc_property_easer, G_TYPE_OBJECT)
 
@@ -96,24 +116,47 @@ phoc_lerp (double a, double b, double t)
 
 
 static void
-phoc_ease_prop_free (PhocEaseProp *ease_prop)
+add_ease_prop (PhocPropertyEaser *self, GParamSpec *pspec, float start, float end)
 {
-  g_free (ease_prop);
+  PhocEaseProp ease_prop = {
+    .pspec = pspec,
+    .start = start,
+    .end = end,
+  };
+
+  g_assert (G_IS_PARAM_SPEC (pspec));
+
+  if (pspec->value_type == G_TYPE_FLOAT)
+    ease_prop.setter = g_param_spec_get_qdata (pspec, float_setter_quark ());
+
+  /* Setting a property again replaces it */
+  for (guint i = 0; i < self->ease_props->len; i++) {
+    PhocEaseProp *old = &g_array_index (self->ease_props, PhocEaseProp, i);
+
+    if (old->pspec == pspec) {
+      *old = ease_prop;
+      return;
+    }
+  }
+
+  g_array_append_val (self->ease_props, ease_prop);
 }
 
 
-static PhocEaseProp *
-phoc_ease_prop_new (GParamSpec *pspec, float start, float end)
+static void
+set_value_slow (GObject *target, PhocEaseProp *ease_prop, float value)
 {
-  PhocEaseProp *ease_prop = g_new0 (PhocEaseProp, 1);
+  g_auto (GValue) val = G_VALUE_INIT;
 
-  g_assert (G_IS_PARAM_SPEC (pspec));
-
-  ease_prop->pspec = pspec;
-  ease_prop->start = start;
-  ease_prop->end = end;
+  if (ease_prop->pspec->value_type == G_TYPE_INT) {
+    g_value_init (&val, G_TYPE_INT);
+    g_value_set_int (&val, value);
+  } else {
+    g_value_init (&val, G_TYPE_FLOAT);
+    g_value_set_float (&val, value);
+  }
 
-  return ease_prop;
+  g_object_set_property (target, ease_prop->pspec->name, &val);
 }
 
 
@@ -150,7 +193,6 @@ set_props_variant (PhocPropertyEaser *self, GVariant *variant)
   g_variant_iter_init (&iter, variant);
   while (g_variant_iter_next (&iter, PROPS_FORMAT, &name, &start, &end, NULL)) {
     GParamSpec *pspec;
-    PhocEaseProp *ease_prop;
 
     pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (self->target), name);
 
@@ -159,8 +201,12 @@ set_props_variant (PhocPropertyEaser *self, GVariant *variant)
       continue;
     }
 
-    ease_prop = phoc_ease_prop_new (pspec, start, end);
-    g_hash_table_insert (self->ease_props, g_strdup (name), ease_prop);
+    if (pspec->value_type != G_TYPE_FLOAT && pspec->value_type != G_TYPE_INT) {
+      g_warning ("'%s' is not a float or int property", name);
+      continue;
+    }
+
+    add_ease_prop (self, pspec, start, end);
 
     n_params++;
   }
@@ -231,7 +277,7 @@ phoc_property_easer_dispose (GObject *object)
   PhocPropertyEaser *self = PHOC_PROPERTY_EASER(object);
 
   set_target (self, NULL);
-  g_clear_pointer (&self->ease_props, g_hash_table_destroy);
+  g_clear_pointer (&self->ease_props, g_array_unref);
 
   G_OBJECT_CLASS (phoc_property_easer_parent_class)->dispose (object);
 }
@@ -294,8 +340,7 @@ phoc_property_easer_class_init (PhocPropertyEaserClass *klass)
 static void
 phoc_property_easer_init (PhocPropertyEaser *self)
 {
-  self->ease_props = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
-                                            (GDestroyNotify)phoc_ease_prop_free);
+  self->ease_props = g_array_new (FALSE, FALSE, sizeof (PhocEaseProp));
 }
 
 
@@ -318,38 +363,42 @@ phoc_property_easer_new (GObject *target)
 void
 phoc_property_easer_set_progress (PhocPropertyEaser *self, float progress)
 {
-  GHashTableIter iter;
-  PhocEaseProp *ease_prop;
+  gboolean batch;
+  float t;
 
   /* target disposed, nothing to do */
   if (self->target == NULL)
     return;
 
-  g_return_if_fail (g_hash_table_size (self->ease_props));
+  g_return_if_fail (self->ease_props->len);
   g_return_if_fail (PHOC_IS_PROPERTY_EASER (self));
   g_return_if_fail (progress >= 0.0 && progress <= 1.0);
 
-  self->progress = progress;
+  t = phoc_easing_ease_fast (self->easing, progress);
 
-  g_object_freeze_notify (self->target);
-  g_hash_table_iter_init (&iter, self->ease_props);
-  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &ease_prop)) {
-    float t = phoc_easing_ease (self->easing, progress);
-    g_auto (GValue) val = G_VALUE_INIT;
-    g_auto (GValue) target = G_VALUE_INIT;
+  /* Only worth batching notifications when there's more than one */
+  batch = self->ease_props->len > 1;
+  if (batch)
+    g_object_freeze_notify (self->target);
 
-    g_value_init (&val, G_TYPE_FLOAT);
-    g_value_init (&target, G_PARAM_SPEC_VALUE_TYPE (ease_prop->pspec));
+  for (guint i = 0; i < self->ease_props->len; i++) {
+    PhocEaseProp *ease_prop = &g_array_index (self->ease_props, PhocEaseProp, i);
 
-    g_value_set_float (&val, phoc_lerp (ease_prop->start, ease_prop->end, t));
-    g_value_transform (&val, &target);
+    float value = phoc_lerp (ease_prop->start, ease_prop->end, t);
 
-    g_object_set_property (self->target,
-                           ease_prop->pspec->name,
-                           &target);
+    if (ease_prop->setter)
+      ease_prop->setter (self->target, value);
+    else
+      set_value_slow (self->target, ease_prop, value);
   }
-  g_object_thaw_notify (self->target);
 
+  if (batch)
+    g_object_thaw_notify (self->target);
+
+  if (G_APPROX_VALUE (self->progress, progress, FLT_EPSILON))
+    return;
+
+  self->progress = progress;
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_PROGRESS]);
 }
 
@@ -397,7 +446,6 @@ phoc_property_easer_set_props_valist (PhocPropertyEaser *self,
   name = first_property_name;
   do {
     GParamSpec *pspec;
-    PhocEaseProp *ease_prop;
     float start, end;
 
     pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (self->target), name);
@@ -418,8 +466,7 @@ phoc_property_easer_set_props_valist (PhocPropertyEaser *self,
       continue;
     }
 
-    ease_prop = phoc_ease_prop_new (pspec, start, end);
-    g_hash_table_insert (self->ease_props, g_strdup (name), ease_prop);
+    add_ease_prop (self, pspec, start, end);
 
     n_params++;
   } while ((name = va_arg (var_args, const gchar *)));
@@ -453,3 +500,24 @@ phoc_property_easer_set_props (PhocPropertyEaser *self,
   va_end (var_args);
   return n;
 }
+
+/**
+ * phoc_property_easer_install_float_setter:
+ * @pspec: The `float` property
+ * @setter: (scope forever): The setter for the property
+ *
+ * Installs a setter that is used instead of `g_object_set_property()`
+ * when easing the given property. This avoids the property lookup and
+ * `GValue` handling on every frame. The setter is responsible for
+ * emitting `notify` if needed.
+ *
+ * Usually called from `class_init` for properties that are frequently
+ * animated.
+ */
+void
+phoc_property_easer_install_float_setter (GParamSpec *pspec, PhocPropertyEaserFloatSetter setter)
+{
+  g_return_if_fail (G_IS_PARAM_SPEC_FLOAT (pspec));
+
+  g_param_spec_set_qdata (pspec, float_setter_quark (), setter);
+}
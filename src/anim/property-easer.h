@@ -16,6 +16,15 @@ G_BEGIN_DECLS
 
 G_DECLARE_FINAL_TYPE (PhocPropertyEaser, phoc_property_easer, PHOC, PROPERTY_EASER, GObject)
 
+/**
+ * PhocPropertyEaserFloatSetter:
+ * @object: The object to set the property on
+ * @value: The new value
+ *
+ * Sets an eased `float` property directly.
+ */
+typedef void (*PhocPropertyEaserFloatSetter) (GObject *object, float value);
+
 PhocPropertyEaser    *phoc_property_easer_new              (GObject            *target);
 void                  phoc_property_easer_set_progress     (PhocPropertyEaser  *self,
                                                             float               progress);
@@ -26,5 +35,7 @@ PhocEasing            phoc_property_easer_get_easing       (PhocPropertyEaser  *
 guint                 phoc_property_easer_set_props        (PhocPropertyEaser  *self,
                                                             const gchar        *first_property_name,
                                                             ...) G_GNUC_NULL_TERMINATED;
+void                  phoc_property_easer_install_float_setter (GParamSpec                  *pspec,
+                                                                PhocPropertyEaserFloatSetter setter);
 
 G_END_DECLS
@@ -46,6 +46,7 @@ struct _PhocTimedAnimation {
   PhocAnimatable      *animatable;
   PhocPropertyEaser   *prop_easer;
   gint64               elapsed_ms;
+  gint64               start_us;
   int                  duration;
   PhocAnimationState   state;
   guint                frame_callback_id;
@@ -130,15 +131,19 @@ stop_animation (PhocTimedAnimation *self)
 
 static gboolean
 on_frame_callback (PhocAnimatable *animatable,
-                   guint64         last_frame,
+                   guint64         frame_time,
                    gpointer        user_data)
 {
   PhocTimedAnimation *self = PHOC_TIMED_ANIMATION (user_data);
-  guint64 now = g_get_monotonic_time ();
-  guint t = self->elapsed_ms + ((now - last_frame) / 1000);
+  guint t;
+
+  /* The animation starts with the first frame it's displayed in */
+  if (self->start_us == 0)
+    self->start_us = frame_time;
+  t = (frame_time - self->start_us) / 1000;
 
   g_debug ("t: %d/%d", t, self->duration);
-  if (self->elapsed_ms > self->duration) {
+  if (t >= self->duration) {
     self->frame_callback_id = 0;
     phoc_timed_animation_skip (self);
     return G_SOURCE_REMOVE;
@@ -167,6 +172,7 @@ play (PhocTimedAnimation *self)
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_STATE]);
 
   self->elapsed_ms = 0;
+  self->start_us = 0;
 
   if (self->frame_callback_id)
     return;
@@ -480,6 +486,7 @@ phoc_timed_animation_skip (PhocTimedAnimation *self)
 
   update_properties (self, self->duration);
   self->elapsed_ms = 0;
+  self->start_us = 0;
 
   g_object_thaw_notify (G_OBJECT (self));
 
@@ -552,6 +559,7 @@ phoc_timed_animation_reset (PhocTimedAnimation *self)
 
   update_properties (self, 0);
   self->elapsed_ms = 0;
+  self->start_us = 0;
 
   g_object_thaw_notify (G_OBJECT (self));
 }
@@ -732,6 +732,8 @@ on_drag_update (PhocGesture *gesture, double off_x, double off_y, PhocCursor *se
 {
   PhocCursorPrivate *priv;
   PhocDraggableSurfaceState state;
+  PhocEventSequence *sequence;
+  guint32 time_msec = 0;
 
   g_assert (PHOC_IS_GESTURE (gesture));
   g_assert (PHOC_IS_CURSOR (self));
@@ -740,7 +742,11 @@ on_drag_update (PhocGesture *gesture, double off_x, double off_y, PhocCursor *se
   if (!priv->drag_surface)
     return;
 
-  state = phoc_draggable_layer_surface_drag_update (priv->drag_surface, off_x, off_y);
+  sequence = phoc_gesture_single_get_current_sequence (PHOC_GESTURE_SINGLE (gesture));
+  if (!phoc_gesture_get_last_update_time (gesture, sequence, &time_msec))
+    time_msec = g_get_monotonic_time () / 1000;
+
+  state = phoc_draggable_layer_surface_drag_update (priv->drag_surface, off_x, off_y, time_msec);
   switch (state) {
   case PHOC_DRAGGABLE_SURFACE_STATE_DRAGGING:
     if (phoc_seat_has_touch (self->seat)) {
@@ -760,7 +766,7 @@ on_drag_update (PhocGesture *gesture, double off_x, double off_y, PhocCursor *se
     break;
   case PHOC_DRAGGABLE_SURFACE_STATE_REJECTED:
     phoc_gesture_reset (gesture);
-    phoc_draggable_layer_surface_drag_end (priv->drag_surface, off_x, off_y);
+    phoc_draggable_layer_surface_drag_end (priv->drag_surface, off_x, off_y, time_msec);
     break;
   default:
     /* nothing todo */
@@ -773,6 +779,8 @@ static void
 on_drag_end (PhocGesture *gesture, double off_x, double off_y, PhocCursor *self)
 {
   PhocCursorPrivate *priv;
+  PhocEventSequence *sequence;
+  guint32 time_msec = 0;
 
   g_assert (PHOC_IS_GESTURE (gesture));
   g_assert (PHOC_IS_CURSOR (self));
@@ -781,7 +789,11 @@ on_drag_end (PhocGesture *gesture, double off_x, double off_y, PhocCursor *self)
   if (!priv->drag_surface)
     return;
 
-  phoc_draggable_layer_surface_drag_end (priv->drag_surface, off_x, off_y);
+  sequence = phoc_gesture_single_get_current_sequence (PHOC_GESTURE_SINGLE (gesture));
+  if (!phoc_gesture_get_last_update_time (gesture, sequence, &time_msec))
+    time_msec = g_get_monotonic_time () / 1000;
+
+  phoc_draggable_layer_surface_drag_end (priv->drag_surface, off_x, off_y, time_msec);
 }
 
 
@@ -1003,6 +1015,7 @@ handle_pointer_motion (struct wl_listener *listener, void *data)
   double dy_unaccel = event->unaccel_dy;
 
   wlr_idle_notify_activity (desktop->idle, self->seat->seat);
+  phoc_debug_stats_notify_input (desktop->debug_stats, event->time_msec);
 
   wlr_relative_pointer_manager_v1_send_relative_motion (
     server->desktop->relative_pointer_manager,
@@ -1049,6 +1062,7 @@ handle_pointer_motion_absolute (struct wl_listener *listener, void *data)
   double lx, ly;
 
   wlr_idle_notify_activity (desktop->idle, self->seat->seat);
+  phoc_debug_stats_notify_input (desktop->debug_stats, event->time_msec);
   wlr_cursor_absolute_to_layout_coords (self->cursor, &event->pointer->base, event->x,
                                         event->y, &lx, &ly);
 
@@ -1086,6 +1100,7 @@ handle_pointer_button (struct wl_listener *listener, void *data)
   bool is_touch = event->pointer->base.type == WLR_INPUT_DEVICE_TOUCH;
 
   wlr_idle_notify_activity (desktop->idle, self->seat->seat);
+  phoc_debug_stats_notify_input (desktop->debug_stats, event->time_msec);
   g_debug ("%s %d is_touch: %d", __func__, __LINE__, is_touch);
   if (!is_touch) {
     type = event->state ? PHOC_EVENT_BUTTON_PRESS : PHOC_EVENT_BUTTON_RELEASE;
@@ -1155,6 +1170,7 @@ phoc_cursor_handle_touch_down (PhocCursor                  *self,
   PhocTouchPoint *touch_point;
   double lx, ly;
 
+  phoc_debug_stats_notify_input (desktop->debug_stats, event->time_msec);
   touch_point = phoc_cursor_add_touch_point (self, event);
   lx = touch_point->lx;
   ly = touch_point->ly;
@@ -1254,6 +1270,7 @@ phoc_cursor_handle_touch_motion (PhocCursor                    *self,
 
   touch_point = phoc_cursor_update_touch_point (self, event);
   g_return_if_fail (touch_point);
+  phoc_debug_stats_notify_input (desktop->debug_stats, event->time_msec);
   lx = touch_point->lx;
   ly = touch_point->ly;
   handle_gestures_for_event_at (self, lx, ly, PHOC_EVENT_TOUCH_UPDATE, event, sizeof (*event));
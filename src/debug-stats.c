@@ -0,0 +1,281 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phoc-debug-stats"
+
+#include "phoc-config.h"
+#include "debug-stats.h"
+#include "server.h"
+
+#include "phoc-debug-stats-unstable-v1-protocol.h"
+
+#define DEBUG_STATS_VERSION 1
+/* Input timestamps further back are from a different clock */
+#define INPUT_LATENCY_MAX_MS 1000
+
+/**
+ * PhocDebugStats:
+ *
+ * Implements the private debug stats protocol that lets local tools
+ * subscribe to live rendering statistics of an output.
+ *
+ * Nothing is collected unless a client subscribed.
+ */
+struct _PhocDebugStats {
+  GObject           parent;
+
+  struct wl_global *global;
+  GSList           *resources;
+  /* PhocOutputStats */
+  GSList           *output_stats;
+
+  /* Time of the oldest input event since the last frame, 0 if none */
+  guint32           input_time_msec;
+};
+
+G_DEFINE_TYPE (PhocDebugStats, phoc_debug_stats, G_TYPE_OBJECT)
+
+typedef struct {
+  struct wl_resource *resource;
+  PhocDebugStats     *debug_stats;
+  /* NULL once the output is gone */
+  PhocOutput         *output;
+} PhocOutputStats;
+
+
+static void
+resource_handle_destroy (struct wl_client *client, struct wl_resource *resource)
+{
+  wl_resource_destroy (resource);
+}
+
+
+static void
+output_stats_handle_resource_destroy (struct wl_resource *resource)
+{
+  PhocOutputStats *output_stats = wl_resource_get_user_data (resource);
+
+  output_stats->debug_stats->output_stats = g_slist_remove (output_stats->debug_stats->output_stats,
+                                                            output_stats);
+  g_free (output_stats);
+}
+
+
+static const struct zphoc_output_stats_v1_interface output_stats_impl = {
+  .destroy = resource_handle_destroy,
+};
+
+
+static void
+handle_get_output_stats (struct wl_client   *client,
+                         struct wl_resource *debug_stats_resource,
+                         uint32_t            id,
+                         struct wl_resource *output_resource)
+{
+  PhocDebugStats *self = wl_resource_get_user_data (debug_stats_resource);
+  struct wlr_output *wlr_output = wlr_output_from_resource (output_resource);
+  PhocOutputStats *output_stats;
+
+  g_assert (PHOC_IS_DEBUG_STATS (self));
+
+  output_stats = g_new0 (PhocOutputStats, 1);
+  output_stats->debug_stats = self;
+  /* Inert right away if the output is already gone */
+  output_stats->output = wlr_output ? wlr_output->data : NULL;
+  output_stats->resource = wl_resource_create (client,
+                                               &zphoc_output_stats_v1_interface,
+                                               wl_resource_get_version (debug_stats_resource),
+                                               id);
+  if (output_stats->resource == NULL) {
+    g_free (output_stats);
+    wl_client_post_no_memory (client);
+    return;
+  }
+
+  g_debug ("New output stats %p (res %p)", output_stats, output_stats->resource);
+  wl_resource_set_implementation (output_stats->resource,
+                                  &output_stats_impl,
+                                  output_stats,
+                                  output_stats_handle_resource_destroy);
+
+  self->output_stats = g_slist_prepend (self->output_stats, output_stats);
+}
+
+
+static void
+debug_stats_handle_resource_destroy (struct wl_resource *resource)
+{
+  PhocDebugStats *self = wl_resource_get_user_data (resource);
+
+  g_assert (PHOC_IS_DEBUG_STATS (self));
+
+  g_debug ("Destroying debug_stats %p (res %p)", self, resource);
+  self->resources = g_slist_remove (self->resources, resource);
+}
+
+
+static const struct zphoc_debug_stats_v1_interface debug_stats_impl = {
+  .destroy = resource_handle_destroy,
+  .get_output_stats = handle_get_output_stats,
+};
+
+
+static void
+debug_stats_bind (struct wl_client *client, void *data, uint32_t version, uint32_t id)
+{
+  PhocDebugStats *self = PHOC_DEBUG_STATS (data);
+  struct wl_resource *resource = wl_resource_create (client, &zphoc_debug_stats_v1_interface,
+                                                     version, id);
+
+  g_assert (PHOC_IS_DEBUG_STATS (self));
+
+  wl_resource_set_implementation (resource,
+                                  &debug_stats_impl,
+                                  self,
+                                  debug_stats_handle_resource_destroy);
+
+  self->resources = g_slist_prepend (self->resources, resource);
+}
+
+
+static void
+phoc_debug_stats_finalize (GObject *object)
+{
+  PhocDebugStats *self = PHOC_DEBUG_STATS (object);
+
+  /* Clients are gone by now so nothing references us anymore */
+  g_clear_pointer (&self->global, wl_global_destroy);
+
+  G_OBJECT_CLASS (phoc_debug_stats_parent_class)->finalize (object);
+}
+
+
+static void
+phoc_debug_stats_class_init (PhocDebugStatsClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = phoc_debug_stats_finalize;
+}
+
+
+static void
+phoc_debug_stats_init (PhocDebugStats *self)
+{
+  struct wl_display *display = phoc_server_get_default ()->wl_display;
+
+  self->global = wl_global_create (display, &zphoc_debug_stats_v1_interface,
+                                   DEBUG_STATS_VERSION, self, debug_stats_bind);
+}
+
+
+PhocDebugStats *
+phoc_debug_stats_new (void)
+{
+  return PHOC_DEBUG_STATS (g_object_new (PHOC_TYPE_DEBUG_STATS, NULL));
+}
+
+/**
+ * phoc_debug_stats_is_active:
+ * @self: The debug stats
+ *
+ * Returns: %TRUE if a client subscribed to statistics
+ */
+gboolean
+phoc_debug_stats_is_active (PhocDebugStats *self)
+{
+  g_assert (PHOC_IS_DEBUG_STATS (self));
+
+  return self->output_stats != NULL;
+}
+
+/**
+ * phoc_debug_stats_notify_input:
+ * @self: The debug stats
+ * @time_msec: The input event's timestamp
+ *
+ * Notifies about an input event so the latency until the next frame
+ * can be reported.
+ */
+void
+phoc_debug_stats_notify_input (PhocDebugStats *self, guint32 time_msec)
+{
+  g_assert (PHOC_IS_DEBUG_STATS (self));
+
+  if (G_LIKELY (self->output_stats == NULL))
+    return;
+
+  if (self->input_time_msec == 0)
+    self->input_time_msec = time_msec;
+}
+
+/**
+ * phoc_debug_stats_notify_frame:
+ * @self: The debug stats
+ * @output: The output that committed a frame
+ * @n_allocs: The number of allocations while building the frame
+ *
+ * Sends the statistics of the frame that was just committed on
+ * @output to all subscribed clients.
+ */
+void
+phoc_debug_stats_notify_frame (PhocDebugStats *self, PhocOutput *output, guint64 n_allocs)
+{
+  const PhocOutputFrameInfo *info;
+  guint32 input_latency = 0;
+
+  g_assert (PHOC_IS_DEBUG_STATS (self));
+
+  if (G_LIKELY (self->output_stats == NULL))
+    return;
+
+  if (self->input_time_msec) {
+    guint32 now_msec = g_get_monotonic_time () / 1000;
+
+    input_latency = now_msec - self->input_time_msec;
+    if (input_latency > INPUT_LATENCY_MAX_MS)
+      input_latency = 0;
+    self->input_time_msec = 0;
+  }
+
+  info = phoc_output_get_frame_info (output);
+  for (GSList *l = self->output_stats; l; l = l->next) {
+    PhocOutputStats *output_stats = l->data;
+
+    if (output_stats->output != output)
+      continue;
+
+    zphoc_output_stats_v1_send_frame (output_stats->resource,
+                                      MIN (info->render_time_us, G_MAXUINT32),
+                                      MIN (info->damage_area, G_MAXUINT32),
+                                      info->n_draw_calls,
+                                      MIN (n_allocs, G_MAXUINT32),
+                                      input_latency,
+                                      info->n_views,
+                                      info->n_surfaces,
+                                      info->scanout);
+  }
+}
+
+/**
+ * phoc_debug_stats_remove_output:
+ * @self: The debug stats
+ * @output: The output that goes away
+ *
+ * Makes the subscriptions for @output inert.
+ */
+void
+phoc_debug_stats_remove_output (PhocDebugStats *self, PhocOutput *output)
+{
+  g_assert (PHOC_IS_DEBUG_STATS (self));
+
+  for (GSList *l = self->output_stats; l; l = l->next) {
+    PhocOutputStats *output_stats = l->data;
+
+    if (output_stats->output == output)
+      output_stats->output = NULL;
+  }
+}
@@ -0,0 +1,29 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "output.h"
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define PHOC_TYPE_DEBUG_STATS (phoc_debug_stats_get_type ())
+
+G_DECLARE_FINAL_TYPE (PhocDebugStats, phoc_debug_stats, PHOC, DEBUG_STATS, GObject)
+
+PhocDebugStats *phoc_debug_stats_new             (void);
+gboolean        phoc_debug_stats_is_active       (PhocDebugStats *self);
+void            phoc_debug_stats_notify_input    (PhocDebugStats *self,
+                                                  guint32         time_msec);
+void            phoc_debug_stats_notify_frame    (PhocDebugStats *self,
+                                                  PhocOutput     *output,
+                                                  guint64         n_allocs);
+void            phoc_debug_stats_remove_output   (PhocDebugStats *self,
+                                                  PhocOutput     *output);
+
+G_END_DECLS
@@ -38,6 +38,7 @@
 #include "output.h"
 #include "seat.h"
 #include "server.h"
+#include "transaction.h"
 #include "utils.h"
 #include "view.h"
 #include "virtual.h"
@@ -50,6 +51,10 @@
 #include "xdg-surface.h"
 #include "xwayland-surface.h"
 
+/* How long to wait for clients to resize before showing a new frame anyway */
+#define PHOC_TRANSACTION_TIMEOUT_MS 100
+#define FRAME_STATS_INTERVAL_S 5
+
 /**
  * PhocDesktop:
  *
@@ -72,6 +77,24 @@ typedef struct _PhocDesktopPrivate {
 
   GSettings       *settings;
   GSettings       *interface_settings;
+
+  PhocTransaction *transaction;
+
+  /* PHOC_DEBUG=frame-stats */
+  guint            frame_stats_id;
+
+#ifdef PHOC_XWAYLAND
+  /* wlroots keeps a reference to the pixels, not a copy */
+  struct {
+    guint8        *pixels;
+    guint32        width, height;
+    gint32         hotspot_x, hotspot_y;
+  } xwayland_cursor;
+
+  guint            n_xwayland_surfaces;
+  guint            xwayland_idle_id;
+  GCancellable    *xwayland_atoms_cancel;
+#endif
 } PhocDesktopPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (PhocDesktop, phoc_desktop, G_TYPE_OBJECT);
@@ -382,6 +405,9 @@ handle_layout_change (struct wl_listener *listener, void *data)
     phoc_view_move (view, center_x - box.width / 2, center_y - box.height / 2);
   }
 
+  wl_list_for_each (view, &self->views, link)
+    phoc_view_update_intersecting_outputs (view);
+
   /* Damage all outputs since the move above damaged old layout space */
   wl_list_for_each(output, &self->outputs, link)
     phoc_output_damage_whole(output);
@@ -502,20 +528,83 @@ static const char *atom_map[XWAYLAND_ATOM_LAST] = {
 	"_NET_WM_WINDOW_TYPE_DIALOG"
 };
 
-static
-void handle_xwayland_ready(struct wl_listener *listener, void *data) {
-  PhocDesktop *desktop = wl_container_of (
-        listener, desktop, xwayland_ready);
-  xcb_connection_t *xcb_conn = xcb_connect (NULL, NULL);
+/* wlroots only restarts XWayland lazily if it ran for more than that */
+#define XWAYLAND_MIN_RUNTIME_S 5
+
+static gboolean
+on_xwayland_idle_timeout (gpointer data)
+{
+  PhocDesktop *self = PHOC_DESKTOP (data);
+  PhocDesktopPrivate *priv = phoc_desktop_get_instance_private (self);
+  struct wlr_xwayland_server *server = self->xwayland->server;
+
+  if (server->client == NULL) {
+    priv->xwayland_idle_id = 0;
+    return G_SOURCE_REMOVE;
+  }
+
+  /* Otherwise wlroots would not restart it */
+  if (time (NULL) - server->server_start <= XWAYLAND_MIN_RUNTIME_S)
+    return G_SOURCE_CONTINUE;
+
+  g_debug ("No X11 windows for %us, stopping XWayland", self->config->xwayland_idle_timeout);
+  priv->xwayland_idle_id = 0;
+  /* wlroots keeps listening on the X11 sockets and restarts it on the next connection */
+  wl_client_destroy (server->client);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+xwayland_schedule_idle_check (PhocDesktop *self)
+{
+  PhocDesktopPrivate *priv = phoc_desktop_get_instance_private (self);
+  guint timeout = self->config->xwayland_idle_timeout;
+
+  if (self->xwayland == NULL || !self->config->xwayland_lazy || timeout == 0)
+    return;
+
+  if (priv->n_xwayland_surfaces || priv->xwayland_idle_id)
+    return;
+
+  priv->xwayland_idle_id = g_timeout_add_seconds (timeout, on_xwayland_idle_timeout, self);
+  g_source_set_name_by_id (priv->xwayland_idle_id, "[phoc] xwayland idle");
+}
+
+
+static void
+on_xwayland_surface_destroy (PhocDesktop *self, PhocView *view)
+{
+  PhocDesktopPrivate *priv = phoc_desktop_get_instance_private (self);
+
+  g_assert (PHOC_IS_DESKTOP (self));
+  g_return_if_fail (priv->n_xwayland_surfaces > 0);
+
+  priv->n_xwayland_surfaces--;
+  xwayland_schedule_idle_check (self);
+}
+
+
+static void
+resolve_xwayland_atoms_thread (GTask        *task,
+                               gpointer      source_object,
+                               gpointer      task_data,
+                               GCancellable *cancellable)
+{
+  const char *display_name = task_data;
+  g_autofree xcb_atom_t *atoms = g_new0 (xcb_atom_t, XWAYLAND_ATOM_LAST);
+  xcb_intern_atom_cookie_t cookies[XWAYLAND_ATOM_LAST];
+  xcb_connection_t *xcb_conn = xcb_connect (display_name, NULL);
 
   int err = xcb_connection_has_error (xcb_conn);
   if (err) {
-    g_warning ("XCB connect failed: %d", err);
+    xcb_disconnect (xcb_conn);
+    g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_FAILED,
+                             "XCB connect failed: %d", err);
     return;
   }
 
-  xcb_intern_atom_cookie_t cookies[XWAYLAND_ATOM_LAST];
-
   for (size_t i = 0; i < XWAYLAND_ATOM_LAST; i++)
     cookies[i] = xcb_intern_atom (xcb_conn, 0, strlen (atom_map[i]), atom_map[i]);
 
@@ -530,12 +619,58 @@ void handle_xwayland_ready(struct wl_listener *listener, void *data) {
     }
 
     if (reply)
-      desktop->xwayland_atoms[i] = reply->atom;
+      atoms[i] = reply->atom;
 
     free (reply);
   }
 
   xcb_disconnect (xcb_conn);
+  g_task_return_pointer (task, g_steal_pointer (&atoms), g_free);
+}
+
+
+static void
+on_xwayland_atoms_resolved (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  g_autoptr (GError) err = NULL;
+  g_autofree xcb_atom_t *atoms = NULL;
+  PhocDesktop *self;
+
+  atoms = g_task_propagate_pointer (G_TASK (res), &err);
+  if (atoms == NULL) {
+    if (!g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+      g_warning ("Failed to resolve XWayland atoms: %s", err->message);
+    return;
+  }
+
+  self = PHOC_DESKTOP (user_data);
+  memcpy (self->xwayland_atoms, atoms, sizeof (self->xwayland_atoms));
+  self->xwayland_atoms_resolved = TRUE;
+  g_debug ("XWayland atoms resolved");
+}
+
+
+static
+void handle_xwayland_ready(struct wl_listener *listener, void *data) {
+  PhocDesktop *desktop = wl_container_of (
+        listener, desktop, xwayland_ready);
+  PhocDesktopPrivate *priv = phoc_desktop_get_instance_private (desktop);
+  g_autoptr (GTask) task = NULL;
+
+  /* Clients might connect without ever mapping a window */
+  xwayland_schedule_idle_check (desktop);
+
+  /* Atoms of a previous XWayland instance are stale */
+  g_cancellable_cancel (priv->xwayland_atoms_cancel);
+  g_clear_object (&priv->xwayland_atoms_cancel);
+  desktop->xwayland_atoms_resolved = FALSE;
+
+  /* Connecting and the round trips would block the compositor */
+  priv->xwayland_atoms_cancel = g_cancellable_new ();
+  task = g_task_new (NULL, priv->xwayland_atoms_cancel, on_xwayland_atoms_resolved, desktop);
+  g_task_set_source_tag (task, handle_xwayland_ready);
+  g_task_set_task_data (task, g_strdup (desktop->xwayland->display_name), g_free);
+  g_task_run_in_thread (task, resolve_xwayland_atoms_thread);
 }
 
 static
@@ -557,6 +692,8 @@ static void
 handle_xwayland_surface (struct wl_listener *listener, void *data)
 {
   PhocDesktop *desktop = wl_container_of (listener, desktop, xwayland_surface);
+  PhocDesktopPrivate *priv = phoc_desktop_get_instance_private (desktop);
+  PhocXWaylandSurface *view;
 
   struct wlr_xwayland_surface *surface = data;
   g_debug ("new xwayland surface: title=%s, class=%s, instance=%s",
@@ -564,7 +701,13 @@ handle_xwayland_surface (struct wl_listener *listener, void *data)
   wlr_xwayland_surface_ping(surface);
 
   /* Ref is dropped on surface destroy */
-  phoc_xwayland_surface_new (surface);
+  view = phoc_xwayland_surface_new (surface);
+
+  priv->n_xwayland_surfaces++;
+  g_clear_handle_id (&priv->xwayland_idle_id, g_source_remove);
+  g_signal_connect_swapped (view, "surface-destroy",
+                            G_CALLBACK (on_xwayland_surface_destroy),
+                            desktop);
 }
 
 #endif /* PHOC_XWAYLAND */
@@ -573,12 +716,17 @@ static void
 on_output_destroyed (PhocDesktop *self, PhocOutput *destroyed_output)
 {
   PhocOutput *output;
+  PhocView *view;
   char *input_name;
   GHashTableIter iter;
 
   g_assert (PHOC_IS_DESKTOP (self));
   g_assert (PHOC_IS_OUTPUT (destroyed_output));
 
+  wl_list_for_each (view, &self->views, link)
+    phoc_view_remove_intersecting_output (view, destroyed_output);
+  phoc_debug_stats_remove_output (self->debug_stats, destroyed_output);
+
   g_hash_table_iter_init (&iter, self->input_output_map);
   while (g_hash_table_iter_next (&iter, (gpointer) &input_name,
                                  (gpointer) &output)) {
@@ -610,17 +758,88 @@ handle_new_output (struct wl_listener *listener, void *data)
 }
 
 
+static gboolean
+on_frame_stats_timeout (gpointer data)
+{
+  PhocDesktop *self = PHOC_DESKTOP (data);
+  PhocOutput *output;
+  PhocView *view;
+
+  wl_list_for_each (output, &self->outputs, link) {
+    const PhocOutputFrameStats *stats = phoc_output_get_frame_stats (output);
+
+    g_message ("%s: %" G_GUINT64_FORMAT " frames rendered (%" G_GUINT64_FORMAT " scanned out), "
+               "%" G_GUINT64_FORMAT " presented, %" G_GUINT64_FORMAT " discarded",
+               phoc_output_get_name (output), stats->n_rendered, stats->n_scanout,
+               stats->n_presented, stats->n_discarded);
+  }
+
+  wl_list_for_each (view, &self->views, link) {
+    const PhocViewFrameStats *stats = phoc_view_get_frame_stats (view);
+    double latency_ms = 0.0;
+
+    if (!phoc_view_is_mapped (view))
+      continue;
+
+    if (stats->n_latencies)
+      latency_ms = stats->latency_sum_us / (double)stats->n_latencies / 1000.0;
+
+    g_message ("%s: %" G_GUINT64_FORMAT " commits, %" G_GUINT64_FORMAT " missed frames, "
+               "%.2f ms average commit latency",
+               phoc_view_get_app_id (view) ?: "(no app-id)",
+               stats->n_commits, stats->n_missed, latency_ms);
+  }
+
+  return G_SOURCE_CONTINUE;
+}
+
+
+#ifdef PHOC_XWAYLAND
+static void
+phoc_desktop_load_xwayland_cursor (PhocDesktop *self)
+{
+  PhocDesktopPrivate *priv = phoc_desktop_get_instance_private (self);
+  const char *cursor_default = PHOC_XCURSOR_DEFAULT;
+  struct wlr_xcursor_manager *xcursor_manager;
+
+  /* Only keep the default cursor image around, not the whole theme */
+  xcursor_manager = wlr_xcursor_manager_create (NULL, PHOC_XCURSOR_SIZE);
+  g_return_if_fail (xcursor_manager);
+  if (!wlr_xcursor_manager_load (xcursor_manager, 1))
+    g_critical ("Cannot load XWayland XCursor theme");
+
+  struct wlr_xcursor *xcursor = wlr_xcursor_manager_get_xcursor(xcursor_manager,
+                                                                cursor_default, 1);
+  if (xcursor != NULL) {
+    struct wlr_xcursor_image *image = xcursor->images[0];
+
+    priv->xwayland_cursor.pixels = g_malloc (image->width * image->height * 4);
+    memcpy (priv->xwayland_cursor.pixels, image->buffer, image->width * image->height * 4);
+    priv->xwayland_cursor.width = image->width;
+    priv->xwayland_cursor.height = image->height;
+    priv->xwayland_cursor.hotspot_x = image->hotspot_x;
+    priv->xwayland_cursor.hotspot_y = image->hotspot_y;
+
+    /* Reapplied by wlroots whenever XWayland (re)starts */
+    wlr_xwayland_set_cursor (self->xwayland, priv->xwayland_cursor.pixels,
+                             priv->xwayland_cursor.width * 4,
+                             priv->xwayland_cursor.width,
+                             priv->xwayland_cursor.height,
+                             priv->xwayland_cursor.hotspot_x,
+                             priv->xwayland_cursor.hotspot_y);
+  }
+  wlr_xcursor_manager_destroy (xcursor_manager);
+}
+#endif
+
+
 static void
 phoc_desktop_setup_xwayland (PhocDesktop *self)
 {
 #ifdef PHOC_XWAYLAND
-  const char *cursor_default = PHOC_XCURSOR_DEFAULT;
   PhocConfig *config = self->config;
   PhocServer *server = phoc_server_get_default ();
 
-  self->xcursor_manager = wlr_xcursor_manager_create(NULL, PHOC_XCURSOR_SIZE);
-  g_return_if_fail (self->xcursor_manager);
-
   if (config->xwayland) {
     self->xwayland = wlr_xwayland_create(server->wl_display,
 					 server->compositor, config->xwayland_lazy);
@@ -643,18 +862,6 @@ phoc_desktop_setup_xwayland (PhocDesktop *self)
     self->xwayland_remove_startup_id.notify = handle_xwayland_remove_startup_id;
 
     g_setenv ("DISPLAY", self->xwayland->display_name, true);
-
-    if (!wlr_xcursor_manager_load(self->xcursor_manager, 1))
-      g_critical ("Cannot load XWayland XCursor theme");
-
-    struct wlr_xcursor *xcursor = wlr_xcursor_manager_get_xcursor(
-								  self->xcursor_manager, cursor_default, 1);
-    if (xcursor != NULL) {
-      struct wlr_xcursor_image *image = xcursor->images[0];
-      wlr_xwayland_set_cursor(self->xwayland, image->buffer,
-			      image->width * 4, image->width, image->height, image->hotspot_x,
-			      image->hotspot_y);
-    }
   }
 #endif
 }
@@ -699,10 +906,8 @@ phoc_desktop_constructed (GObject *object)
   g_setenv("XCURSOR_SIZE", cursor_size_fmt, 1);
 
   phoc_desktop_setup_xwayland (self);
+  phoc_server_trace_startup (server, "xwayland set up");
 
-  self->gamma_control_manager_v1 = wlr_gamma_control_manager_v1_create(server->wl_display);
-  self->export_dmabuf_manager_v1 =
-    wlr_export_dmabuf_manager_v1_create(server->wl_display);
   self->server_decoration_manager =
     wlr_server_decoration_manager_create(server->wl_display);
   wlr_server_decoration_manager_set_default_mode(self->server_decoration_manager,
@@ -727,6 +932,7 @@ phoc_desktop_constructed (GObject *object)
   priv->idle_inhibit = phoc_idle_inhibit_create (self->idle);
   self->gtk_shell = phoc_gtk_shell_create(self, server->wl_display);
   self->phosh = phoc_phosh_private_new ();
+  self->debug_stats = phoc_debug_stats_new ();
 
   self->xdg_activation_v1 = wlr_xdg_activation_v1_create (server->wl_display);
   self->xdg_activation_v1_request_activate.notify = phoc_xdg_activation_v1_handle_request_activate;
@@ -753,11 +959,6 @@ phoc_desktop_constructed (GObject *object)
   self->xdg_toplevel_decoration.notify = handle_xdg_toplevel_decoration;
   wlr_viewporter_create(server->wl_display);
 
-  struct wlr_xdg_foreign_registry *foreign_registry =
-                wlr_xdg_foreign_registry_create(server->wl_display);
-  wlr_xdg_foreign_v1_create(server->wl_display, foreign_registry);
-  wlr_xdg_foreign_v2_create(server->wl_display, foreign_registry);
-
   self->pointer_constraints =
     wlr_pointer_constraints_v1_create(server->wl_display);
   self->pointer_constraint.notify = handle_pointer_constraint;
@@ -797,9 +998,18 @@ phoc_desktop_constructed (GObject *object)
                             G_CALLBACK (auto_maximize_changed_cb), self);
   auto_maximize_changed_cb (self, "auto-maximize", priv->settings);
   g_settings_bind (priv->settings, "scale-to-fit", self, "scale-to-fit", G_SETTINGS_BIND_DEFAULT);
+  g_settings_bind (priv->settings, "live-drag-updates", self->layer_shell_effects,
+                   "live-drag-updates", G_SETTINGS_BIND_GET);
 
   /* org.gnome.desktop.interface settings */
   priv->interface_settings = g_settings_new ("org.gnome.desktop.interface");
+  if (G_UNLIKELY (server->debug_flags & PHOC_SERVER_DEBUG_FLAG_FRAME_STATS)) {
+    priv->frame_stats_id = g_timeout_add_seconds (FRAME_STATS_INTERVAL_S,
+                                                  on_frame_stats_timeout,
+                                                  self);
+    g_source_set_name_by_id (priv->frame_stats_id, "[phoc] frame stats");
+  }
+
   if (server->debug_flags & PHOC_SERVER_DEBUG_FLAG_DISABLE_ANIMATIONS) {
     priv->enable_animations = FALSE;
   } else {
@@ -840,14 +1050,21 @@ phoc_desktop_finalize (GObject *object)
     wl_list_remove (&self->xwayland_remove_startup_id.link);
   }
 
-  g_clear_pointer (&self->xcursor_manager, wlr_xcursor_manager_destroy);
+  g_clear_handle_id (&priv->xwayland_idle_id, g_source_remove);
+  /* A lookup finishing later must not touch the desktop */
+  g_cancellable_cancel (priv->xwayland_atoms_cancel);
+  g_clear_object (&priv->xwayland_atoms_cancel);
   // We need to shutdown Xwayland before disconnecting all clients, otherwise
   // wlroots will restart it automatically.
   g_clear_pointer (&self->xwayland, wlr_xwayland_destroy);
+  g_clear_pointer (&priv->xwayland_cursor.pixels, g_free);
 #endif
 
+  g_clear_object (&priv->transaction);
+  g_clear_handle_id (&priv->frame_stats_id, g_source_remove);
   g_clear_pointer (&priv->idle_inhibit, phoc_idle_inhibit_destroy);
   g_clear_object (&self->phosh);
+  g_clear_object (&self->debug_stats);
   g_clear_pointer (&self->gtk_shell, phoc_gtk_shell_destroy);
   g_clear_object (&self->layer_shell_effects);
   g_clear_pointer (&self->layout, wlr_output_layout_destroy);
@@ -1154,3 +1371,147 @@ phoc_desktop_get_draggable_layer_surface (PhocDesktop *self, PhocLayerSurface *l
   return phoc_layer_shell_effects_get_draggable_layer_surface_from_layer_surface (
     self->layer_shell_effects, layer_surface);
 }
+
+
+/*
+ * Hold the outputs that show views waiting for clients to resize so
+ * the new geometry shows up at once.
+ */
+static void
+update_held_outputs (PhocDesktop *self, PhocTransaction *transaction)
+{
+  g_autoptr (GList) views = NULL;
+  PhocOutput *output;
+
+  if (transaction && phoc_transaction_is_pending (transaction))
+    views = phoc_transaction_get_views (transaction);
+
+  wl_list_for_each (output, &self->outputs, link) {
+    gboolean held = FALSE;
+
+    for (GList *elem = views; elem; elem = elem->next) {
+      PhocView *view = PHOC_VIEW (elem->data);
+      struct wlr_box box;
+
+      view_get_deco_box (view, &box);
+      if (wlr_output_layout_intersects (self->layout, output->wlr_output, &box)) {
+        held = TRUE;
+        break;
+      }
+    }
+
+    phoc_output_set_held (output, held);
+  }
+}
+
+
+static void
+on_transaction_done (PhocDesktop *self, PhocTransaction *transaction)
+{
+  PhocDesktopPrivate *priv = phoc_desktop_get_instance_private (self);
+  PhocOutput *output;
+
+  g_assert (priv->transaction == transaction);
+  g_clear_object (&priv->transaction);
+  update_held_outputs (self, NULL);
+
+  /* Outputs held off repainting, show all the new geometry at once */
+  wl_list_for_each (output, &self->outputs, link)
+    wlr_output_schedule_frame (output->wlr_output);
+}
+
+/**
+ * phoc_desktop_setup_deferred:
+ * @self: The desktop
+ *
+ * Sets up the parts that aren't needed to get the first frame on
+ * screen. Invoked by the server once the first frame got rendered.
+ */
+void
+phoc_desktop_setup_deferred (PhocDesktop *self)
+{
+  PhocServer *server = phoc_server_get_default ();
+  struct wlr_xdg_foreign_registry *foreign_registry;
+
+  g_assert (PHOC_IS_DESKTOP (self));
+
+  self->gamma_control_manager_v1 = wlr_gamma_control_manager_v1_create (server->wl_display);
+  self->export_dmabuf_manager_v1 = wlr_export_dmabuf_manager_v1_create (server->wl_display);
+
+  foreign_registry = wlr_xdg_foreign_registry_create (server->wl_display);
+  wlr_xdg_foreign_v1_create (server->wl_display, foreign_registry);
+  wlr_xdg_foreign_v2_create (server->wl_display, foreign_registry);
+
+#ifdef PHOC_XWAYLAND
+  if (self->xwayland)
+    phoc_desktop_load_xwayland_cursor (self);
+#endif
+}
+
+/**
+ * phoc_desktop_begin_transaction:
+ * @self: The desktop
+ *
+ * Starts collecting the configures sent to views into a transaction
+ * so that their new geometry shows up in a single frame. If a
+ * transaction is already pending the configures are added to it.
+ * Must be balanced by [method@Desktop.commit_transaction].
+ */
+void
+phoc_desktop_begin_transaction (PhocDesktop *self)
+{
+  PhocDesktopPrivate *priv;
+
+  g_assert (PHOC_IS_DESKTOP (self));
+  priv = phoc_desktop_get_instance_private (self);
+
+  if (priv->transaction == NULL) {
+    priv->transaction = phoc_transaction_new (PHOC_TRANSACTION_TIMEOUT_MS);
+    g_signal_connect_swapped (priv->transaction, "done",
+                              G_CALLBACK (on_transaction_done),
+                              self);
+  }
+
+  phoc_transaction_begin (priv->transaction);
+}
+
+/**
+ * phoc_desktop_commit_transaction:
+ * @self: The desktop
+ *
+ * Stops collecting configures. Outputs don't repaint until all views
+ * committed buffers for their configures or the transaction timed out.
+ */
+void
+phoc_desktop_commit_transaction (PhocDesktop *self)
+{
+  PhocDesktopPrivate *priv;
+
+  g_assert (PHOC_IS_DESKTOP (self));
+  priv = phoc_desktop_get_instance_private (self);
+  g_return_if_fail (priv->transaction);
+
+  phoc_transaction_commit (priv->transaction);
+  /* Might be done right away */
+  if (priv->transaction)
+    update_held_outputs (self, priv->transaction);
+}
+
+/**
+ * phoc_desktop_get_transaction:
+ * @self: The desktop
+ *
+ * Gets the currently collecting or pending transaction.
+ *
+ * Returns: (transfer none) (nullable): The transaction
+ */
+PhocTransaction *
+phoc_desktop_get_transaction (PhocDesktop *self)
+{
+  PhocDesktopPrivate *priv;
+
+  g_assert (PHOC_IS_DESKTOP (self));
+  priv = phoc_desktop_get_instance_private (self);
+
+  return priv->transaction;
+}
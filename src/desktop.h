@@ -1,9 +1,11 @@
 #pragma once
 
 #include "phoc-config.h"
+#include "debug-stats.h"
 #include "gtk-shell.h"
 #include "layer-shell-effects.h"
 #include "phosh-private.h"
+#include "transaction.h"
 #include "view.h"
 #include "xwayland-surface.h"
 
@@ -90,12 +92,12 @@ struct _PhocDesktop {
 	struct wl_listener xdg_activation_v1_request_activate;
 
 #ifdef PHOC_XWAYLAND
-	struct wlr_xcursor_manager *xcursor_manager;
 	struct wlr_xwayland *xwayland;
 	struct wl_listener xwayland_surface;
 	struct wl_listener xwayland_ready;
 	struct wl_listener xwayland_remove_startup_id;
 	xcb_atom_t xwayland_atoms[XWAYLAND_ATOM_LAST];
+	gboolean xwayland_atoms_resolved;
 #endif
 
 	gboolean maximize, scale_to_fit;
@@ -104,6 +106,7 @@ struct _PhocDesktop {
 	/* Protocols without upstreamable implementations */
 	PhocPhoshPrivate *phosh;
 	PhocGtkShell *gtk_shell;
+	PhocDebugStats *debug_stats;
         /* Protocols that should go upstream */
 	PhocLayerShellEffects *layer_shell_effects;
 };
@@ -120,6 +123,10 @@ PhocOutput  *phoc_desktop_find_output (PhocDesktop *self,
                                        const char  *model,
                                        const char  *serial);
 PhocOutput *phoc_desktop_get_builtin_output (PhocDesktop *self);
+void         phoc_desktop_setup_deferred (PhocDesktop *self);
+void         phoc_desktop_begin_transaction (PhocDesktop *self);
+void         phoc_desktop_commit_transaction (PhocDesktop *self);
+PhocTransaction *phoc_desktop_get_transaction (PhocDesktop *self);
 
 struct wlr_surface *phoc_desktop_surface_at(PhocDesktop *desktop,
 		double lx, double ly, double *sx, double *sy,
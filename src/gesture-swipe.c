@@ -17,8 +17,7 @@
 
 #include "gesture-swipe.h"
 #include "phoc-marshalers.h"
-
-#define CAPTURE_THRESHOLD_MS 150
+#include "velocity-tracker.h"
 
 /**
  * PhocGestureSwipe:
@@ -43,32 +42,13 @@ enum {
 };
 static guint signals[N_SIGNALS];
 
-typedef struct _EventData
-{
-  guint32 evtime;
-  int x;
-  int y;
-} EventData;
-
 typedef struct _PhocGestureSwipePrivate {
-  GArray *events;
+  PhocVelocityTracker tracker;
 } PhocGestureSwipePrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (PhocGestureSwipe, phoc_gesture_swipe, PHOC_TYPE_GESTURE_SINGLE)
 
 
-static void
-phoc_gesture_swipe_finalize (GObject *object)
-{
-  PhocGestureSwipe *self = PHOC_GESTURE_SWIPE(object);
-  PhocGestureSwipePrivate *priv = phoc_gesture_swipe_get_instance_private (self);
-
-  g_array_free (priv->events, TRUE);
-
-  G_OBJECT_CLASS (phoc_gesture_swipe_parent_class)->finalize (object);
-}
-
-
 static gboolean
 phoc_gesture_swipe_filter_event (PhocGesture     *gesture,
                                  const PhocEvent *event)
@@ -92,46 +72,21 @@ phoc_gesture_swipe_filter_event (PhocGesture     *gesture,
   return PHOC_GESTURE_CLASS (phoc_gesture_swipe_parent_class)->filter_event (gesture, event);
 }
 
-static void
-phoc_gesture_swipe_clear_backlog (PhocGestureSwipe *gesture,
-                                  guint32           evtime)
-{
-  PhocGestureSwipePrivate *priv;
-  int i, length = 0;
-
-  priv = phoc_gesture_swipe_get_instance_private (gesture);
-
-  for (i = 0; i < (int) priv->events->len; i++) {
-    EventData *data;
-
-    data = &g_array_index (priv->events, EventData, i);
-    if (data->evtime >= evtime - CAPTURE_THRESHOLD_MS) {
-      length = i - 1;
-      break;
-    }
-  }
-
-  if (length > 0)
-    g_array_remove_range (priv->events, 0, length);
-}
-
 static void
 phoc_gesture_swipe_append_event (PhocGestureSwipe  *swipe,
                                 PhocEventSequence *sequence)
 {
   PhocGestureSwipePrivate *priv;
-  EventData new;
+  guint32 evtime;
   double x, y;
 
   priv = phoc_gesture_swipe_get_instance_private (swipe);
-  phoc_gesture_get_last_update_time (PHOC_GESTURE (swipe), sequence, &new.evtime);
-  phoc_gesture_get_point (PHOC_GESTURE (swipe), sequence, &x, &y);
-
-  new.x = x;
-  new.y = y;
+  if (!phoc_gesture_get_last_update_time (PHOC_GESTURE (swipe), sequence, &evtime))
+    return;
+  if (!phoc_gesture_get_point (PHOC_GESTURE (swipe), sequence, &x, &y))
+    return;
 
-  phoc_gesture_swipe_clear_backlog (swipe, new.evtime);
-  g_array_append_val (priv->events, new);
+  phoc_velocity_tracker_add_point (&priv->tracker, evtime, x, y);
 }
 
 static void
@@ -149,34 +104,11 @@ _phoc_gesture_swipe_calculate_velocity (PhocGestureSwipe *gesture,
                                         double           *velocity_y)
 {
   PhocGestureSwipePrivate *priv;
-  PhocEventSequence *sequence;
-  guint32 evtime, diff_time;
-  EventData *start, *end;
-  double diff_x, diff_y;
 
   priv = phoc_gesture_swipe_get_instance_private (gesture);
-  *velocity_x = *velocity_y = 0;
-
-  sequence = phoc_gesture_single_get_current_sequence (PHOC_GESTURE_SINGLE (gesture));
-  phoc_gesture_get_last_update_time (PHOC_GESTURE (gesture), sequence, &evtime);
-  phoc_gesture_swipe_clear_backlog (gesture, evtime);
-
-  if (priv->events->len == 0)
-    return;
-
-  start = &g_array_index (priv->events, EventData, 0);
-  end = &g_array_index (priv->events, EventData, priv->events->len - 1);
-
-  diff_time = end->evtime - start->evtime;
-  diff_x = end->x - start->x;
-  diff_y = end->y - start->y;
-
-  if (diff_time == 0)
-    return;
 
   /* Velocity in pixels/sec */
-  *velocity_x = diff_x * 1000 / diff_time;
-  *velocity_y = diff_y * 1000 / diff_time;
+  phoc_velocity_tracker_get_velocity (&priv->tracker, velocity_x, velocity_y);
 }
 
 static void
@@ -202,19 +134,15 @@ phoc_gesture_swipe_end (PhocGesture       *gesture,
   _phoc_gesture_swipe_calculate_velocity (swipe, &velocity_x, &velocity_y);
   g_signal_emit (gesture, signals[SWIPE], 0, velocity_x, velocity_y);
 
-  if (priv->events->len > 0)
-    g_array_remove_range (priv->events, 0, priv->events->len);
+  phoc_velocity_tracker_reset (&priv->tracker);
 }
 
 
 static void
 phoc_gesture_swipe_class_init (PhocGestureSwipeClass *klass)
 {
-  GObjectClass *object_class = G_OBJECT_CLASS (klass);
   PhocGestureClass *gesture_class = PHOC_GESTURE_CLASS (klass);
 
-  object_class->finalize = phoc_gesture_swipe_finalize;
-
   gesture_class->filter_event = phoc_gesture_swipe_filter_event;
   gesture_class->update = phoc_gesture_swipe_update;
   gesture_class->end = phoc_gesture_swipe_end;
@@ -248,7 +176,7 @@ phoc_gesture_swipe_init (PhocGestureSwipe *self)
   PhocGestureSwipePrivate *priv;
 
   priv = phoc_gesture_swipe_get_instance_private (self);
-  priv->events = g_array_new (FALSE, FALSE, sizeof (EventData));
+  phoc_velocity_tracker_reset (&priv->tracker);
 }
 
 
@@ -9,6 +9,7 @@
 #include <wayland-server-core.h>
 #include "cursor.h"
 #include "input.h"
+#include "keyboard.h"
 #include "seat.h"
 #include "server.h"
 
@@ -120,6 +121,7 @@ phoc_input_finalize (GObject *object)
   PhocInput *self = PHOC_INPUT (object);
 
   g_clear_slist (&self->seats, g_object_unref);
+  phoc_keyboard_clear_keymap_cache ();
 
   G_OBJECT_CLASS (phoc_input_parent_class)->finalize (object);
 }
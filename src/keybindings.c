@@ -34,6 +34,8 @@ typedef struct _PhocKeybindings
   GObject parent;
 
   GSList *bindings;
+  /* combo key -> PhocKeybinding, rebuilt on settings changes */
+  GHashTable *lookup;
   GSettings *settings;
   GSettings *mutter_settings;
 } PhocKeybindings;
@@ -419,14 +421,6 @@ phoc_keybinding_free (PhocKeybinding *self)
 }
 
 
-static gboolean
-key_combo_eq (const PhocKeyCombo *sym1, const PhocKeyCombo *sym2)
-{
-  return (sym1->modifiers == sym2->modifiers &&
-          sym1->keysym == sym2->keysym);
-}
-
-
 static gboolean
 keybinding_by_name (const PhocKeybinding *keybinding, const gchar *name)
 {
@@ -434,17 +428,29 @@ keybinding_by_name (const PhocKeybinding *keybinding, const gchar *name)
 }
 
 
-static gboolean
-keybinding_by_key_combo (const PhocKeybinding *keybinding, const PhocKeyCombo *combo)
+static void
+phoc_keybindings_rebuild_lookup (PhocKeybindings *self)
 {
-  GSList *elem = keybinding->combos;
+  g_hash_table_remove_all (self->lookup);
 
-  while (elem) {
-    if (key_combo_eq (elem->data, combo))
-      return FALSE;
-    elem = elem->next;
-  };
-  return TRUE;
+  for (GSList *l = self->bindings; l; l = l->next) {
+    PhocKeybinding *keybinding = l->data;
+
+    for (GSList *c = keybinding->combos; c; c = c->next) {
+      gint64 key = phoc_key_combo_to_key (c->data);
+      gint64 *new_key;
+
+      /* First binding in the list wins like it did for the linear scan */
+      if (g_hash_table_contains (self->lookup, &key)) {
+        g_debug ("Keybinding %s shadowed by an earlier binding", keybinding->name);
+        continue;
+      }
+
+      new_key = g_new (gint64, 1);
+      *new_key = key;
+      g_hash_table_insert (self->lookup, new_key, keybinding);
+    }
+  }
 }
 
 
@@ -484,6 +490,8 @@ on_keybinding_setting_changed (PhocKeybindings *self,
     if (combo)
       keybinding->combos = g_slist_append (keybinding->combos, combo);
   }
+
+  phoc_keybindings_rebuild_lookup (self);
 }
 
 
@@ -519,6 +527,7 @@ phoc_keybindings_dispose (GObject *object)
 {
   PhocKeybindings *self = PHOC_KEYBINDINGS (object);
 
+  g_clear_pointer (&self->lookup, g_hash_table_destroy);
   g_slist_free_full (self->bindings, (GDestroyNotify)phoc_keybinding_free);
   self->bindings = NULL;
 
@@ -596,6 +605,7 @@ static void
 phoc_keybindings_init (PhocKeybindings *self)
 {
   self->bindings = NULL;
+  self->lookup = g_hash_table_new_full (g_int64_hash, g_int64_equal, g_free, NULL);
 }
 
 
@@ -605,6 +615,21 @@ phoc_keybindings_new (void)
   return g_object_new (PHOC_TYPE_KEYBINDINGS, NULL);
 }
 
+/**
+ * phoc_key_combo_to_key:
+ * @combo: A key combination
+ *
+ * Packs modifiers and keysym of @combo into a single value suitable as
+ * key for hash tables using `g_int64_hash`.
+ *
+ * Returns: The packed combo
+ */
+gint64
+phoc_key_combo_to_key (const PhocKeyCombo *combo)
+{
+  return ((gint64) combo->modifiers << 32) | combo->keysym;
+}
+
 /**
  * phoc_keybindings_handle_pressed:
  *
@@ -620,24 +645,20 @@ phoc_keybindings_handle_pressed (PhocKeybindings *self,
                                  PhocSeat *seat)
 {
   PhocKeybinding *keybinding;
-  GSList *elem;
   PhocKeyCombo combo;
+  gint64 key;
 
   if (length != 1)
     return FALSE;
 
   combo.keysym = pressed_keysyms[0];
   combo.modifiers = modifiers;
+  key = phoc_key_combo_to_key (&combo);
 
-  elem = g_slist_find_custom (self->bindings,
-                              &combo,
-                              (GCompareFunc)keybinding_by_key_combo);
-  if (!elem)
+  keybinding = g_hash_table_lookup (self->lookup, &key);
+  if (!keybinding)
     return FALSE;
 
-  g_return_val_if_fail (elem->data, FALSE);
-  keybinding = elem->data;
-
   (*keybinding->func) (seat);
   return TRUE;
 }
@@ -37,4 +37,5 @@ gboolean         phoc_keybindings_handle_pressed (PhocKeybindings *self,
                                                   guint32 length,
                                                   PhocSeat *seat);
 PhocKeyCombo *parse_accelerator (const gchar * accelerator);
+gint64        phoc_key_combo_to_key (const PhocKeyCombo *combo);
 G_END_DECLS
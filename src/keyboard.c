@@ -22,6 +22,7 @@
 #include <xkbcommon/xkbcommon.h>
 #include "keyboard.h"
 #include "phosh-private.h"
+#include "pressed-keysyms.h"
 #include "seat.h"
 
 #include <glib.h>
@@ -46,8 +47,8 @@ struct _PhocKeyboard {
   uint32_t meta_key;
   GnomeXkbInfo *xkbinfo;
 
-  xkb_keysym_t pressed_keysyms_translated[PHOC_KEYBOARD_PRESSED_KEYSYMS_CAP];
-  xkb_keysym_t pressed_keysyms_raw[PHOC_KEYBOARD_PRESSED_KEYSYMS_CAP];
+  PhocPressedKeysyms pressed_keysyms_translated;
+  PhocPressedKeysyms pressed_keysyms_raw;
 };
 G_DEFINE_TYPE(PhocKeyboard, phoc_keyboard, PHOC_TYPE_INPUT_DEVICE)
 
@@ -59,86 +60,6 @@ enum {
 static guint signals [N_SIGNALS];
 
 
-static ssize_t
-pressed_keysyms_index(const xkb_keysym_t *pressed_keysyms,
-                      xkb_keysym_t keysym)
-{
-  for (size_t i = 0; i < PHOC_KEYBOARD_PRESSED_KEYSYMS_CAP; ++i) {
-    if (pressed_keysyms[i] == keysym) {
-      return i;
-    }
-  }
-  return -1;
-}
-
-static size_t pressed_keysyms_length(const xkb_keysym_t *pressed_keysyms) {
-  size_t n = 0;
-  for (size_t i = 0; i < PHOC_KEYBOARD_PRESSED_KEYSYMS_CAP; ++i) {
-    if (pressed_keysyms[i] != XKB_KEY_NoSymbol) {
-      ++n;
-    }
-  }
-  return n;
-}
-
-static void
-pressed_keysyms_add(xkb_keysym_t *pressed_keysyms,
-                    xkb_keysym_t keysym)
-{
-  ssize_t i = pressed_keysyms_index(pressed_keysyms, keysym);
-  if (i < 0) {
-    i = pressed_keysyms_index(pressed_keysyms, XKB_KEY_NoSymbol);
-    if (i >= 0) {
-      pressed_keysyms[i] = keysym;
-    }
-  }
-}
-
-static void
-pressed_keysyms_remove(xkb_keysym_t *pressed_keysyms,
-                       xkb_keysym_t keysym)
-{
-  ssize_t i = pressed_keysyms_index(pressed_keysyms, keysym);
-  if (i >= 0) {
-    pressed_keysyms[i] = XKB_KEY_NoSymbol;
-  }
-}
-
-static bool
-keysym_is_modifier(xkb_keysym_t keysym)
-{
-  switch (keysym) {
-  case XKB_KEY_Shift_L: case XKB_KEY_Shift_R:
-  case XKB_KEY_Control_L: case XKB_KEY_Control_R:
-  case XKB_KEY_Caps_Lock:
-  case XKB_KEY_Shift_Lock:
-  case XKB_KEY_Meta_L: case XKB_KEY_Meta_R:
-  case XKB_KEY_Alt_L: case XKB_KEY_Alt_R:
-  case XKB_KEY_Super_L: case XKB_KEY_Super_R:
-  case XKB_KEY_Hyper_L: case XKB_KEY_Hyper_R:
-    return true;
-  default:
-    return false;
-  }
-}
-
-static void
-pressed_keysyms_update(xkb_keysym_t *pressed_keysyms,
-                       const xkb_keysym_t *keysyms, size_t keysyms_len,
-                       enum wl_keyboard_key_state state)
-{
-  for (size_t i = 0; i < keysyms_len; ++i) {
-    if (keysym_is_modifier(keysyms[i])) {
-      continue;
-    }
-    if (state == WL_KEYBOARD_KEY_STATE_PRESSED) {
-      pressed_keysyms_add(pressed_keysyms, keysyms[i]);
-    } else { // WL_KEYBOARD_KEY_STATE_RELEASED
-      pressed_keysyms_remove(pressed_keysyms, keysyms[i]);
-    }
-  }
-}
-
 /*
  * Execute a built-in, hardcoded compositor binding. These are triggered from a
  * single keysym.
@@ -257,7 +178,7 @@ keyboard_execute_power_key (PhocKeyboard              *self,
  */
 static bool
 keyboard_execute_binding (PhocKeyboard              *self,
-                          xkb_keysym_t              *pressed_keysyms,
+                          PhocPressedKeysyms        *pressed_keysyms,
                           uint32_t                   modifiers,
                           const xkb_keysym_t        *keysyms,
                           size_t                     keysyms_len,
@@ -277,10 +198,13 @@ keyboard_execute_binding (PhocKeyboard              *self,
     }
   }
 
-  size_t n = pressed_keysyms_length(pressed_keysyms);
   keybindings = server->config->keybindings;
 
-  if (phoc_keybindings_handle_pressed (keybindings, modifiers, pressed_keysyms, n, seat))
+  if (phoc_keybindings_handle_pressed (keybindings,
+                                       modifiers,
+                                       pressed_keysyms->keysyms,
+                                       phoc_pressed_keysyms_get_length (pressed_keysyms),
+                                       seat))
     return true;
 
   return false;
@@ -295,7 +219,7 @@ keyboard_execute_binding (PhocKeyboard              *self,
  */
 static bool
 keyboard_execute_subscribed_binding (PhocKeyboard              *self,
-                                     xkb_keysym_t              *pressed_keysyms,
+                                     PhocPressedKeysyms        *pressed_keysyms,
                                      uint32_t                   modifiers,
                                      const xkb_keysym_t        *keysyms,
                                      size_t                     keysyms_len,
@@ -397,21 +321,21 @@ phoc_keyboard_handle_key(PhocKeyboard *self, struct wlr_keyboard_key_event *even
   uint32_t modifiers;
   const xkb_keysym_t *keysyms;
   size_t keysyms_len;
+  gboolean pressed = (event->state == WL_KEYBOARD_KEY_STATE_PRESSED);
 
   // Handle translated keysyms
   keysyms_len = keyboard_keysyms_translated (self, keycode, &keysyms, &modifiers);
-  pressed_keysyms_update (self->pressed_keysyms_translated, keysyms, keysyms_len, event->state);
+  phoc_pressed_keysyms_update (&self->pressed_keysyms_translated, keysyms, keysyms_len, pressed);
   handled = keyboard_execute_binding(self,
-                                     self->pressed_keysyms_translated, modifiers, keysyms,
+                                     &self->pressed_keysyms_translated, modifiers, keysyms,
                                      keysyms_len, event->state);
 
   keysyms_len = keyboard_keysyms_raw (self, keycode, &keysyms, &modifiers);
-  pressed_keysyms_update (self->pressed_keysyms_raw, keysyms, keysyms_len,
-                          event->state);
+  phoc_pressed_keysyms_update (&self->pressed_keysyms_raw, keysyms, keysyms_len, pressed);
   // Handle raw keysyms
   if (!handled) {
     handled = keyboard_execute_binding (self,
-                                        self->pressed_keysyms_raw, modifiers, keysyms,
+                                        &self->pressed_keysyms_raw, modifiers, keysyms,
                                         keysyms_len, event->state);
   }
 
@@ -423,7 +347,7 @@ phoc_keyboard_handle_key(PhocKeyboard *self, struct wlr_keyboard_key_event *even
   // Handle subscribed keysyms
   if (!handled) {
     handled = keyboard_execute_subscribed_binding (self,
-                                                   self->pressed_keysyms_raw, modifiers,
+                                                   &self->pressed_keysyms_raw, modifiers,
                                                    keysyms, keysyms_len, event->time_msec,
                                                    event->state);
   }
@@ -474,23 +398,93 @@ phoc_keyboard_handle_modifiers(PhocKeyboard *self)
 }
 
 
+/*
+ * Compiled keymaps are shared between all keyboards. Compiling a
+ * keymap is expensive so only do it once per layout, variant and
+ * options. Entries stay around when no keyboard uses them anymore so
+ * switching back and forth between layouts or replugging a keyboard
+ * is cheap. Only the most recently used ones are kept.
+ */
+#define KEYMAP_CACHE_SIZE 8
+
+static struct xkb_context *keymap_context;
+static GHashTable *keymap_cache;
+/* Keys owned by keymap_cache, most recently used first */
+static GQueue keymap_cache_lru = G_QUEUE_INIT;
+
+
+static struct xkb_keymap *
+get_cached_keymap (const gchar *layout, const gchar *variant, const gchar *options)
+{
+  struct xkb_rule_names rules = { 0 };
+  g_autofree gchar *key = NULL;
+  struct xkb_keymap *keymap;
+  gpointer cached_key;
+
+  if (G_UNLIKELY (keymap_cache == NULL)) {
+    keymap_context = xkb_context_new (XKB_CONTEXT_NO_FLAGS);
+    if (keymap_context == NULL) {
+      g_warning ("Cannot create XKB context");
+      return NULL;
+    }
+    keymap_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                          (GDestroyNotify)xkb_keymap_unref);
+  }
+
+  key = g_strdup_printf ("%s\n%s\n%s", layout ?: "", variant ?: "", options ?: "");
+  if (g_hash_table_lookup_extended (keymap_cache, key, &cached_key, (gpointer *)&keymap)) {
+    g_debug ("Using cached keymap for '%s' '%s' '%s'", layout, variant, options);
+    g_queue_remove (&keymap_cache_lru, cached_key);
+    g_queue_push_head (&keymap_cache_lru, cached_key);
+    return xkb_keymap_ref (keymap);
+  }
+
+  rules.layout = layout;
+  rules.variant = variant;
+  rules.options = options;
+
+  keymap = xkb_keymap_new_from_names (keymap_context, &rules, XKB_KEYMAP_COMPILE_NO_FLAGS);
+  if (keymap == NULL)
+    return NULL;
+
+  /* Keyboards hold their own reference so evicting is fine */
+  if (g_queue_get_length (&keymap_cache_lru) >= KEYMAP_CACHE_SIZE)
+    g_hash_table_remove (keymap_cache, g_queue_pop_tail (&keymap_cache_lru));
+
+  g_queue_push_head (&keymap_cache_lru, key);
+  g_hash_table_insert (keymap_cache, g_steal_pointer (&key), xkb_keymap_ref (keymap));
+  return keymap;
+}
+
+/**
+ * phoc_keyboard_clear_keymap_cache:
+ *
+ * Drops all cached keymaps. Keymaps still in use by keyboards stay
+ * valid.
+ */
+void
+phoc_keyboard_clear_keymap_cache (void)
+{
+  g_queue_clear (&keymap_cache_lru);
+  g_clear_pointer (&keymap_cache, g_hash_table_destroy);
+  g_clear_pointer (&keymap_context, xkb_context_unref);
+}
+
+
 static void
 set_fallback_keymap (PhocKeyboard *self)
 {
-  struct xkb_context *context;
   PhocInputDevice *input_device = PHOC_INPUT_DEVICE (self);
   struct wlr_input_device *device = phoc_input_device_get_device (input_device);
   struct wlr_keyboard *wlr_keyboard = wlr_keyboard_from_input_device (device);
+  struct xkb_keymap *keymap;
 
-  context = xkb_context_new (XKB_CONTEXT_NO_FLAGS);
-  if (context == NULL) {
-       return;
-  }
+  keymap = get_cached_keymap (NULL, NULL, NULL);
+  if (keymap == NULL)
+    return;
 
   xkb_keymap_unref (self->keymap);
-  self->keymap = xkb_keymap_new_from_names (context, NULL,
-                                            XKB_KEYMAP_COMPILE_NO_FLAGS);
-  xkb_context_unref (context);
+  self->keymap = keymap;
 
   wlr_keyboard_set_keymap(wlr_keyboard, self->keymap);
 }
@@ -499,8 +493,6 @@ set_fallback_keymap (PhocKeyboard *self)
 static void
 set_xkb_keymap (PhocKeyboard *self, const gchar *layout, const gchar *variant, const gchar *options)
 {
-  struct xkb_rule_names rules = { 0 };
-  struct xkb_context *context = NULL;
   struct xkb_keymap *keymap = NULL;
   PhocInputDevice *input_device = PHOC_INPUT_DEVICE (self);
   struct wlr_input_device *device = phoc_input_device_get_device (input_device);
@@ -508,26 +500,16 @@ set_xkb_keymap (PhocKeyboard *self, const gchar *layout, const gchar *variant, c
 
   g_assert (wlr_keyboard);
 
-  rules.layout = layout;
-  rules.variant = variant;
-  rules.options = options;
-
-  context = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
-  if (context == NULL) {
-    g_warning ("Cannot create XKB context");
-    goto out;
-  }
-
-  keymap = xkb_map_new_from_names(context, &rules, XKB_KEYMAP_COMPILE_NO_FLAGS);
-  if (keymap == NULL) {
+  keymap = get_cached_keymap (layout, variant, options);
+  if (keymap == NULL)
     g_warning ("Cannot create XKB keymap");
-  }
-
- out:
-  if (context)
-    xkb_context_unref(context);
 
   if (keymap) {
+    /* Same keymap, nothing to do */
+    if (keymap == self->keymap) {
+      xkb_keymap_unref (keymap);
+      return;
+    }
     xkb_keymap_unref (self->keymap);
     self->keymap = keymap;
   } else if (self->keymap == NULL) {
@@ -639,6 +621,8 @@ handle_keyboard_key (struct wl_listener *listener, void *data)
 
   g_assert (PHOC_IS_KEYBOARD (self));
 
+  phoc_debug_stats_notify_input (phoc_server_get_default ()->desktop->debug_stats,
+                                 event->time_msec);
   phoc_keyboard_handle_key (self, event);
   g_signal_emit (self, signals[ACTIVITY], 0);
 }
@@ -677,8 +661,7 @@ phoc_keyboard_finalize(GObject *object)
   wl_list_remove (&self->keyboard_key.link);
   wl_list_remove (&self->keyboard_modifiers.link);
 
-  xkb_keymap_unref (self->keymap);
-  self->keymap = NULL;
+  g_clear_pointer (&self->keymap, xkb_keymap_unref);
 
   G_OBJECT_CLASS (phoc_keyboard_parent_class)->finalize (object);
 }
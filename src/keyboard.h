@@ -9,8 +9,6 @@
 
 G_BEGIN_DECLS
 
-#define PHOC_KEYBOARD_PRESSED_KEYSYMS_CAP 32
-
 #define PHOC_TYPE_KEYBOARD (phoc_keyboard_get_type())
 
 G_DECLARE_FINAL_TYPE (PhocKeyboard, phoc_keyboard, PHOC, KEYBOARD, PhocInputDevice)
@@ -19,5 +17,6 @@ PhocKeyboard *phoc_keyboard_new (struct wlr_input_device *device,
                                  PhocSeat *seat);
 void          phoc_keyboard_next_layout (PhocKeyboard *self);
 uint32_t      phoc_keyboard_get_meta_key (PhocKeyboard *self);
+void          phoc_keyboard_clear_keymap_cache (void);
 
 G_END_DECLS
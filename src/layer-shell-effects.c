@@ -13,7 +13,9 @@
 #include "phoc-animation.h"
 #include "phoc-enums.h"
 #include "server.h"
+#include "touch-resampler.h"
 #include "utils.h"
+#include "velocity-tracker.h"
 
 #include <glib-object.h>
 
@@ -21,6 +23,9 @@
 #define DRAG_ACCEPT_THRESHOLD_DISTANCE 16
 #define DRAG_REJECT_THRESHOLD_DISTANCE 24
 #define SLIDE_ANIM_DURATION_MS 400 /* ms */
+#define SLIDE_ANIM_MIN_DURATION_MS 100 /* ms */
+/* Releasing a drag faster than this flings the surface in that direction */
+#define FLING_MIN_VELOCITY 300 /* px/s */
 
 typedef enum {
   PHOC_LAYER_SHELL_EFFECT_DRAG_FROM_TOP = (ZWLR_LAYER_SURFACE_V1_ANCHOR_LEFT |
@@ -69,11 +74,18 @@ struct _PhocDraggableLayerSurface {
     /* Slide in/out animation */
     guint    anim_id;
     float    anim_t;
+    gint64   anim_start_us;
     int32_t  anim_duration;
     int32_t  anim_start;
     int32_t  anim_end;
     PhocAnimDir anim_dir;
     enum zphoc_draggable_layer_surface_v1_drag_end_state last_state;
+    /* Resampling of drag positions to the output's presentation time */
+    PhocTouchResampler resampler;
+    guint    drag_frame_id;
+    double   last_off_x, last_off_y;
+    /* Velocity at the end of the drag */
+    PhocVelocityTracker tracker;
   } drag;
   struct wlr_box geo;
 
@@ -111,7 +123,16 @@ struct _PhocLayerShellEffects {
 
   GSList             *alpha_surfaces;
   GHashTable         *alpha_surfaces_by_layer_surface;
+
+  gboolean            live_drag_updates;
+};
+
+enum {
+  PROP_0,
+  PROP_LIVE_DRAG_UPDATES,
+  PROP_LAST_PROP,
 };
+static GParamSpec *props[PROP_LAST_PROP];
 
 G_DEFINE_TYPE (PhocLayerShellEffects, phoc_layer_shell_effects, G_TYPE_OBJECT)
 
@@ -344,6 +365,10 @@ phoc_draggable_layer_surface_destroy (PhocDraggableLayerSurface *drag_surface)
     phoc_animatable_remove_frame_callback (PHOC_ANIMATABLE (drag_surface->layer_surface),
                                            drag_surface->drag.anim_id);
   }
+  if (drag_surface->drag.drag_frame_id && drag_surface->layer_surface) {
+    phoc_animatable_remove_frame_callback (PHOC_ANIMATABLE (drag_surface->layer_surface),
+                                           drag_surface->drag.drag_frame_id);
+  }
 
   if (drag_surface->layer_surface) {
     g_hash_table_remove (layer_shell_effects->drag_surfaces_by_layer_surface,
@@ -673,6 +698,44 @@ phoc_layer_shell_effects_from_resource (struct wl_resource *resource)
 }
 
 
+static void
+phoc_layer_shell_effects_set_property (GObject      *object,
+                                       guint         property_id,
+                                       const GValue *value,
+                                       GParamSpec   *pspec)
+{
+  PhocLayerShellEffects *self = PHOC_LAYER_SHELL_EFFECTS (object);
+
+  switch (property_id) {
+  case PROP_LIVE_DRAG_UPDATES:
+    self->live_drag_updates = g_value_get_boolean (value);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+phoc_layer_shell_effects_get_property (GObject    *object,
+                                       guint       property_id,
+                                       GValue     *value,
+                                       GParamSpec *pspec)
+{
+  PhocLayerShellEffects *self = PHOC_LAYER_SHELL_EFFECTS (object);
+
+  switch (property_id) {
+  case PROP_LIVE_DRAG_UPDATES:
+    g_value_set_boolean (value, self->live_drag_updates);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
 static void
 phoc_layer_shell_effects_finalize (GObject *object)
 {
@@ -692,7 +755,25 @@ phoc_layer_shell_effects_class_init (PhocLayerShellEffectsClass *klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
+  object_class->set_property = phoc_layer_shell_effects_set_property;
+  object_class->get_property = phoc_layer_shell_effects_get_property;
   object_class->finalize = phoc_layer_shell_effects_finalize;
+
+  /**
+   * PhocLayerShellEffects:live-drag-updates:
+   *
+   * If %TRUE the client is notified about every position change while
+   * a draggable layer surface is dragged or animating. If %FALSE phoc
+   * moves the surface on its own and only notifies the client about
+   * the final position so the client doesn't need to redraw every
+   * frame.
+   */
+  props[PROP_LIVE_DRAG_UPDATES] =
+    g_param_spec_boolean ("live-drag-updates", "", "",
+                          TRUE,
+                          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
 }
 
 
@@ -701,6 +782,7 @@ phoc_layer_shell_effects_init (PhocLayerShellEffects *self)
 {
   struct wl_display *display = phoc_server_get_default ()->wl_display;
 
+  self->live_drag_updates = TRUE;
   self->drag_surfaces_by_layer_surface = g_hash_table_new (g_direct_hash, g_direct_equal);
   self->alpha_surfaces_by_layer_surface = g_hash_table_new (g_direct_hash, g_direct_equal);
 
@@ -717,6 +799,22 @@ phoc_layer_shell_effects_new (void)
 }
 
 
+/*
+ * Moving a surface around usually doesn't change the usable area (the
+ * exclusive zone compensates for the margin) so only its layer needs
+ * to be arranged and only the area it moved across needs to be redrawn.
+ */
+static void
+arrange_and_damage (PhocDraggableLayerSurface *drag_surface, PhocOutput *output)
+{
+  if (phoc_layer_shell_arrange_layer (output, drag_surface->layer_surface->layer))
+    return;
+
+  phoc_layer_shell_arrange (output);
+  phoc_output_damage_whole (output);
+}
+
+
 static void
 apply_margin (PhocDraggableLayerSurface *drag_surface, double margin)
 {
@@ -761,7 +859,7 @@ apply_state (PhocDraggableLayerSurface *drag_surface, PhocDraggableSurfaceState
 
 
 static gboolean
-on_output_frame_callback (PhocAnimatable *animatable, guint64 last_frame, gpointer user_data)
+on_output_frame_callback (PhocAnimatable *animatable, guint64 frame_time, gpointer user_data)
 
 {
   PhocDraggableLayerSurface *drag_surface = user_data;
@@ -819,13 +917,21 @@ on_output_frame_callback (PhocAnimatable *animatable, guint64 last_frame, gpoint
       g_assert_not_reached ();
     }
     margin = drag_surface->drag.anim_end;
+    if (!drag_surface->layer_shell_effects->live_drag_updates)
+      zphoc_draggable_layer_surface_v1_send_dragged (drag_surface->resource, (int32_t)margin);
     zphoc_draggable_layer_surface_v1_send_drag_end (drag_surface->resource, drag_surface->drag.last_state);
     apply_state (drag_surface, PHOC_DRAGGABLE_SURFACE_STATE_NONE);
     drag_surface->drag.anim_id = 0;
   } else {
-    gint64 now = g_get_monotonic_time ();
+    if (drag_surface->drag.anim_start_us == 0)
+      drag_surface->drag.anim_start_us = frame_time;
 
-    drag_surface->drag.anim_t += ((float)(now - last_frame)) / drag_surface->drag.anim_duration;
+    if (drag_surface->drag.anim_duration > 0) {
+      drag_surface->drag.anim_t = ((float)(frame_time - drag_surface->drag.anim_start_us)) /
+        drag_surface->drag.anim_duration;
+    } else {
+      drag_surface->drag.anim_t = 1.0;
+    }
     if (drag_surface->drag.anim_t > 1.0)
       drag_surface->drag.anim_t = 1.0;
 
@@ -839,20 +945,19 @@ on_output_frame_callback (PhocAnimatable *animatable, guint64 last_frame, gpoint
     default:
       g_assert_not_reached ();
     }
-    zphoc_draggable_layer_surface_v1_send_dragged (drag_surface->resource, (int32_t)margin);
+    if (drag_surface->layer_shell_effects->live_drag_updates)
+      zphoc_draggable_layer_surface_v1_send_dragged (drag_surface->resource, (int32_t)margin);
   }
 
   apply_margin (drag_surface, margin);
-  phoc_layer_shell_arrange (output);
-  /* FIXME: way too much damage */
-  phoc_output_damage_whole (output);
+  arrange_and_damage (drag_surface, output);
 
   return done ? G_SOURCE_REMOVE : G_SOURCE_CONTINUE;
 }
 
 
-void
-phoc_draggable_layer_surface_slide (PhocDraggableLayerSurface *drag_surface, PhocAnimDir anim_dir)
+static void
+slide (PhocDraggableLayerSurface *drag_surface, PhocAnimDir anim_dir, double velocity)
 {
   struct wlr_layer_surface_v1 *wlr_layer_surface;
   double margin;
@@ -886,6 +991,7 @@ phoc_draggable_layer_surface_slide (PhocDraggableLayerSurface *drag_surface, Pho
   }
 
   drag_surface->drag.anim_t = 0;
+  drag_surface->drag.anim_start_us = 0;
   drag_surface->drag.anim_start = margin;
   drag_surface->drag.anim_dir = anim_dir;
   drag_surface->drag.anim_end = (anim_dir == ANIM_DIR_OUT) ?
@@ -894,6 +1000,16 @@ phoc_draggable_layer_surface_slide (PhocDraggableLayerSurface *drag_surface, Pho
     cbrt (ABS (drag_surface->drag.anim_end - drag_surface->drag.anim_start) /
           (float) ABS (drag_surface->current.unfolded - drag_surface->current.folded));
 
+  /* Pick up the finger's speed: ease-out-cubic starts at 3 times the
+   * animation's average speed */
+  if ((anim_dir == ANIM_DIR_OUT && velocity > 0) || (anim_dir == ANIM_DIR_IN && velocity < 0)) {
+    double duration = 3.0 * ABS (drag_surface->drag.anim_end - drag_surface->drag.anim_start) /
+      ABS (velocity) * G_USEC_PER_SEC;
+
+    duration = MAX (duration, SLIDE_ANIM_MIN_DURATION_MS * 1000);
+    drag_surface->drag.anim_duration = MIN (drag_surface->drag.anim_duration, duration);
+  }
+
   apply_state (drag_surface, PHOC_DRAGGABLE_SURFACE_STATE_ANIMATING);
 
   g_debug ("%s: start: %d, end: %d dir: %d", __func__,
@@ -912,6 +1028,13 @@ phoc_draggable_layer_surface_slide (PhocDraggableLayerSurface *drag_surface, Pho
 }
 
 
+void
+phoc_draggable_layer_surface_slide (PhocDraggableLayerSurface *drag_surface, PhocAnimDir anim_dir)
+{
+  slide (drag_surface, anim_dir, 0.0);
+}
+
+
 /**
  * phoc_draggable_layer_surface_get_layer_surface:
  * @drag_surface: The draggable layer surface
@@ -991,13 +1114,58 @@ accept_drag (PhocDraggableLayerSurface *drag_surface,
   wlr_layer_surface->pending.margin.right = wlr_layer_surface->current.margin.right;
   wlr_layer_surface->pending.exclusive_zone = wlr_layer_surface->current.exclusive_zone;
 
-  zphoc_draggable_layer_surface_v1_send_dragged (drag_surface->resource, margin);
-  phoc_layer_shell_arrange (output);
-
-  /* FIXME: way too much damage */
-  phoc_output_damage_whole (output);
+  if (drag_surface->layer_shell_effects->live_drag_updates)
+    zphoc_draggable_layer_surface_v1_send_dragged (drag_surface->resource, margin);
+  arrange_and_damage (drag_surface, output);
 
   apply_state (drag_surface, PHOC_DRAGGABLE_SURFACE_STATE_DRAGGING);
+  drag_surface->drag.last_off_x = off_x;
+  drag_surface->drag.last_off_y = off_y;
+}
+
+
+static void
+remove_drag_frame_callback (PhocDraggableLayerSurface *drag_surface)
+{
+  if (drag_surface->drag.drag_frame_id == 0)
+    return;
+
+  phoc_animatable_remove_frame_callback (PHOC_ANIMATABLE (drag_surface->layer_surface),
+                                         drag_surface->drag.drag_frame_id);
+  drag_surface->drag.drag_frame_id = 0;
+}
+
+
+static gboolean
+on_drag_frame_callback (PhocAnimatable *animatable, guint64 frame_time, gpointer user_data)
+{
+  PhocDraggableLayerSurface *drag_surface = user_data;
+  PhocOutput *output;
+  double off_x, off_y;
+
+  g_assert (drag_surface);
+  g_assert (PHOC_IS_LAYER_SURFACE (animatable));
+
+  output = phoc_layer_surface_get_output (PHOC_LAYER_SURFACE (animatable));
+  if (output == NULL || drag_surface->state != PHOC_DRAGGABLE_SURFACE_STATE_DRAGGING)
+    goto out;
+
+  /* Position the surface where the finger will be when the frame hits the screen */
+  if (!phoc_touch_resampler_get_position (&drag_surface->drag.resampler, frame_time,
+                                          &off_x, &off_y))
+    goto out;
+
+  if ((int)off_x == (int)drag_surface->drag.last_off_x &&
+      (int)off_y == (int)drag_surface->drag.last_off_y)
+    goto out;
+
+  accept_drag (drag_surface, off_x, off_y);
+  return G_SOURCE_CONTINUE;
+
+ out:
+  /* No new input, we get re-added on the next drag update */
+  drag_surface->drag.drag_frame_id = 0;
+  return G_SOURCE_REMOVE;
 }
 
 
@@ -1046,6 +1214,8 @@ phoc_draggable_layer_surface_drag_start (PhocDraggableLayerSurface *drag_surface
     }
     drag_surface->drag.start_margin = start_margin;
     drag_surface->drag.anim_id = 0;
+    phoc_touch_resampler_reset (&drag_surface->drag.resampler);
+    phoc_velocity_tracker_reset (&drag_surface->drag.tracker);
     accept_drag (drag_surface, 0, 0);
     return drag_surface->state;
   }
@@ -1063,6 +1233,8 @@ phoc_draggable_layer_surface_drag_start (PhocDraggableLayerSurface *drag_surface
 
   drag_surface->drag.pending_accept = 0;
   drag_surface->drag.pending_reject = 0;
+  phoc_touch_resampler_reset (&drag_surface->drag.resampler);
+  phoc_velocity_tracker_reset (&drag_surface->drag.tracker);
 
   apply_state (drag_surface, PHOC_DRAGGABLE_SURFACE_STATE_PENDING);
   return drag_surface->state;
@@ -1090,7 +1262,8 @@ phoc_draggable_surface_is_vertical (PhocDraggableLayerSurface *drag_surface)
 PhocDraggableSurfaceState
 phoc_draggable_layer_surface_drag_update (PhocDraggableLayerSurface *drag_surface,
                                           double                     off_x,
-                                          double                     off_y)
+                                          double                     off_y,
+                                          guint32                    time_msec)
 {
   struct wlr_layer_surface_v1 *wlr_layer_surface = drag_surface->layer_surface->layer_surface;
   struct wlr_output *wlr_output = wlr_layer_surface->output;
@@ -1107,6 +1280,8 @@ phoc_draggable_layer_surface_drag_update (PhocDraggableLayerSurface *drag_surfac
     return drag_surface->state;
   }
 
+  phoc_velocity_tracker_add_point (&drag_surface->drag.tracker, time_msec, off_x, off_y);
+
   if (phoc_draggable_surface_is_vertical (drag_surface)) {
     drag_surface->drag.pending_accept = off_y;
     drag_surface->drag.pending_reject = off_x;
@@ -1152,7 +1327,24 @@ phoc_draggable_layer_surface_drag_update (PhocDraggableLayerSurface *drag_surfac
     return drag_surface->state;
   }
 
-  accept_drag (drag_surface, off_x, off_y);
+  phoc_touch_resampler_add_sample (&drag_surface->drag.resampler,
+                                   phoc_touch_resampler_event_time_to_us (time_msec,
+                                                                          g_get_monotonic_time ()),
+                                   off_x, off_y);
+
+  /* Accept right away, further motion is applied once per output frame */
+  if (drag_surface->state == PHOC_DRAGGABLE_SURFACE_STATE_PENDING) {
+    accept_drag (drag_surface, off_x, off_y);
+    return drag_surface->state;
+  }
+
+  if (drag_surface->drag.drag_frame_id == 0) {
+    drag_surface->drag.drag_frame_id = phoc_animatable_add_frame_callback (
+      PHOC_ANIMATABLE (drag_surface->layer_surface),
+      on_drag_frame_callback,
+      drag_surface,
+      NULL);
+  }
 
   return drag_surface->state;
 }
@@ -1199,13 +1391,40 @@ hit_threshold (PhocDraggableLayerSurface *drag_surface)
 }
 
 
+/* Velocity of the surface's margin in px/s, positive when unfolding */
+static double
+get_margin_velocity (PhocDraggableLayerSurface *drag_surface)
+{
+  struct wlr_layer_surface_v1 *wlr_layer_surface = drag_surface->layer_surface->layer_surface;
+  double velocity_x, velocity_y;
+
+  if (!phoc_velocity_tracker_get_velocity (&drag_surface->drag.tracker, &velocity_x, &velocity_y))
+    return 0.0;
+
+  switch (wlr_layer_surface->current.anchor) {
+  case PHOC_LAYER_SHELL_EFFECT_DRAG_FROM_TOP:
+    return velocity_y;
+  case PHOC_LAYER_SHELL_EFFECT_DRAG_FROM_BOTTOM:
+    return -velocity_y;
+  case PHOC_LAYER_SHELL_EFFECT_DRAG_FROM_LEFT:
+    return velocity_x;
+  case PHOC_LAYER_SHELL_EFFECT_DRAG_FROM_RIGHT:
+    return -velocity_x;
+  default:
+    g_assert_not_reached ();
+  }
+}
+
+
 void
 phoc_draggable_layer_surface_drag_end (PhocDraggableLayerSurface *drag_surface,
                                        double                     off_x,
-                                       double                     off_y)
+                                       double                     off_y,
+                                       guint32                    time_msec)
 {
   PhocOutput *output;
   PhocAnimDir dir;
+  double velocity = 0.0;
   struct wlr_layer_surface_v1 *wlr_layer_surface = drag_surface->layer_surface->layer_surface;
   struct wlr_output *wlr_output = wlr_layer_surface->output;
 
@@ -1215,7 +1434,21 @@ phoc_draggable_layer_surface_drag_end (PhocDraggableLayerSurface *drag_surface,
   output = PHOC_OUTPUT (wlr_output->data);
   g_assert (PHOC_IS_OUTPUT (output));
 
-  if (hit_threshold (drag_surface)) {
+  /* Don't leave the surface at a resampled position */
+  remove_drag_frame_callback (drag_surface);
+  if (drag_surface->state == PHOC_DRAGGABLE_SURFACE_STATE_DRAGGING) {
+    accept_drag (drag_surface, off_x, off_y);
+    /* A finger held still before lifting must not fling */
+    phoc_velocity_tracker_add_point (&drag_surface->drag.tracker, time_msec, off_x, off_y);
+    velocity = get_margin_velocity (drag_surface);
+  }
+
+  g_debug ("%s: velocity: %f", __func__, velocity);
+
+  if (ABS (velocity) >= FLING_MIN_VELOCITY) {
+    /* Flung, follow the finger's direction regardless of the distance */
+    dir = velocity > 0 ? ANIM_DIR_OUT : ANIM_DIR_IN;
+  } else if (hit_threshold (drag_surface)) {
     dir = drag_surface->drag.last_state == ZPHOC_DRAGGABLE_LAYER_SURFACE_V1_DRAG_END_STATE_FOLDED ?
       ANIM_DIR_OUT : ANIM_DIR_IN;
   } else {
@@ -1227,7 +1460,7 @@ phoc_draggable_layer_surface_drag_end (PhocDraggableLayerSurface *drag_surface,
   drag_surface->drag.pending_accept = 0;
   drag_surface->drag.pending_reject = 0;
 
-  phoc_draggable_layer_surface_slide (drag_surface, dir);
+  slide (drag_surface, dir, velocity);
 
   apply_state (drag_surface, PHOC_DRAGGABLE_SURFACE_STATE_ANIMATING);
 }
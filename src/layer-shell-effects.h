@@ -64,10 +64,12 @@ PhocDraggableSurfaceState phoc_draggable_layer_surface_drag_start  (PhocDraggabl
                                                                     double                     ly);
 PhocDraggableSurfaceState phoc_draggable_layer_surface_drag_update (PhocDraggableLayerSurface *drag_surface,
                                                                     double                     lx,
-                                                                    double                     ly);
+                                                                    double                     ly,
+                                                                    guint32                    time_msec);
 void                     phoc_draggable_layer_surface_drag_end    (PhocDraggableLayerSurface  *drag_surface,
                                                                    double                      lx,
-                                                                   double                      ly);
+                                                                   double                      ly,
+                                                                   guint32                     time_msec);
 void                     phoc_draggable_layer_surface_slide       (PhocDraggableLayerSurface  *drag_surface,
                                                                    PhocAnimDir             anim_dir);
 
@@ -24,6 +24,13 @@
 
 #define LAYER_SHELL_LAYER_COUNT 4
 
+static const enum zwlr_layer_shell_v1_layer layers_top_to_bottom[] = {
+  ZWLR_LAYER_SHELL_V1_LAYER_OVERLAY,
+  ZWLR_LAYER_SHELL_V1_LAYER_TOP,
+  ZWLR_LAYER_SHELL_V1_LAYER_BOTTOM,
+  ZWLR_LAYER_SHELL_V1_LAYER_BACKGROUND
+};
+
 static void apply_exclusive(struct wlr_box *usable_area,
 		uint32_t anchor, int32_t exclusive,
 		int32_t margin_top, int32_t margin_right,
@@ -113,12 +120,17 @@ static void update_cursors(PhocLayerSurface *layer_surface, GSList *seats /* Pho
 	}
 }
 
+/*
+ * When apply is false only the usable area is updated, the layer
+ * surfaces are left untouched.
+ */
 static void
 arrange_layer (PhocOutput                     *output,
                GSList                         *seats, /* PhocSeat */
                enum zwlr_layer_shell_v1_layer  layer,
                struct wlr_box                 *usable_area,
-               bool                            exclusive)
+               bool                            exclusive,
+               bool                            apply)
 {
   PhocLayerSurface *layer_surface;
   struct wlr_box full_area = { 0 };
@@ -196,6 +208,15 @@ arrange_layer (PhocOutput                     *output,
       continue;
     }
 
+    if (!apply) {
+      if (wlr_layer_surface->mapped) {
+        apply_exclusive (usable_area, state->anchor, state->exclusive_zone,
+                         state->margin.top, state->margin.right,
+                         state->margin.bottom, state->margin.left);
+      }
+      continue;
+    }
+
     // Apply
     struct wlr_box old_geo = layer_surface->geo;
     layer_surface->geo = box;
@@ -249,12 +270,6 @@ phoc_layer_shell_arrange (PhocOutput *output)
   struct wlr_box usable_area = { 0 };
   PhocServer *server = phoc_server_get_default ();
   GSList *seats = phoc_input_get_seats (server->input);
-  enum zwlr_layer_shell_v1_layer layers[] = {
-    ZWLR_LAYER_SHELL_V1_LAYER_OVERLAY,
-    ZWLR_LAYER_SHELL_V1_LAYER_TOP,
-    ZWLR_LAYER_SHELL_V1_LAYER_BOTTOM,
-    ZWLR_LAYER_SHELL_V1_LAYER_BACKGROUND
-  };
 
   wlr_output_effective_resolution (output->wlr_output, &usable_area.width, &usable_area.height);
 
@@ -276,11 +291,13 @@ phoc_layer_shell_arrange (PhocOutput *output)
   }
 
   // Arrange exclusive surfaces from top->bottom
-  for (size_t i = 0; i < G_N_ELEMENTS(layers); ++i)
-    arrange_layer (output, seats, layers[i], &usable_area, true);
+  for (size_t i = 0; i < G_N_ELEMENTS (layers_top_to_bottom); ++i)
+    arrange_layer (output, seats, layers_top_to_bottom[i], &usable_area, true, true);
   output->usable_area = usable_area;
 
+  /* Resize all views in one go rather than showing them one by one */
   PhocView *view;
+  phoc_desktop_begin_transaction (output->desktop);
   wl_list_for_each (view, &output->desktop->views, link) {
     if (view_is_maximized (view)) {
       view_arrange_maximized (view, NULL);
@@ -290,10 +307,11 @@ phoc_layer_shell_arrange (PhocOutput *output)
       view_center (view, NULL);
     }
   }
+  phoc_desktop_commit_transaction (output->desktop);
 
   // Arrange non-exlusive surfaces from top->bottom
-  for (size_t i = 0; i < G_N_ELEMENTS(layers); ++i)
-    arrange_layer (output, seats, layers[i], &usable_area, false);
+  for (size_t i = 0; i < G_N_ELEMENTS (layers_top_to_bottom); ++i)
+    arrange_layer (output, seats, layers_top_to_bottom[i], &usable_area, false, true);
 
   phoc_output_update_shell_reveal (output);
 
@@ -314,6 +332,67 @@ phoc_layer_shell_arrange (PhocOutput *output)
   }
 }
 
+/**
+ * phoc_layer_shell_arrange_layer:
+ * @output: The output
+ * @layer: The layer to arrange
+ *
+ * Arranges only the surfaces in the given @layer and damages the ones
+ * that moved. This is much cheaper than [func@layer_shell_arrange] as
+ * views and other layers are left alone. Use it when a layer surface
+ * moves without changing its exclusive zone, e.g. when it is being
+ * dragged.
+ *
+ * Returns: `true` if the output's usable area is unchanged. Otherwise
+ *   a full [func@layer_shell_arrange] and damage is needed.
+ */
+bool
+phoc_layer_shell_arrange_layer (PhocOutput *output, enum zwlr_layer_shell_v1_layer layer)
+{
+  struct wlr_box usable_area = { 0 };
+  PhocServer *server = phoc_server_get_default ();
+  GSList *seats = phoc_input_get_seats (server->input);
+  PhocLayerSurface *layer_surface;
+  g_autoptr (GArray) old_geos = g_array_new (FALSE, FALSE, sizeof (struct wlr_box));
+  guint i = 0;
+
+  wl_list_for_each (layer_surface, &output->layer_surfaces, link) {
+    if (layer_surface->layer == layer)
+      g_array_append_val (old_geos, layer_surface->geo);
+  }
+
+  wlr_output_effective_resolution (output->wlr_output, &usable_area.width, &usable_area.height);
+  for (size_t j = 0; j < G_N_ELEMENTS (layers_top_to_bottom); ++j) {
+    bool apply = layers_top_to_bottom[j] == layer;
+
+    arrange_layer (output, seats, layers_top_to_bottom[j], &usable_area, true, apply);
+  }
+
+  if (memcmp (&usable_area, &output->usable_area, sizeof (struct wlr_box)) != 0)
+    return false;
+
+  arrange_layer (output, seats, layer, &usable_area, false, true);
+  phoc_output_update_shell_reveal (output);
+
+  wl_list_for_each (layer_surface, &output->layer_surfaces, link) {
+    struct wlr_box *old_geo;
+
+    if (layer_surface->layer != layer)
+      continue;
+
+    old_geo = &g_array_index (old_geos, struct wlr_box, i++);
+    if (memcmp (old_geo, &layer_surface->geo, sizeof (struct wlr_box)) == 0)
+      continue;
+
+    phoc_output_damage_whole_local_surface (output, layer_surface->layer_surface->surface,
+                                            old_geo->x, old_geo->y);
+    phoc_output_damage_whole_local_surface (output, layer_surface->layer_surface->surface,
+                                            layer_surface->geo.x, layer_surface->geo.y);
+  }
+
+  return true;
+}
+
 void
 phoc_layer_shell_update_focus (void)
 {
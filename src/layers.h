@@ -52,6 +52,7 @@ typedef struct phoc_layer_subsurface {
 } PhocLayerSubsurface;
 
 void phoc_layer_shell_arrange (PhocOutput *output);
+bool phoc_layer_shell_arrange_layer (PhocOutput *output, enum zwlr_layer_shell_v1_layer layer);
 void phoc_layer_shell_update_focus (void);
 PhocLayerSurface *phoc_layer_shell_find_osk (PhocOutput *output);
 
@@ -17,6 +17,7 @@
 #include <wlr/config.h>
 #include <wlr/render/wlr_renderer.h>
 #include <wlr/util/log.h>
+#include "alloc-counter.h"
 #include "settings.h"
 #include "server.h"
 
@@ -87,6 +88,18 @@ static GDebugKey debug_keys[] =
  { .key = "disable-animations",
    .value = PHOC_SERVER_DEBUG_FLAG_DISABLE_ANIMATIONS,
  },
+ { .key = "alloc-stats",
+   .value = PHOC_SERVER_DEBUG_FLAG_ALLOC_STATS,
+ },
+ { .key = "startup",
+   .value = PHOC_SERVER_DEBUG_FLAG_STARTUP,
+ },
+ { .key = "frame-stats",
+   .value = PHOC_SERVER_DEBUG_FLAG_FRAME_STATS,
+ },
+ { .key = "perf-hud",
+   .value = PHOC_SERVER_DEBUG_FLAG_PERF_HUD,
+ },
 };
 
 
@@ -154,6 +167,8 @@ main(int argc, char **argv)
   bindtextdomain (GETTEXT_PACKAGE, LOCALEDIR);
 
   debug_flags = parse_debug_env ();
+  if ((debug_flags & PHOC_SERVER_DEBUG_FLAG_ALLOC_STATS) && !phoc_alloc_counter_is_enabled ())
+    g_warning ("Allocation statistics need a build with -Dalloc-counter=true");
   wlr_log_init(WLR_DEBUG, log_glib);
   server = phoc_server_get_default ();
   if (server == NULL) {
@@ -274,6 +274,8 @@ phoc_output_shield_class_init (PhocOutputShieldClass *klass)
                          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
 
   g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
+  phoc_property_easer_install_float_setter (props[PROP_ALPHA],
+                                            (PhocPropertyEaserFloatSetter)set_alpha);
 }
 
 
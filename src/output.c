@@ -15,18 +15,23 @@
 #include <wlr/types/wlr_xdg_shell.h>
 #include <wlr/util/region.h>
 
+#include "alloc-counter.h"
 #include "anim/animatable.h"
 #include "cutouts-overlay.h"
+#include "debug-stats.h"
 #include "settings.h"
 #include "layers.h"
 #include "layer-shell-effects.h"
 #include "output.h"
 #include "output-shield.h"
+#include "perf-hud.h"
 #include "render.h"
 #include "render-private.h"
 #include "seat.h"
 #include "server.h"
+#include "timeline.h"
 #include "utils.h"
+#include "view-snapshot.h"
 #include "xwayland-surface.h"
 
 enum {
@@ -46,16 +51,43 @@ static guint signals[N_SIGNALS] = { 0 };
 typedef struct _PhocOutputPrivate {
   PhocOutputShield *shield;
 
-  GSList *frame_callbacks;
-  gint    frame_callback_next_id;
-  gint64  last_frame_us;
+  PhocTimeline *timeline;
+  gint64        last_frame_us;
+
+  GPtrArray    *view_snapshots;
+
+  /* Last presentation time and refresh period as reported by the backend */
+  gint64  last_present_us;
+  gint64  refresh_us;
 
   PhocCutoutsOverlay *cutouts;
   gulong              render_cutouts_id;
   struct wlr_texture *cutouts_texture;
 
+  PhocPerfHud        *perf_hud;
+  gulong              render_perf_hud_id;
+
+  /* Whether a transaction holds the output's last frame */
+  gboolean            held;
+  /* Frame callbacks while a transaction holds the output */
+  guint               held_frame_done_id;
+
   gboolean shell_revealed;
   gboolean force_shell_reveal;
+
+  /* Allocations per frame, see PHOC_DEBUG=alloc-stats */
+  struct {
+    guint64 n_frames;
+    guint64 total;
+    guint64 max;
+    gint64  since_us;
+  } alloc_stats;
+
+  /* Reused across frames so it keeps its rectangle storage */
+  pixman_region32_t scratch_region;
+
+  PhocOutputFrameStats frame_stats;
+  PhocOutputFrameInfo  frame_info;
 } PhocOutputPrivate;
 
 static void phoc_output_initable_iface_init (GInitableIface *iface);
@@ -68,14 +100,6 @@ G_DEFINE_TYPE_WITH_CODE (PhocOutput, phoc_output, G_TYPE_OBJECT,
                          G_IMPLEMENT_INTERFACE (PHOC_TYPE_ANIMATABLE,
                                                 phoc_output_animatable_interface_init))
 
-typedef struct {
-  PhocAnimatable    *animatable;
-  PhocFrameCallback  callback;
-  gpointer           user_data;
-  GDestroyNotify     notify;
-  guint              id;
-} PhocOutputFrameCallbackInfo;
-
 
 typedef struct {
   PhocSurfaceIterator  user_iterator;
@@ -88,14 +112,6 @@ typedef struct {
 } PhocOutputSurfaceIteratorData;
 
 
-static void
-phoc_output_frame_callback_info_free (PhocOutputFrameCallbackInfo *cb_info)
-{
-  if (cb_info->notify && cb_info->user_data)
-    cb_info->notify (cb_info->user_data);
-  g_free (cb_info);
-}
-
 /**
  * get_surface_box:
  *
@@ -232,9 +248,10 @@ phoc_output_init (PhocOutput *self)
 {
   PhocOutputPrivate *priv = phoc_output_get_instance_private(self);
 
-  priv->frame_callback_next_id = 1;
-  priv->last_frame_us = g_get_monotonic_time ();
+  priv->timeline = phoc_timeline_new ();
+  priv->view_snapshots = g_ptr_array_new_with_free_func (g_object_unref);
   priv->shield = phoc_output_shield_new (self);
+  pixman_region32_init (&priv->scratch_region);
 
   self->debug_touch_points = NULL;
   wl_list_init (&self->layer_surfaces);
@@ -322,6 +339,103 @@ render_cutouts (PhocRenderer *renderer, PhocOutput *self)
 }
 
 
+static void
+render_perf_hud (PhocRenderer *renderer, PhocOutput *output, PhocOutput *self)
+{
+  PhocOutputPrivate *priv = phoc_output_get_instance_private (self);
+
+  g_assert (PHOC_IS_OUTPUT (self));
+
+  if (output != self)
+    return;
+
+  phoc_perf_hud_render (priv->perf_hud, self);
+}
+
+
+#define ALLOC_STATS_INTERVAL_US G_USEC_PER_SEC
+
+static void
+update_alloc_stats (PhocOutput *self, guint64 n_allocs)
+{
+  PhocOutputPrivate *priv = phoc_output_get_instance_private (self);
+  gint64 now = g_get_monotonic_time ();
+
+  priv->alloc_stats.n_frames++;
+  priv->alloc_stats.total += n_allocs;
+  priv->alloc_stats.max = MAX (priv->alloc_stats.max, n_allocs);
+
+  if (priv->alloc_stats.since_us == 0)
+    priv->alloc_stats.since_us = now;
+
+  if (now - priv->alloc_stats.since_us < ALLOC_STATS_INTERVAL_US)
+    return;
+
+  g_message ("%s: %.1f allocations per frame (max %" G_GUINT64_FORMAT ") over %" G_GUINT64_FORMAT " frames",
+             self->wlr_output->name,
+             (double)priv->alloc_stats.total / priv->alloc_stats.n_frames,
+             priv->alloc_stats.max,
+             priv->alloc_stats.n_frames);
+
+  priv->alloc_stats.n_frames = 0;
+  priv->alloc_stats.total = 0;
+  priv->alloc_stats.max = 0;
+  priv->alloc_stats.since_us = now;
+}
+
+
+static void
+send_frame_done_iterator (PhocOutput         *self,
+                          struct wlr_surface *surface,
+                          struct wlr_box     *box,
+                          float               rotation,
+                          float               scale,
+                          void               *data)
+{
+  struct timespec *when = data;
+
+  wlr_surface_send_frame_done (surface, when);
+}
+
+
+static void
+tick_timeline (PhocOutput *self)
+{
+  PhocOutputPrivate *priv = phoc_output_get_instance_private (self);
+  gint64 frame_time;
+
+  if (!phoc_timeline_get_n_callbacks (priv->timeline))
+    return;
+
+  /* Animate towards the time the frame will be visible. Keep the
+   * frame time monotonic in case the prediction jumps backwards. */
+  frame_time = phoc_output_get_next_presentation_time (self);
+  frame_time = MAX (frame_time, priv->last_frame_us + 1);
+  priv->last_frame_us = frame_time;
+  phoc_timeline_tick (priv->timeline, frame_time);
+}
+
+
+static gboolean
+on_held_frame_done (gpointer data)
+{
+  PhocOutput *self = PHOC_OUTPUT (data);
+  PhocOutputPrivate *priv = phoc_output_get_instance_private (self);
+  struct timespec now;
+
+  priv->held_frame_done_id = 0;
+  clock_gettime (CLOCK_MONOTONIC, &now);
+  phoc_output_for_each_surface (self, send_frame_done_iterator, &now, true);
+
+  /* Animations continue so they're at the right spot once rendering resumes */
+  tick_timeline (self);
+  if (phoc_timeline_get_n_callbacks (priv->timeline))
+    wlr_output_schedule_frame (self->wlr_output);
+
+  return G_SOURCE_REMOVE;
+}
+
+
 static void
 phoc_output_damage_handle_frame (struct wl_listener *listener,
                                  void               *data)
@@ -330,21 +444,29 @@ phoc_output_damage_handle_frame (struct wl_listener *listener,
   PhocOutputPrivate *priv = phoc_output_get_instance_private (self);
   PhocServer *server = phoc_server_get_default ();
   PhocRenderer *renderer = phoc_server_get_renderer (server);
-
-  GSList *l = priv->frame_callbacks;
-  while (l != NULL) {
-    GSList *next = l->next;
-    PhocOutputFrameCallbackInfo *cb_info = l->data;
-    gboolean ret;
-
-    ret = cb_info->callback(cb_info->animatable, priv->last_frame_us, cb_info->user_data);
-    if (ret == G_SOURCE_REMOVE) {
-      phoc_output_frame_callback_info_free (cb_info);
-      priv->frame_callbacks = g_slist_delete_link (priv->frame_callbacks, l);
+  gboolean alloc_stats = server->debug_flags & PHOC_SERVER_DEBUG_FLAG_ALLOC_STATS;
+  PhocDebugStats *debug_stats = self->desktop->debug_stats;
+  gboolean count_allocs = alloc_stats || phoc_debug_stats_is_active (debug_stats);
+  guint64 n_allocs = 0;
+
+  if (priv->held) {
+    /* Keep showing the last frame until all views resized, the
+     * desktop schedules a new frame once the transaction is done.
+     * Clients and animations still get frame callbacks but not faster
+     * than the refresh rate. */
+    if (priv->held_frame_done_id == 0) {
+      gint64 delay_us = phoc_output_get_next_presentation_time (self) - g_get_monotonic_time ();
+
+      priv->held_frame_done_id = g_timeout_add (MAX (1, delay_us / 1000),
+                                                on_held_frame_done, self);
     }
-    l = next;
+    return;
   }
-  priv->last_frame_us = g_get_monotonic_time ();
+
+  if (G_UNLIKELY (count_allocs))
+    n_allocs = phoc_alloc_counter_get_n_allocs ();
+
+  tick_timeline (self);
 
   if (G_UNLIKELY (priv->cutouts_texture)) {
     struct wlr_box box = { 0, 0, priv->cutouts_texture->width, priv->cutouts_texture->height };
@@ -352,10 +474,23 @@ phoc_output_damage_handle_frame (struct wl_listener *listener,
   }
 
   phoc_renderer_render_output (renderer, self);
+  phoc_server_notify_first_frame (server);
 
   /* Want frame clock ticking as long as we have frame callbacks */
-  if (priv->frame_callbacks)
+  if (phoc_timeline_get_n_callbacks (priv->timeline))
     wlr_output_schedule_frame(self->wlr_output);
+
+  if (G_UNLIKELY (count_allocs))
+    n_allocs = phoc_alloc_counter_get_n_allocs () - n_allocs;
+
+  if (G_UNLIKELY (alloc_stats))
+    update_alloc_stats (self, n_allocs);
+
+  if (G_UNLIKELY (priv->perf_hud))
+    phoc_perf_hud_add_frame (priv->perf_hud, self);
+
+  if (priv->frame_info.committed)
+    phoc_debug_stats_notify_frame (debug_stats, self, n_allocs);
 }
 
 
@@ -374,6 +509,30 @@ phoc_output_damage_handle_destroy (struct wl_listener *listener,
   wl_list_remove (&self->damage_destroy.link);
 }
 
+static void
+phoc_output_handle_present (struct wl_listener *listener, void *data)
+{
+  PhocOutput *self = wl_container_of (listener, self, present);
+  PhocOutputPrivate *priv = phoc_output_get_instance_private (self);
+  struct wlr_output_event_present *event = data;
+
+  if (event->presented)
+    priv->frame_stats.n_presented++;
+  else
+    priv->frame_stats.n_discarded++;
+
+  if (!event->presented || event->when == NULL)
+    return;
+
+  priv->last_present_us = event->when->tv_sec * G_USEC_PER_SEC + event->when->tv_nsec / 1000;
+  if (event->refresh > 0)
+    priv->refresh_us = event->refresh / 1000;
+
+  if (G_UNLIKELY (priv->perf_hud))
+    phoc_perf_hud_notify_present (priv->perf_hud, priv->last_present_us);
+}
+
+
 static void
 phoc_output_handle_mode (struct wl_listener *listener, void *data)
 {
@@ -516,6 +675,8 @@ phoc_output_initable_init (GInitable    *initable,
   wl_signal_add (&self->wlr_output->events.mode, &self->mode);
   self->commit.notify = phoc_output_handle_commit;
   wl_signal_add (&self->wlr_output->events.commit, &self->commit);
+  self->present.notify = phoc_output_handle_present;
+  wl_signal_add (&self->wlr_output->events.present, &self->present);
 
   self->damage_frame.notify = phoc_output_damage_handle_frame;
   wl_signal_add (&self->damage->events.frame, &self->damage_frame);
@@ -611,6 +772,15 @@ phoc_output_initable_init (GInitable    *initable,
     }
   }
 
+  if (server->debug_flags & PHOC_SERVER_DEBUG_FLAG_PERF_HUD) {
+    PhocOutputPrivate *priv = phoc_output_get_instance_private (self);
+
+    priv->perf_hud = phoc_perf_hud_new ();
+    priv->render_perf_hud_id = g_signal_connect (renderer, "render-end",
+                                                 G_CALLBACK (render_perf_hud),
+                                                 self);
+  }
+
   return TRUE;
 }
 
@@ -624,17 +794,23 @@ phoc_output_finalize (GObject *object)
   wl_list_remove (&self->enable.link);
   wl_list_remove (&self->mode.link);
   wl_list_remove (&self->commit.link);
+  wl_list_remove (&self->present.link);
   wl_list_remove (&self->output_destroy.link);
   g_clear_list (&self->debug_touch_points, g_free);
   /* Remove all frame callbacks, this will also free associated user data */
-  g_clear_slist (&priv->frame_callbacks,
-                 (GDestroyNotify)phoc_output_frame_callback_info_free);
+  g_clear_pointer (&priv->timeline, phoc_timeline_free);
+  g_clear_handle_id (&priv->held_frame_done_id, g_source_remove);
+  g_clear_pointer (&priv->view_snapshots, g_ptr_array_unref);
+  pixman_region32_fini (&priv->scratch_region);
 
   wl_list_init (&self->layer_surfaces);
 
   g_clear_object (&priv->cutouts);
   g_clear_pointer (&priv->cutouts_texture, wlr_texture_destroy);
   g_clear_signal_handler (&priv->render_cutouts_id, self);
+  g_clear_signal_handler (&priv->render_perf_hud_id,
+                          phoc_server_get_renderer (phoc_server_get_default ()));
+  g_clear_object (&priv->perf_hud);
   g_clear_object (&priv->shield);
   g_clear_object (&self->desktop);
 
@@ -1120,22 +1296,20 @@ damage_surface_iterator (PhocOutput *self, struct wlr_surface *surface, struct
   int center_x = box.x + box.width/2;
   int center_y = box.y + box.height/2;
 
-  pixman_region32_t damage;
-  pixman_region32_init (&damage);
-  wlr_surface_get_effective_damage (surface, &damage);
-  wlr_region_scale (&damage, &damage, scale);
-  wlr_region_scale (&damage, &damage, self->wlr_output->scale);
+  pixman_region32_t *damage = phoc_output_get_scratch_region (self);
+  wlr_surface_get_effective_damage (surface, damage);
+  wlr_region_scale (damage, damage, scale);
+  wlr_region_scale (damage, damage, self->wlr_output->scale);
   if (ceil (self->wlr_output->scale) > surface->current.scale) {
     // When scaling up a surface, it'll become blurry so we need to
     // expand the damage region
-    wlr_region_expand (&damage, &damage,
+    wlr_region_expand (damage, damage,
                        ceil (self->wlr_output->scale) - surface->current.scale);
   }
-  pixman_region32_translate (&damage, box.x, box.y);
-  wlr_region_rotated_bounds (&damage, &damage, rotation,
+  pixman_region32_translate (damage, box.x, box.y);
+  wlr_region_rotated_bounds (damage, damage, rotation,
                              center_x, center_y);
-  wlr_output_damage_add (self->damage, &damage);
-  pixman_region32_fini (&damage);
+  wlr_output_damage_add (self->damage, damage);
 
   if (*whole) {
     phoc_utils_rotated_bounds (&box, &box, rotation);
@@ -1405,28 +1579,17 @@ phoc_output_add_frame_callback  (PhocOutput        *self,
                                  GDestroyNotify     notify)
 {
   PhocOutputPrivate *priv;
-  PhocOutputFrameCallbackInfo *cb_info = g_new0 (PhocOutputFrameCallbackInfo, 1);
 
   g_assert (PHOC_IS_OUTPUT (self));
   priv = phoc_output_get_instance_private (self);
 
-  *cb_info = (PhocOutputFrameCallbackInfo) {
-    .animatable = animatable,
-    .callback = callback,
-    .user_data = user_data,
-    .notify = notify,
-    .id = priv->frame_callback_next_id,
-  };
-
-  if (priv->frame_callbacks == NULL) {
-    priv->last_frame_us = g_get_monotonic_time ();
+  if (phoc_timeline_get_n_callbacks (priv->timeline) == 0) {
     /* No other frame callbacks so need to schedule a frame to keep
      * frame clock ticking */
     wlr_output_schedule_frame (self->wlr_output);
   }
 
-  priv->frame_callbacks = g_slist_prepend (priv->frame_callbacks, cb_info);
-  return priv->frame_callback_next_id++;
+  return phoc_timeline_add (priv->timeline, animatable, callback, user_data, notify);
 }
 
 
@@ -1438,25 +1601,8 @@ phoc_output_remove_frame_callback  (PhocOutput *self, guint id)
   g_assert (PHOC_IS_OUTPUT (self));
   priv = phoc_output_get_instance_private (self);
 
-  for (GSList *elem = priv->frame_callbacks; elem; elem = elem->next) {
-    PhocOutputFrameCallbackInfo *cb_info = elem->data;
-
-    if (cb_info->id == id) {
-      phoc_output_frame_callback_info_free (cb_info);
-      priv->frame_callbacks = g_slist_delete_link (priv->frame_callbacks, elem);
-      return;
-    }
-  }
-  g_return_if_reached();
-}
-
-
-static gint
-find_cb_by_animatable (PhocOutputFrameCallbackInfo *info,  PhocAnimatable *animatable)
-{
-  g_assert (PHOC_IS_ANIMATABLE (animatable));
-
-  return !(info->animatable == animatable);
+  if (!phoc_timeline_remove (priv->timeline, id))
+    g_return_if_reached ();
 }
 
 /**
@@ -1470,18 +1616,12 @@ void
 phoc_output_remove_frame_callbacks_by_animatable (PhocOutput *self, PhocAnimatable *animatable)
 {
   PhocOutputPrivate *priv;
-  GSList *found;
 
   g_assert (PHOC_IS_OUTPUT (self));
+  g_assert (PHOC_IS_ANIMATABLE (animatable));
   priv = phoc_output_get_instance_private (self);
 
-  do {
-    found = g_slist_find_custom (priv->frame_callbacks, animatable,
-                                 (GCompareFunc)find_cb_by_animatable);
-    if (found)
-      priv->frame_callbacks = g_slist_delete_link (priv->frame_callbacks, found);
-
-  } while (found);
+  phoc_timeline_remove_by_animatable (priv->timeline, animatable);
 }
 
 /**
@@ -1498,7 +1638,98 @@ phoc_output_has_frame_callbacks (PhocOutput *self)
   g_assert (PHOC_IS_OUTPUT (self));
   priv = phoc_output_get_instance_private (self);
 
-  return !!priv->frame_callbacks;
+  return phoc_timeline_get_n_callbacks (priv->timeline) > 0;
+}
+
+/**
+ * phoc_output_add_view_snapshot:
+ * @self: The output
+ * @snapshot: The snapshot to show
+ *
+ * Shows a view snapshot on this output until it's removed again via
+ * [method@Output.remove_view_snapshot]. Snapshots are rendered on top
+ * of the views.
+ */
+void
+phoc_output_add_view_snapshot (PhocOutput *self, PhocViewSnapshot *snapshot)
+{
+  PhocOutputPrivate *priv;
+  struct wlr_box box;
+
+  g_assert (PHOC_IS_OUTPUT (self));
+  g_assert (PHOC_IS_VIEW_SNAPSHOT (snapshot));
+  priv = phoc_output_get_instance_private (self);
+
+  g_ptr_array_add (priv->view_snapshots, g_object_ref (snapshot));
+
+  if (phoc_view_snapshot_get_output_box (snapshot, &box))
+    wlr_output_damage_add_box (self->damage, &box);
+}
+
+
+void
+phoc_output_remove_view_snapshot (PhocOutput *self, PhocViewSnapshot *snapshot)
+{
+  PhocOutputPrivate *priv;
+  struct wlr_box box;
+
+  g_assert (PHOC_IS_OUTPUT (self));
+  g_assert (PHOC_IS_VIEW_SNAPSHOT (snapshot));
+  priv = phoc_output_get_instance_private (self);
+
+  if (phoc_view_snapshot_get_output_box (snapshot, &box))
+    wlr_output_damage_add_box (self->damage, &box);
+
+  g_ptr_array_remove (priv->view_snapshots, snapshot);
+}
+
+/**
+ * phoc_output_get_view_snapshots:
+ * @self: The output
+ *
+ * Returns: (transfer none) (element-type PhocViewSnapshot): The view
+ *   snapshots currently shown on this output, bottom most first.
+ */
+GPtrArray *
+phoc_output_get_view_snapshots (PhocOutput *self)
+{
+  PhocOutputPrivate *priv;
+
+  g_assert (PHOC_IS_OUTPUT (self));
+  priv = phoc_output_get_instance_private (self);
+
+  return priv->view_snapshots;
+}
+
+/**
+ * phoc_output_get_next_presentation_time:
+ * @self: The output
+ *
+ * Predicts when the next frame will be presented on this output based
+ * on the last presentation time and the output's refresh rate.
+ *
+ * Returns: The predicted presentation time in microseconds (`CLOCK_MONOTONIC`)
+ */
+gint64
+phoc_output_get_next_presentation_time (PhocOutput *self)
+{
+  PhocOutputPrivate *priv;
+  gint64 now = g_get_monotonic_time ();
+  gint64 period;
+
+  g_assert (PHOC_IS_OUTPUT (self));
+  priv = phoc_output_get_instance_private (self);
+
+  period = priv->refresh_us;
+  if (period <= 0 && self->wlr_output->refresh > 0)
+    period = (gint64)1000 * 1000 * 1000 / self->wlr_output->refresh;
+  if (period <= 0)
+    period = G_USEC_PER_SEC / 60;
+
+  if (priv->last_present_us == 0 || priv->last_present_us > now)
+    return now + period;
+
+  return priv->last_present_us + ((now - priv->last_present_us) / period + 1) * period;
 }
 
 /**
@@ -1647,6 +1878,27 @@ phoc_output_force_shell_reveal (PhocOutput *self, gboolean force)
   phoc_output_update_shell_reveal (self);
 }
 
+/**
+ * phoc_output_set_held:
+ * @self: The #PhocOutput
+ * @held: Whether to hold the output's last frame
+ *
+ * Makes the output keep showing its last frame, e.g. while views on it
+ * wait for clients to resize. Animations and frame callbacks keep
+ * running.
+ */
+void
+phoc_output_set_held (PhocOutput *self, gboolean held)
+{
+  PhocOutputPrivate *priv;
+  g_assert (PHOC_IS_OUTPUT (self));
+  priv = phoc_output_get_instance_private (self);
+
+  priv->held = held;
+  if (!held)
+    g_clear_handle_id (&priv->held_frame_done_id, g_source_remove);
+}
+
 /**
  * phoc_output_has_shell_revealed:
  * @self: The #PhocOutput
@@ -1683,3 +1935,122 @@ phoc_output_get_name (PhocOutput *self)
 
   return self->wlr_output->name;
 }
+
+/**
+ * phoc_output_get_scratch_region:
+ * @self: The output
+ *
+ * Gets a region for temporary use in the render and damage paths. The
+ * region isn't reset between uses so its storage survives across
+ * frames. Callers must hence overwrite its content (e.g. by using it
+ * as the destination of an intersection) and must not hold on to it
+ * across calls that might use it as well.
+ *
+ * Returns: (transfer none): The scratch region
+ */
+pixman_region32_t *
+phoc_output_get_scratch_region (PhocOutput *self)
+{
+  PhocOutputPrivate *priv;
+
+  g_assert (PHOC_IS_OUTPUT (self));
+  priv = phoc_output_get_instance_private (self);
+
+  return &priv->scratch_region;
+}
+
+/**
+ * phoc_output_notify_frame_committed:
+ * @self: The output
+ * @scanned_out: Whether a fullscreen view was scanned out directly
+ *
+ * Updates the output's frame statistics after a frame got committed.
+ */
+void
+phoc_output_notify_frame_committed (PhocOutput *self, gboolean scanned_out)
+{
+  PhocOutputPrivate *priv;
+
+  g_assert (PHOC_IS_OUTPUT (self));
+  priv = phoc_output_get_instance_private (self);
+
+  priv->frame_stats.n_rendered++;
+  if (scanned_out)
+    priv->frame_stats.n_scanout++;
+
+  priv->frame_info.committed = TRUE;
+  priv->frame_info.scanout = scanned_out;
+}
+
+/**
+ * phoc_output_get_frame_stats:
+ * @self: The output
+ *
+ * Gets the output's frame statistics.
+ *
+ * Returns: (transfer none): The frame statistics
+ */
+const PhocOutputFrameStats *
+phoc_output_get_frame_stats (PhocOutput *self)
+{
+  PhocOutputPrivate *priv;
+
+  g_assert (PHOC_IS_OUTPUT (self));
+  priv = phoc_output_get_instance_private (self);
+
+  return &priv->frame_stats;
+}
+
+/**
+ * phoc_output_get_frame_info:
+ * @self: The output
+ *
+ * Gets the information about the last frame. The renderer resets and
+ * fills it while rendering the output.
+ *
+ * Returns: (transfer none): The frame information
+ */
+PhocOutputFrameInfo *
+phoc_output_get_frame_info (PhocOutput *self)
+{
+  PhocOutputPrivate *priv;
+
+  g_assert (PHOC_IS_OUTPUT (self));
+  priv = phoc_output_get_instance_private (self);
+
+  return &priv->frame_info;
+}
+
+/**
+ * phoc_output_add_overlay_damage:
+ * @self: The output
+ * @buffer_damage: The frame's damage in buffer coordinates
+ *
+ * Adds the areas of debug overlays drawn on top of every frame to the
+ * frame's damage so the content below them gets repainted. This
+ * doesn't schedule any frames.
+ */
+void
+phoc_output_add_overlay_damage (PhocOutput *self, pixman_region32_t *buffer_damage)
+{
+  PhocOutputPrivate *priv;
+  enum wl_output_transform transform;
+  pixman_region32_t damage;
+  struct wlr_box box;
+  int width, height;
+
+  g_assert (PHOC_IS_OUTPUT (self));
+  priv = phoc_output_get_instance_private (self);
+
+  if (priv->perf_hud == NULL)
+    return;
+
+  phoc_perf_hud_get_box (priv->perf_hud, self, &box);
+
+  transform = wlr_output_transform_invert (self->wlr_output->transform);
+  wlr_output_transformed_resolution (self->wlr_output, &width, &height);
+  pixman_region32_init_rect (&damage, box.x, box.y, box.width, box.height);
+  wlr_region_transform (&damage, &damage, transform, width, height);
+  pixman_region32_union (buffer_damage, buffer_damage, &damage);
+  pixman_region32_fini (&damage);
+}
@@ -21,6 +21,7 @@ G_DECLARE_FINAL_TYPE (PhocOutput, phoc_output, PHOC, OUTPUT, GObject);
 typedef struct _PhocDesktop PhocDesktop;
 typedef struct _PhocInput PhocInput;
 typedef struct _PhocLayerSurface PhocLayerSurface;
+typedef struct _PhocViewSnapshot PhocViewSnapshot;
 
 /**
  * PhocOutput:
@@ -50,6 +51,7 @@ struct _PhocOutput {
   struct wl_listener        enable;
   struct wl_listener        mode;
   struct wl_listener        commit;
+  struct wl_listener        present;
   struct wl_listener        damage_frame;
   struct wl_listener        damage_destroy;
   struct wl_listener        output_destroy;
@@ -58,6 +60,45 @@ struct _PhocOutput {
 PhocOutput *phoc_output_new (PhocDesktop       *desktop,
                              struct wlr_output *wlr_output,
                              GError           **error);
+
+/**
+ * PhocOutputFrameStats:
+ * @n_rendered: Frames rendered and committed by the compositor
+ * @n_scanout: Frames where a fullscreen view was scanned out directly
+ * @n_presented: Frames the backend reported as presented
+ * @n_discarded: Frames the backend reported as discarded
+ *
+ * Frame statistics of an output since it got enabled.
+ */
+typedef struct _PhocOutputFrameStats {
+  guint64 n_rendered;
+  guint64 n_scanout;
+  guint64 n_presented;
+  guint64 n_discarded;
+} PhocOutputFrameStats;
+
+/**
+ * PhocOutputFrameInfo:
+ * @committed: Whether the frame got committed
+ * @scanout: Whether a fullscreen view was scanned out directly
+ * @render_time_us: Time it took to build the frame
+ * @damage_area: Repainted area in buffer pixels
+ * @n_draw_calls: Number of textures and rectangles drawn
+ * @n_views: Number of views drawn
+ * @n_surfaces: Number of surfaces drawn
+ *
+ * Information about the last frame rendered on an output.
+ */
+typedef struct _PhocOutputFrameInfo {
+  gboolean committed;
+  gboolean scanout;
+  gint64   render_time_us;
+  guint64  damage_area;
+  guint    n_draw_calls;
+  guint    n_views;
+  guint    n_surfaces;
+} PhocOutputFrameInfo;
+
 /* Surface iterators */
 typedef void (*PhocSurfaceIterator)(PhocOutput         *self,
                                     struct wlr_surface *surface,
@@ -125,6 +166,7 @@ void        phoc_output_get_decoration_box (PhocOutput *self, PhocView *view,
                                             struct wlr_box *box);
 void        phoc_output_update_shell_reveal (PhocOutput *self);
 void        phoc_output_force_shell_reveal (PhocOutput *self, gboolean force);
+void        phoc_output_set_held (PhocOutput *self, gboolean held);
 gboolean    phoc_output_is_builtin (PhocOutput *output);
 gboolean    phoc_output_is_match (PhocOutput *self,
                                   const char *make,
@@ -144,10 +186,22 @@ void       phoc_output_remove_frame_callback (PhocOutput        *self,
 void       phoc_output_remove_frame_callbacks_by_animatable (PhocOutput     *self,
                                                              PhocAnimatable *animatable);
 bool       phoc_output_has_frame_callbacks   (PhocOutput        *self);
+gint64     phoc_output_get_next_presentation_time (PhocOutput   *self);
+
+void       phoc_output_add_view_snapshot     (PhocOutput       *self,
+                                              PhocViewSnapshot *snapshot);
+void       phoc_output_remove_view_snapshot  (PhocOutput       *self,
+                                              PhocViewSnapshot *snapshot);
+GPtrArray *phoc_output_get_view_snapshots    (PhocOutput       *self);
 
 void       phoc_output_lower_shield          (PhocOutput *self);
 void       phoc_output_raise_shield          (PhocOutput *self);
 float      phoc_output_get_scale             (PhocOutput *self);
 const char *phoc_output_get_name             (PhocOutput *self);
+pixman_region32_t *phoc_output_get_scratch_region (PhocOutput *self);
+void       phoc_output_notify_frame_committed (PhocOutput *self, gboolean scanned_out);
+const PhocOutputFrameStats *phoc_output_get_frame_stats (PhocOutput *self);
+PhocOutputFrameInfo *phoc_output_get_frame_info (PhocOutput *self);
+void phoc_output_add_overlay_damage (PhocOutput *self, pixman_region32_t *buffer_damage);
 
 G_END_DECLS
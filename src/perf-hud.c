@@ -0,0 +1,347 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phoc-perf-hud"
+
+#include "phoc-config.h"
+
+#include "perf-hud.h"
+#include "render-private.h"
+#include "server.h"
+
+#include <math.h>
+#include <string.h>
+#include <cairo/cairo.h>
+#include <drm_fourcc.h>
+#include <wlr/types/wlr_output.h>
+
+#define PERF_HUD_N_SAMPLES     80
+/* Sizes in logical pixels */
+#define PERF_HUD_BAR_WIDTH     2
+#define PERF_HUD_WIDTH         (PERF_HUD_N_SAMPLES * PERF_HUD_BAR_WIDTH)
+#define PERF_HUD_TEXT_HEIGHT   32
+#define PERF_HUD_GRAPH_HEIGHT  48
+#define PERF_HUD_MARGIN        16
+#define PERF_HUD_FONT_SIZE     11
+
+#define PERF_HUD_UPDATE_INTERVAL_US (G_USEC_PER_SEC / 2)
+
+#define COLOR_HUD_BACKGROUND {0.0f, 0.0f, 0.0f, 0.6f}
+#define COLOR_HUD_TARGET     {0.4f, 0.4f, 0.4f, 0.4f}
+#define COLOR_HUD_CPU        {0.1f, 0.3f, 0.6f, 0.8f}
+#define COLOR_HUD_ON_TIME    {0.1f, 0.6f, 0.1f, 0.8f}
+#define COLOR_HUD_LATE       {0.7f, 0.1f, 0.1f, 0.8f}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (cairo_t, cairo_destroy)
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (cairo_surface_t, cairo_surface_destroy)
+
+typedef struct {
+  gint64 interval_us;
+  gint64 cpu_us;
+} PhocPerfHudSample;
+
+/**
+ * PhocPerfHud:
+ *
+ * An on screen display of an output's rendering performance, see
+ * `PHOC_DEBUG=perf-hud`.
+ *
+ * It shows a graph of the recent frame times split into the time
+ * spent building the frame on the CPU and the remainder until the
+ * next frame. Above it the frame rate, the average CPU time, the
+ * average time from commit to presentation and the repainted share of
+ * the output are shown.
+ *
+ * The wlroots renderer gives no access to GPU timings, so the time
+ * from commit to presentation is used as an upper bound for the GPU
+ * work. It also includes waiting for the next vblank.
+ *
+ * The HUD only adds its own small box to the damage of frames that
+ * get rendered anyway so what's underneath gets repainted. It never
+ * schedules frames itself so it doesn't distort what it measures. In
+ * turn the numbers are only updated when the output repaints.
+ */
+struct _PhocPerfHud {
+  GObject             parent;
+
+  PhocPerfHudSample   samples[PERF_HUD_N_SAMPLES];
+  guint               next_sample;
+  guint               n_samples;
+
+  gint64              last_frame_us;
+  gint64              last_commit_us;
+
+  /* Accumulated since the text got last updated */
+  struct {
+    gint64            since_us;
+    guint             n_frames;
+    gint64            cpu_us;
+    gint64            present_us;
+    guint             n_presented;
+    double            damage;
+  } window;
+
+  struct wlr_texture *text;
+};
+
+G_DEFINE_TYPE (PhocPerfHud, phoc_perf_hud, G_TYPE_OBJECT)
+
+
+static gint64
+get_refresh_us (PhocOutput *output)
+{
+  if (output->wlr_output->refresh > 0)
+    return (gint64)1000 * 1000 * 1000 / output->wlr_output->refresh;
+
+  return G_USEC_PER_SEC / 60;
+}
+
+
+static int
+get_bar_width (PhocOutput *output)
+{
+  return ceil (PERF_HUD_BAR_WIDTH * output->wlr_output->scale);
+}
+
+
+static void
+get_box (PhocOutput *output, struct wlr_box *box)
+{
+  float scale = output->wlr_output->scale;
+  int width, height;
+
+  /* Bottom left corner, away from the status bar and most cutouts */
+  wlr_output_transformed_resolution (output->wlr_output, &width, &height);
+  box->width = PERF_HUD_N_SAMPLES * get_bar_width (output);
+  box->height = ceil ((PERF_HUD_TEXT_HEIGHT + PERF_HUD_GRAPH_HEIGHT) * scale);
+  box->x = PERF_HUD_MARGIN * scale;
+  box->y = height - box->height - PERF_HUD_MARGIN * scale;
+}
+
+
+static void
+update_text (PhocPerfHud *self, PhocOutput *output, gint64 now)
+{
+  PhocRenderer *renderer = phoc_server_get_renderer (phoc_server_get_default ());
+  float scale = output->wlr_output->scale;
+  g_autoptr (cairo_surface_t) surface = NULL;
+  g_autoptr (cairo_t) cr = NULL;
+  g_autofree char *line1 = NULL;
+  g_autofree char *line2 = NULL;
+  double fps, cpu_ms, present_ms = 0.0;
+  int width, height;
+
+  fps = (double)self->window.n_frames * G_USEC_PER_SEC / (now - self->window.since_us);
+  cpu_ms = (double)self->window.cpu_us / self->window.n_frames / 1000.0;
+  if (self->window.n_presented)
+    present_ms = (double)self->window.present_us / self->window.n_presented / 1000.0;
+
+  line1 = g_strdup_printf ("%5.1f fps  damage %5.1f%%",
+                           fps, 100.0 * self->window.damage / self->window.n_frames);
+  line2 = g_strdup_printf ("cpu %4.1f ms  pres %4.1f ms", cpu_ms, present_ms);
+
+  width = ceil (PERF_HUD_WIDTH * scale);
+  height = ceil (PERF_HUD_TEXT_HEIGHT * scale);
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+  cr = cairo_create (surface);
+  cairo_scale (cr, scale, scale);
+  cairo_select_font_face (cr, "monospace", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+  cairo_set_font_size (cr, PERF_HUD_FONT_SIZE);
+  cairo_set_source_rgba (cr, 1.0, 1.0, 1.0, 1.0);
+  cairo_move_to (cr, 4, PERF_HUD_FONT_SIZE + 2);
+  cairo_show_text (cr, line1);
+  cairo_move_to (cr, 4, 2 * PERF_HUD_FONT_SIZE + 6);
+  cairo_show_text (cr, line2);
+  cairo_surface_flush (surface);
+
+  g_clear_pointer (&self->text, wlr_texture_destroy);
+  self->text = wlr_texture_from_pixels (phoc_renderer_get_wlr_renderer (renderer),
+                                        DRM_FORMAT_ARGB8888,
+                                        cairo_image_surface_get_stride (surface),
+                                        width, height,
+                                        cairo_image_surface_get_data (surface));
+}
+
+
+static void
+phoc_perf_hud_finalize (GObject *object)
+{
+  PhocPerfHud *self = PHOC_PERF_HUD (object);
+
+  g_clear_pointer (&self->text, wlr_texture_destroy);
+
+  G_OBJECT_CLASS (phoc_perf_hud_parent_class)->finalize (object);
+}
+
+
+static void
+phoc_perf_hud_class_init (PhocPerfHudClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = phoc_perf_hud_finalize;
+}
+
+
+static void
+phoc_perf_hud_init (PhocPerfHud *self)
+{
+}
+
+
+PhocPerfHud *
+phoc_perf_hud_new (void)
+{
+  return PHOC_PERF_HUD (g_object_new (PHOC_TYPE_PERF_HUD, NULL));
+}
+
+/**
+ * phoc_perf_hud_add_frame:
+ * @self: The HUD
+ * @output: The output the frame was rendered for
+ *
+ * Adds the statistics of the frame last committed on @output. Must not
+ * be called while rendering an output.
+ */
+void
+phoc_perf_hud_add_frame (PhocPerfHud *self, PhocOutput *output)
+{
+  PhocOutputFrameInfo *info = phoc_output_get_frame_info (output);
+  struct wlr_output *wlr_output = output->wlr_output;
+  gint64 now = g_get_monotonic_time ();
+
+  g_assert (PHOC_IS_PERF_HUD (self));
+
+  if (!info->committed)
+    return;
+
+  if (self->last_frame_us) {
+    self->samples[self->next_sample] = (PhocPerfHudSample) {
+      .interval_us = now - self->last_frame_us,
+      .cpu_us = info->render_time_us,
+    };
+    self->next_sample = (self->next_sample + 1) % PERF_HUD_N_SAMPLES;
+    self->n_samples = MIN (self->n_samples + 1, PERF_HUD_N_SAMPLES);
+  }
+  self->last_frame_us = now;
+  self->last_commit_us = now;
+
+  if (self->window.since_us == 0)
+    self->window.since_us = now;
+
+  self->window.n_frames++;
+  self->window.cpu_us += info->render_time_us;
+  if (wlr_output->width && wlr_output->height)
+    self->window.damage += (double)info->damage_area / wlr_output->width / wlr_output->height;
+
+  if (now - self->window.since_us < PERF_HUD_UPDATE_INTERVAL_US)
+    return;
+
+  update_text (self, output, now);
+  memset (&self->window, 0, sizeof (self->window));
+  self->window.since_us = now;
+}
+
+/**
+ * phoc_perf_hud_notify_present:
+ * @self: The HUD
+ * @when_us: The time the last committed frame got presented
+ *
+ * Notifies the HUD that the last committed frame got presented.
+ */
+void
+phoc_perf_hud_notify_present (PhocPerfHud *self, gint64 when_us)
+{
+  g_assert (PHOC_IS_PERF_HUD (self));
+
+  /* Backends presenting during the commit are not accounted */
+  if (self->last_commit_us == 0 || when_us < self->last_commit_us)
+    return;
+
+  self->window.present_us += when_us - self->last_commit_us;
+  self->window.n_presented++;
+  self->last_commit_us = 0;
+}
+
+/**
+ * phoc_perf_hud_render:
+ * @self: The HUD
+ * @output: The output that is being rendered
+ *
+ * Renders the HUD on top of the current frame. Only to be called while
+ * rendering @output. The HUD's box must be part of the frame's damage,
+ * see [method@PerfHud.get_box].
+ */
+void
+phoc_perf_hud_render (PhocPerfHud *self, PhocOutput *output)
+{
+  PhocRenderer *renderer = phoc_server_get_renderer (phoc_server_get_default ());
+  struct wlr_renderer *wlr_renderer = phoc_renderer_get_wlr_renderer (renderer);
+  const float *matrix = output->wlr_output->transform_matrix;
+  float scale = output->wlr_output->scale;
+  gint64 refresh_us = get_refresh_us (output);
+  int bar_width, graph_height, graph_y;
+  struct wlr_box box, rect;
+
+  g_assert (PHOC_IS_PERF_HUD (self));
+
+  get_box (output, &box);
+  wlr_render_rect (wlr_renderer, &box, (float[])COLOR_HUD_BACKGROUND, matrix);
+
+  if (self->text)
+    wlr_render_texture (wlr_renderer, self->text, matrix, box.x, box.y, 1.0);
+
+  /* The graph covers two refresh periods, the line marks one */
+  bar_width = get_bar_width (output);
+  graph_height = ceil (PERF_HUD_GRAPH_HEIGHT * scale);
+  graph_y = box.y + box.height;
+  rect = (struct wlr_box) { box.x, graph_y - graph_height / 2, box.width, MAX (1, (int)scale) };
+  wlr_render_rect (wlr_renderer, &rect, (float[])COLOR_HUD_TARGET, matrix);
+
+  for (guint i = 0; i < self->n_samples; i++) {
+    guint idx = (self->next_sample + PERF_HUD_N_SAMPLES - self->n_samples + i) % PERF_HUD_N_SAMPLES;
+    PhocPerfHudSample *sample = &self->samples[idx];
+    gint64 interval_us = MIN (sample->interval_us, 2 * refresh_us);
+    gint64 cpu_us = MIN (sample->cpu_us, interval_us);
+    int height = interval_us * graph_height / (2 * refresh_us);
+    int cpu_height = cpu_us * graph_height / (2 * refresh_us);
+    gboolean late = sample->interval_us > refresh_us * 3 / 2;
+
+    rect = (struct wlr_box) {
+      .x = box.x + i * bar_width,
+      .y = graph_y - height,
+      .width = bar_width,
+      .height = height - cpu_height,
+    };
+    if (!wlr_box_empty (&rect)) {
+      wlr_render_rect (wlr_renderer, &rect,
+                       late ? (float[])COLOR_HUD_LATE : (float[])COLOR_HUD_ON_TIME,
+                       matrix);
+    }
+
+    rect.y = graph_y - cpu_height;
+    rect.height = cpu_height;
+    if (!wlr_box_empty (&rect))
+      wlr_render_rect (wlr_renderer, &rect, (float[])COLOR_HUD_CPU, matrix);
+  }
+}
+
+/**
+ * phoc_perf_hud_get_box:
+ * @self: The HUD
+ * @output: The output
+ * @box: (out): The HUD's box
+ *
+ * Gets the box the HUD covers on @output in output coordinates. It
+ * needs to be repainted on every frame.
+ */
+void
+phoc_perf_hud_get_box (PhocPerfHud *self, PhocOutput *output, struct wlr_box *box)
+{
+  g_assert (PHOC_IS_PERF_HUD (self));
+
+  get_box (output, box);
+}
@@ -0,0 +1,30 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "output.h"
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define PHOC_TYPE_PERF_HUD (phoc_perf_hud_get_type ())
+
+G_DECLARE_FINAL_TYPE (PhocPerfHud, phoc_perf_hud, PHOC, PERF_HUD, GObject)
+
+PhocPerfHud *phoc_perf_hud_new            (void);
+void         phoc_perf_hud_add_frame      (PhocPerfHud    *self,
+                                           PhocOutput     *output);
+void         phoc_perf_hud_notify_present (PhocPerfHud    *self,
+                                           gint64          when_us);
+void         phoc_perf_hud_render         (PhocPerfHud    *self,
+                                           PhocOutput     *output);
+void         phoc_perf_hud_get_box        (PhocPerfHud    *self,
+                                           PhocOutput     *output,
+                                           struct wlr_box *box);
+
+G_END_DECLS
@@ -50,6 +50,8 @@ struct _PhocPhoshPrivate {
   struct wl_resource* resource;
   struct wl_global *global;
   GList *keyboard_events;
+  /* combo key -> PhocPhoshPrivateAccelerator across all keyboard events */
+  GHashTable *accelerators;
   guint last_action_id;
   GList *startup_trackers;
   PhocPhoshPrivateShellState state;
@@ -62,6 +64,11 @@ typedef struct {
   PhocPhoshPrivate *phosh;
 } PhocPhoshPrivateKeyboardEventData;
 
+typedef struct {
+  PhocPhoshPrivateKeyboardEventData *kbevent;
+  guint action_id;
+} PhocPhoshPrivateAccelerator;
+
 typedef struct {
   struct wl_resource *resource, *toplevel;
   struct phosh_private *phosh;
@@ -141,6 +148,14 @@ phoc_phosh_private_keyboard_event_destroy (PhocPhoshPrivateKeyboardEventData *kb
 
   g_debug ("Destroying private_keyboard_event %p (res %p)", kbevent, kbevent->resource);
   phosh = kbevent->phosh;
+  if (phosh) {
+    GHashTableIter iter;
+    gpointer key;
+
+    g_hash_table_iter_init (&iter, kbevent->subscribed_accelerators);
+    while (g_hash_table_iter_next (&iter, &key, NULL))
+      g_hash_table_remove (phosh->accelerators, key);
+  }
   g_hash_table_remove_all (kbevent->subscribed_accelerators);
   g_hash_table_unref (kbevent->subscribed_accelerators);
   wl_resource_set_user_data (kbevent->resource, NULL);
@@ -157,31 +172,11 @@ phoc_phosh_private_keyboard_event_handle_resource_destroy (struct wl_resource *r
 }
 
 static bool
-phoc_phosh_private_keyboard_event_accelerator_is_registered (PhocKeyCombo                      *combo,
-                                                             PhocPhoshPrivateKeyboardEventData *kbevent)
+phoc_phosh_private_accelerator_already_subscribed (PhocPhoshPrivate *phosh, PhocKeyCombo *combo)
 {
-  gint64 key = ((gint64) combo->modifiers << 32) | combo->keysym;
-  gpointer ret = g_hash_table_lookup (kbevent->subscribed_accelerators, &key);
-  g_debug ("Accelerator is registered: Lookup -> %p", ret);
-  return (ret != NULL);
-}
-
-static bool
-phoc_phosh_private_accelerator_already_subscribed (PhocKeyCombo *combo)
-{
-  GList *l;
-  PhocPhoshPrivateKeyboardEventData *kbevent;
-  PhocServer *server = phoc_server_get_default ();
-
-  PhocPhoshPrivate *phosh = server->desktop->phosh;
-
-  for (l = phosh->keyboard_events; l != NULL; l = l->next) {
-    kbevent = (PhocPhoshPrivateKeyboardEventData *)l->data;
-    if (phoc_phosh_private_keyboard_event_accelerator_is_registered (combo, kbevent))
-      return true;
-  }
+  gint64 key = phoc_key_combo_to_key (combo);
 
-  return false;
+  return g_hash_table_contains (phosh->accelerators, &key);
 }
 
 
@@ -214,6 +209,7 @@ phoc_phosh_private_keyboard_event_grab_accelerator_request (struct wl_client   *
 {
   guint new_action_id;
   gint64 *new_key;
+  PhocPhoshPrivateAccelerator *accel;
 
   PhocPhoshPrivateKeyboardEventData *kbevent = phoc_phosh_private_keyboard_event_from_resource (resource);
   g_autofree PhocKeyCombo *combo = parse_accelerator (accelerator);
@@ -230,7 +226,7 @@ phoc_phosh_private_keyboard_event_grab_accelerator_request (struct wl_client   *
     return;
   }
 
-  if (phoc_phosh_private_accelerator_already_subscribed (combo)) {
+  if (phoc_phosh_private_accelerator_already_subscribed (kbevent->phosh, combo)) {
     g_debug ("Accelerator %s already subscribed to!", accelerator);
 
     phosh_private_keyboard_event_send_grab_failed_event (resource,
@@ -261,12 +257,20 @@ phoc_phosh_private_keyboard_event_grab_accelerator_request (struct wl_client   *
   }
 
   new_key = (gint64 *) g_malloc (sizeof (gint64));
-  *new_key = ((gint64) combo->modifiers << 32) | combo->keysym;
+  *new_key = phoc_key_combo_to_key (combo);
 
   /* subscribed accelerators of kbevent */
   g_hash_table_insert (kbevent->subscribed_accelerators,
                        new_key, GUINT_TO_POINTER (new_action_id));
 
+  /* all subscribed accelerators, for the lookup on key press */
+  accel = g_new0 (PhocPhoshPrivateAccelerator, 1);
+  accel->kbevent = kbevent;
+  accel->action_id = new_action_id;
+  new_key = g_new (gint64, 1);
+  *new_key = phoc_key_combo_to_key (combo);
+  g_hash_table_insert (kbevent->phosh->accelerators, new_key, accel);
+
   phosh_private_keyboard_event_send_grab_success_event (resource,
                                                         accelerator,
                                                         new_action_id);
@@ -296,6 +300,7 @@ phoc_phosh_private_keyboard_event_ungrab_accelerator_request (struct wl_client *
   }
 
   if (found) {
+    g_hash_table_remove (kbevent->phosh->accelerators, key);
     g_hash_table_remove (kbevent->subscribed_accelerators, key);
     phosh_private_keyboard_event_send_ungrab_success_event (resource,
                                                             action_id);
@@ -747,6 +752,7 @@ phoc_phosh_private_finalize (GObject *object)
   PhocPhoshPrivate *self = PHOC_PHOSH_PRIVATE (object);
 
   wl_global_destroy (self->global);
+  g_clear_pointer (&self->accelerators, g_hash_table_destroy);
 
   G_OBJECT_CLASS (phoc_phosh_private_parent_class)->finalize (object);
 }
@@ -782,6 +788,7 @@ static void
 phoc_phosh_private_init (PhocPhoshPrivate *self)
 {
   self->last_action_id = 1;
+  self->accelerators = g_hash_table_new_full (g_int64_hash, g_int64_equal, g_free, g_free);
 }
 
 
@@ -797,36 +804,31 @@ phoc_phosh_private_forward_keysym (PhocKeyCombo *combo,
                                    uint32_t      timestamp,
                                    bool          pressed)
 {
-  GList *l;
   PhocServer *server = phoc_server_get_default ();
   PhocPhoshPrivate *phosh = server->desktop->phosh;
-  bool forwarded = false;
-
-  for (l = phosh->keyboard_events; l != NULL; l = l->next) {
-    PhocPhoshPrivateKeyboardEventData *kbevent = l->data;
-    uint32_t version = wl_resource_get_version (kbevent->resource);
-
-    g_debug("addr of kbevent and res kbev %p res %p", kbevent, kbevent->resource);
-    /*  forward the keysym if it is has been subscribed to */
-    if (phoc_phosh_private_keyboard_event_accelerator_is_registered (combo, kbevent)) {
-        gint64 key = ((gint64)combo->modifiers << 32) | combo->keysym;
-        guint action_id = GPOINTER_TO_UINT (g_hash_table_lookup (kbevent->subscribed_accelerators, &key));
-
-        if (pressed) {
-          phosh_private_keyboard_event_send_accelerator_activated_event (kbevent->resource,
-                                                                         action_id,
-                                                                         timestamp);
-          forwarded = true;
-        } else if (version >= PHOSH_PRIVATE_KEYBOARD_EVENT_ACCELERATOR_RELEASED_EVENT_SINCE_VERSION) {
-          phosh_private_keyboard_event_send_accelerator_released_event (kbevent->resource,
-                                                                        action_id,
-                                                                        timestamp);
-          forwarded = true;
-        }
-      }
+  PhocPhoshPrivateAccelerator *accel;
+  gint64 key = phoc_key_combo_to_key (combo);
+  uint32_t version;
+
+  /*  forward the keysym if it is has been subscribed to */
+  accel = g_hash_table_lookup (phosh->accelerators, &key);
+  if (accel == NULL)
+    return false;
+
+  version = wl_resource_get_version (accel->kbevent->resource);
+  if (pressed) {
+    phosh_private_keyboard_event_send_accelerator_activated_event (accel->kbevent->resource,
+                                                                   accel->action_id,
+                                                                   timestamp);
+    return true;
+  } else if (version >= PHOSH_PRIVATE_KEYBOARD_EVENT_ACCELERATOR_RELEASED_EVENT_SINCE_VERSION) {
+    phosh_private_keyboard_event_send_accelerator_released_event (accel->kbevent->resource,
+                                                                  accel->action_id,
+                                                                  timestamp);
+    return true;
   }
 
-  return forwarded;
+  return false;
 }
 
 void
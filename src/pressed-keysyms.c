@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phoc-pressed-keysyms"
+
+#include "phoc-config.h"
+#include "pressed-keysyms.h"
+
+#include <string.h>
+
+/**
+ * PhocPressedKeysyms:
+ * @keysyms: The currently pressed keysyms in ascending order
+ * @n_keysyms: The number of valid elements in @keysyms
+ *
+ * The set of currently pressed non-modifier keysyms of a keyboard.
+ *
+ * It's kept as a small sorted array so the length is known without a
+ * scan and membership is a binary search over the (usually tiny)
+ * number of pressed keys rather than a scan over all slots.
+ */
+
+/*
+ * Returns the index of @keysym if it's in the set. Otherwise returns
+ * the index where it would need to be inserted and sets @found to
+ * %FALSE.
+ */
+static guint
+pressed_keysyms_bsearch (const PhocPressedKeysyms *self,
+                         xkb_keysym_t              keysym,
+                         gboolean                 *found)
+{
+  guint lo = 0, hi = self->n_keysyms;
+
+  while (lo < hi) {
+    guint mid = lo + (hi - lo) / 2;
+
+    if (self->keysyms[mid] == keysym) {
+      *found = TRUE;
+      return mid;
+    }
+
+    if (self->keysyms[mid] < keysym)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  *found = FALSE;
+  return lo;
+}
+
+
+static gboolean
+keysym_is_modifier (xkb_keysym_t keysym)
+{
+  switch (keysym) {
+  case XKB_KEY_Shift_L: case XKB_KEY_Shift_R:
+  case XKB_KEY_Control_L: case XKB_KEY_Control_R:
+  case XKB_KEY_Caps_Lock:
+  case XKB_KEY_Shift_Lock:
+  case XKB_KEY_Meta_L: case XKB_KEY_Meta_R:
+  case XKB_KEY_Alt_L: case XKB_KEY_Alt_R:
+  case XKB_KEY_Super_L: case XKB_KEY_Super_R:
+  case XKB_KEY_Hyper_L: case XKB_KEY_Hyper_R:
+    return TRUE;
+  default:
+    return FALSE;
+  }
+}
+
+/**
+ * phoc_pressed_keysyms_add:
+ * @self: The pressed keysyms
+ * @keysym: The keysym to add
+ *
+ * Adds @keysym to the set of pressed keysyms. If the set is full
+ * the keysym is dropped.
+ */
+void
+phoc_pressed_keysyms_add (PhocPressedKeysyms *self, xkb_keysym_t keysym)
+{
+  gboolean found;
+  guint i;
+
+  g_assert (self);
+
+  if (keysym == XKB_KEY_NoSymbol)
+    return;
+
+  i = pressed_keysyms_bsearch (self, keysym, &found);
+  if (found)
+    return;
+
+  if (self->n_keysyms == PHOC_PRESSED_KEYSYMS_CAP)
+    return;
+
+  memmove (&self->keysyms[i + 1], &self->keysyms[i],
+           (self->n_keysyms - i) * sizeof (xkb_keysym_t));
+  self->keysyms[i] = keysym;
+  self->n_keysyms++;
+}
+
+/**
+ * phoc_pressed_keysyms_remove:
+ * @self: The pressed keysyms
+ * @keysym: The keysym to remove
+ *
+ * Removes @keysym from the set of pressed keysyms.
+ */
+void
+phoc_pressed_keysyms_remove (PhocPressedKeysyms *self, xkb_keysym_t keysym)
+{
+  gboolean found;
+  guint i;
+
+  g_assert (self);
+
+  i = pressed_keysyms_bsearch (self, keysym, &found);
+  if (!found)
+    return;
+
+  self->n_keysyms--;
+  memmove (&self->keysyms[i], &self->keysyms[i + 1],
+           (self->n_keysyms - i) * sizeof (xkb_keysym_t));
+}
+
+/**
+ * phoc_pressed_keysyms_contains:
+ * @self: The pressed keysyms
+ * @keysym: The keysym to look up
+ *
+ * Returns: %TRUE if @keysym is currently pressed
+ */
+gboolean
+phoc_pressed_keysyms_contains (const PhocPressedKeysyms *self, xkb_keysym_t keysym)
+{
+  gboolean found;
+
+  g_assert (self);
+
+  pressed_keysyms_bsearch (self, keysym, &found);
+  return found;
+}
+
+/**
+ * phoc_pressed_keysyms_update:
+ * @self: The pressed keysyms
+ * @keysyms: The keysyms of a key event
+ * @keysyms_len: The number of elements in @keysyms
+ * @pressed: Whether the key was pressed or released
+ *
+ * Updates the set of pressed keysyms from a key event. Modifier
+ * keysyms are ignored.
+ */
+void
+phoc_pressed_keysyms_update (PhocPressedKeysyms *self,
+                             const xkb_keysym_t *keysyms,
+                             size_t              keysyms_len,
+                             gboolean            pressed)
+{
+  for (size_t i = 0; i < keysyms_len; ++i) {
+    if (keysym_is_modifier (keysyms[i]))
+      continue;
+
+    if (pressed)
+      phoc_pressed_keysyms_add (self, keysyms[i]);
+    else
+      phoc_pressed_keysyms_remove (self, keysyms[i]);
+  }
+}
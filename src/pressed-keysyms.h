@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <glib.h>
+#include <xkbcommon/xkbcommon.h>
+
+G_BEGIN_DECLS
+
+#define PHOC_PRESSED_KEYSYMS_CAP 32
+
+typedef struct _PhocPressedKeysyms {
+  xkb_keysym_t keysyms[PHOC_PRESSED_KEYSYMS_CAP];
+  guint        n_keysyms;
+} PhocPressedKeysyms;
+
+void          phoc_pressed_keysyms_add        (PhocPressedKeysyms *self,
+                                               xkb_keysym_t        keysym);
+void          phoc_pressed_keysyms_remove     (PhocPressedKeysyms *self,
+                                               xkb_keysym_t        keysym);
+gboolean      phoc_pressed_keysyms_contains   (const PhocPressedKeysyms *self,
+                                               xkb_keysym_t              keysym);
+void          phoc_pressed_keysyms_update     (PhocPressedKeysyms *self,
+                                               const xkb_keysym_t *keysyms,
+                                               size_t              keysyms_len,
+                                               gboolean            pressed);
+
+/**
+ * phoc_pressed_keysyms_get_length:
+ * @self: The pressed keysyms
+ *
+ * Returns: The number of currently pressed keysyms
+ */
+static inline guint
+phoc_pressed_keysyms_get_length (const PhocPressedKeysyms *self)
+{
+  return self->n_keysyms;
+}
+
+G_END_DECLS
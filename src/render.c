@@ -16,6 +16,8 @@
 #include "server.h"
 #include "render.h"
 #include "render-private.h"
+#include "view-scale-cache.h"
+#include "view-snapshot.h"
 #include "xwayland-surface.h"
 #include "utils.h"
 
@@ -34,6 +36,7 @@
 #include <wlr/render/egl.h>
 #include <wlr/types/wlr_compositor.h>
 #include <wlr/types/wlr_matrix.h>
+#include <wlr/types/wlr_subcompositor.h>
 #include <wlr/types/wlr_buffer.h>
 #include <wlr/types/wlr_linux_dmabuf_v1.h>
 #include <wlr/util/region.h>
@@ -99,6 +102,8 @@ G_DEFINE_TYPE_WITH_CODE (PhocRenderer, phoc_renderer, G_TYPE_OBJECT,
 struct render_data {
   pixman_region32_t *damage;
   float alpha;
+  /* Surface tree already drawn from a view's scale cache */
+  struct wlr_surface *cached_root;
 };
 
 struct view_render_data {
@@ -171,26 +176,26 @@ static void scissor_output(struct wlr_output *wlr_output,
 	wlr_renderer_scissor(wlr_output->renderer, &box);
 }
 
-static void render_texture(struct wlr_output *wlr_output,
+static void render_texture(PhocOutput *output,
 		pixman_region32_t *output_damage, struct wlr_texture *texture,
 		const struct wlr_fbox *src_box, const struct wlr_box *dst_box,
 		const float matrix[static 9],
 		float rotation, float alpha) {
+	struct wlr_output *wlr_output = output->wlr_output;
 	struct wlr_box rotated;
 	phoc_utils_rotated_bounds(&rotated, dst_box, rotation);
 
-	pixman_region32_t damage;
-	pixman_region32_init(&damage);
-	pixman_region32_union_rect(&damage, &damage, dst_box->x, dst_box->y,
+	pixman_region32_t *damage = phoc_output_get_scratch_region(output);
+	pixman_region32_intersect_rect(damage, output_damage, dst_box->x, dst_box->y,
 		dst_box->width, dst_box->height);
-	pixman_region32_intersect(&damage, &damage, output_damage);
-	bool damaged = pixman_region32_not_empty(&damage);
+	bool damaged = pixman_region32_not_empty(damage);
 	if (!damaged) {
-		goto buffer_damage_finish;
+		return;
 	}
 
 	int nrects;
-	pixman_box32_t *rects = pixman_region32_rectangles(&damage, &nrects);
+	pixman_box32_t *rects = pixman_region32_rectangles(damage, &nrects);
+	phoc_output_get_frame_info (output)->n_draw_calls += nrects;
 	for (int i = 0; i < nrects; ++i) {
 		scissor_output(wlr_output, &rects[i]);
 
@@ -202,9 +207,6 @@ static void render_texture(struct wlr_output *wlr_output,
                                                        texture, matrix, alpha);
 		}
 	}
-
-buffer_damage_finish:
-	pixman_region32_fini(&damage);
 }
 
 static void
@@ -231,6 +233,25 @@ collect_touch_points (PhocOutput *output, struct wlr_surface *surface, struct wl
   }
 }
 
+static gboolean
+surface_is_in_tree (struct wlr_surface *surface, struct wlr_surface *root)
+{
+  while (surface != root) {
+    struct wlr_subsurface *subsurface;
+
+    if (!wlr_surface_is_subsurface (surface))
+      return FALSE;
+
+    subsurface = wlr_subsurface_from_wlr_surface (surface);
+    if (subsurface == NULL)
+      return FALSE;
+
+    surface = subsurface->parent;
+  }
+
+  return TRUE;
+}
+
 static void render_surface_iterator(PhocOutput *output,
 		struct wlr_surface *surface, struct wlr_box *box, float rotation,
 		float scale, void *_data) {
@@ -244,6 +265,14 @@ static void render_surface_iterator(PhocOutput *output,
 		return;
 	}
 
+	if (data->cached_root && surface_is_in_tree (surface, data->cached_root)) {
+		wlr_presentation_surface_sampled_on_output(output->desktop->presentation,
+			surface, wlr_output);
+		return;
+	}
+
+	phoc_output_get_frame_info (output)->n_surfaces++;
+
 	struct wlr_fbox src_box;
 	wlr_surface_get_buffer_source_box(surface, &src_box);
 
@@ -257,7 +286,7 @@ static void render_surface_iterator(PhocOutput *output,
 	wlr_matrix_project_box(matrix, &dst_box, transform, rotation,
 		wlr_output->transform_matrix);
 
-	render_texture(wlr_output, output_damage,
+	render_texture(output, output_damage,
 		texture, &src_box, &dst_box, matrix, rotation, alpha);
 
 	wlr_presentation_surface_sampled_on_output(output->desktop->presentation,
@@ -275,14 +304,12 @@ static void render_decorations(PhocOutput *output,
 	struct wlr_box box;
 	phoc_output_get_decoration_box(output, view, &box);
 
-	pixman_region32_t damage;
-	pixman_region32_init(&damage);
-	pixman_region32_union_rect(&damage, &damage, box.x, box.y,
+	pixman_region32_t *damage = phoc_output_get_scratch_region(output);
+	pixman_region32_intersect_rect(damage, data->damage, box.x, box.y,
 		box.width, box.height);
-	pixman_region32_intersect(&damage, &damage, data->damage);
-	bool damaged = pixman_region32_not_empty(&damage);
+	bool damaged = pixman_region32_not_empty(damage);
 	if (!damaged) {
-		goto buffer_damage_finish;
+		return;
 	}
 
 	float matrix[9];
@@ -292,14 +319,117 @@ static void render_decorations(PhocOutput *output,
 
 	int nrects;
 	pixman_box32_t *rects =
-		pixman_region32_rectangles(&damage, &nrects);
+		pixman_region32_rectangles(damage, &nrects);
+	phoc_output_get_frame_info (output)->n_draw_calls += nrects;
 	for (int i = 0; i < nrects; ++i) {
 		scissor_output(output->wlr_output, &rects[i]);
 		wlr_render_quad_with_matrix(output->wlr_output->renderer, color, matrix);
 	}
+}
 
-buffer_damage_finish:
-	pixman_region32_fini(&damage);
+
+static gboolean
+render_saved_content (PhocOutput *output, PhocView *view, struct render_data *data)
+{
+  PhocViewSnapshot *saved = phoc_view_get_saved_content (view);
+  struct wlr_box box;
+  float matrix[9];
+
+  if (saved == NULL || phoc_view_snapshot_get_output (saved) != output)
+    return FALSE;
+
+  if (!phoc_view_snapshot_get_output_box (saved, &box) || wlr_box_empty (&box))
+    return FALSE;
+
+  wlr_matrix_project_box (matrix, &box, WL_OUTPUT_TRANSFORM_NORMAL, 0,
+                          output->wlr_output->transform_matrix);
+  render_texture (output, data->damage, phoc_view_snapshot_get_texture (saved), NULL, &box,
+                  matrix, 0, data->alpha);
+  return TRUE;
+}
+
+
+/*
+ * The area a scaled view's surface tree covers in output buffer
+ * coordinates. This matches what render_surface_iterator() does for
+ * the individual surfaces.
+ */
+static gboolean
+get_scale_cache_box (PhocOutput *output, PhocView *view, struct wlr_box *extents,
+                     struct wlr_box *box)
+{
+  struct wlr_box output_box;
+
+  if (view->wlr_surface == NULL)
+    return FALSE;
+
+  wlr_surface_get_extends (view->wlr_surface, extents);
+  if (wlr_box_empty (extents))
+    return FALSE;
+
+  wlr_output_layout_get_box (output->desktop->layout, output->wlr_output, &output_box);
+  *box = (struct wlr_box) {
+    .x = view->box.x - output_box.x + extents->x,
+    .y = view->box.y - output_box.y + extents->y,
+    .width = extents->width,
+    .height = extents->height,
+  };
+  phoc_output_scale_box (output, box, phoc_view_get_scale (view));
+  phoc_output_scale_box (output, box, output->wlr_output->scale);
+
+  return !wlr_box_empty (box);
+}
+
+
+static void
+update_scale_caches (PhocRenderer *self, PhocOutput *output)
+{
+  PhocDesktop *desktop = output->desktop;
+  PhocView *view;
+
+  wl_list_for_each (view, &desktop->views, link) {
+    PhocViewScaleCache *cache;
+    struct wlr_box extents, box;
+
+    if (phoc_view_get_scale (view) == 1.0 || !phoc_desktop_view_is_visible (desktop, view))
+      continue;
+
+    if (phoc_view_get_output (view) != output)
+      continue;
+
+    cache = phoc_view_get_scale_cache (view);
+    if (cache == NULL || !get_scale_cache_box (output, view, &extents, &box))
+      continue;
+
+    phoc_view_scale_cache_update (cache, self, view->wlr_surface, &extents,
+                                  box.width, box.height);
+  }
+}
+
+
+static gboolean
+render_scale_cache (PhocOutput *output, PhocView *view, struct render_data *data)
+{
+  PhocViewScaleCache *cache;
+  struct wlr_texture *texture;
+  struct wlr_box extents, box;
+  float matrix[9];
+
+  if (phoc_view_get_scale (view) == 1.0)
+    return FALSE;
+
+  cache = phoc_view_get_scale_cache (view);
+  if (cache == NULL || !get_scale_cache_box (output, view, &extents, &box))
+    return FALSE;
+
+  texture = phoc_view_scale_cache_get_texture (cache, &extents, box.width, box.height);
+  if (texture == NULL)
+    return FALSE;
+
+  wlr_matrix_project_box (matrix, &box, WL_OUTPUT_TRANSFORM_NORMAL, 0,
+                          output->wlr_output->transform_matrix);
+  render_texture (output, data->damage, texture, NULL, &box, matrix, 0, data->alpha);
+  return TRUE;
 }
 
 
@@ -310,11 +440,43 @@ render_view (PhocOutput *output, PhocView *view, struct render_data *data)
   if (view_is_fullscreen (view) && phoc_view_get_fullscreen_output (view) != output)
     return;
 
+  phoc_output_get_frame_info (output)->n_views++;
   data->alpha = phoc_view_get_alpha (view);
   if (!view_is_fullscreen (view))
     render_decorations(output, view, data);
 
+  // Show the old content while the client resizes
+  if (render_saved_content (output, view, data))
+    return;
+
+  // Scaled views get their surface tree from the cache, popups are drawn as usual
+  if (render_scale_cache (output, view, data))
+    data->cached_root = view->wlr_surface;
+
   phoc_output_view_for_each_surface(output, view, render_surface_iterator, data);
+  data->cached_root = NULL;
+}
+
+
+static void
+render_view_snapshots (PhocOutput *output, struct render_data *data)
+{
+  GPtrArray *snapshots = phoc_output_get_view_snapshots (output);
+
+  for (guint i = 0; i < snapshots->len; i++) {
+    PhocViewSnapshot *snapshot = g_ptr_array_index (snapshots, i);
+    struct wlr_texture *texture = phoc_view_snapshot_get_texture (snapshot);
+    struct wlr_box box;
+    float matrix[9];
+
+    if (!phoc_view_snapshot_get_output_box (snapshot, &box) || wlr_box_empty (&box))
+      continue;
+
+    wlr_matrix_project_box (matrix, &box, WL_OUTPUT_TRANSFORM_NORMAL, 0,
+                            output->wlr_output->transform_matrix);
+    render_texture (output, data->damage, texture, NULL, &box, matrix, 0,
+                    phoc_view_snapshot_get_alpha (snapshot));
+  }
 }
 
 
@@ -515,10 +677,7 @@ damage_touch_point_cb (gpointer data, gpointer user_data)
 
   int size = TOUCH_POINT_SIZE * wlr_output->scale;
   struct wlr_box box = wlr_box_from_touch_point (touch_point, size, size);
-  pixman_region32_t region;
-  pixman_region32_init_rect(&region, box.x, box.y, box.width, box.height);
-  wlr_output_damage_add(output->damage, &region);
-  pixman_region32_fini(&region);
+  wlr_output_damage_add_box (output->damage, &box);
 }
 
 static void
@@ -572,6 +731,38 @@ view_render_iterator (struct wlr_surface *surface, int sx, int sy, void *_data)
 }
 
 
+/*
+ * Renders the view into a newly allocated buffer. The renderer is
+ * left in the buffer's render pass, so the caller needs to end it.
+ */
+static struct wlr_buffer *
+begin_render_view (PhocRenderer *self, PhocView *view, int width, int height)
+{
+  struct wlr_buffer *buffer;
+  struct wlr_drm_format_set fmt_set = {};
+  const struct wlr_drm_format *fmt;
+
+  wlr_drm_format_set_add (&fmt_set, DRM_FORMAT_ARGB8888, DRM_FORMAT_MOD_INVALID);
+  fmt = wlr_drm_format_set_get (&fmt_set, DRM_FORMAT_ARGB8888);
+  buffer = wlr_allocator_create_buffer (self->wlr_allocator, width, height, fmt);
+  wlr_drm_format_set_finish (&fmt_set);
+  if (!buffer)
+    return NULL;
+
+  struct view_render_data render_data ={
+    .view = view,
+    .width = width,
+    .height = height
+  };
+
+  wlr_renderer_begin_with_buffer (self->wlr_renderer, buffer);
+  wlr_renderer_clear (self->wlr_renderer, (float[])COLOR_TRANSPARENT);
+  wlr_surface_for_each_surface (view->wlr_surface, view_render_iterator, &render_data);
+
+  return buffer;
+}
+
+
 gboolean
 phoc_renderer_render_view_to_buffer (PhocRenderer         *self,
                                      PhocView             *view,
@@ -589,26 +780,9 @@ phoc_renderer_render_view_to_buffer (PhocRenderer         *self,
   int32_t height = wl_shm_buffer_get_height (shm_buffer);
   int32_t stride = wl_shm_buffer_get_stride (shm_buffer);
 
-  struct wlr_drm_format_set fmt_set = {};
-  wlr_drm_format_set_add (&fmt_set, DRM_FORMAT_ARGB8888, DRM_FORMAT_MOD_INVALID);
-
-  const struct wlr_drm_format *fmt = wlr_drm_format_set_get (&fmt_set, DRM_FORMAT_ARGB8888);
-
-  buffer = wlr_allocator_create_buffer (self->wlr_allocator, width, height, fmt);
-  if (!buffer) {
-    wlr_drm_format_set_finish (&fmt_set);
+  buffer = begin_render_view (self, view, width, height);
+  if (!buffer)
     g_return_val_if_reached (false);
-  }
-
-  struct view_render_data render_data ={
-    .view = view,
-    .width = width,
-    .height = height
-  };
-
-  wlr_renderer_begin_with_buffer (self->wlr_renderer, buffer);
-  wlr_renderer_clear (self->wlr_renderer, (float[])COLOR_TRANSPARENT);
-  wlr_surface_for_each_surface (surface, view_render_iterator, &render_data);
 
   wl_shm_buffer_begin_access (shm_buffer);
   void *data = wl_shm_buffer_get_data (shm_buffer);
@@ -617,13 +791,73 @@ phoc_renderer_render_view_to_buffer (PhocRenderer         *self,
   wlr_renderer_end (self->wlr_renderer);
 
   wlr_buffer_drop (buffer);
-  wlr_drm_format_set_finish (&fmt_set);
 
   wl_shm_buffer_end_access(shm_buffer);
 
   return true;
 }
 
+/**
+ * phoc_renderer_render_view_to_texture:
+ * @self: The renderer
+ * @view: The view to render
+ * @width: The width of the texture
+ * @height: The height of the texture
+ *
+ * Renders a snapshot of the view's current content into a texture
+ * on the GPU. The view's geometry is scaled to fit the given size.
+ * The texture stays valid when the client goes away. Must not be
+ * called while rendering an output.
+ *
+ * Returns: (transfer full) (nullable): The texture or %NULL on error
+ */
+struct wlr_texture *
+phoc_renderer_render_view_to_texture (PhocRenderer *self,
+                                      PhocView     *view,
+                                      int           width,
+                                      int           height)
+{
+  struct wlr_texture *texture;
+  struct wlr_buffer *buffer;
+
+  g_assert (PHOC_IS_RENDERER (self));
+  g_return_val_if_fail (view->wlr_surface, NULL);
+  g_return_val_if_fail (self->wlr_allocator, NULL);
+  g_return_val_if_fail (width > 0 && height > 0, NULL);
+
+  buffer = begin_render_view (self, view, width, height);
+  if (!buffer)
+    return NULL;
+  wlr_renderer_end (self->wlr_renderer);
+
+  /* The texture keeps its own reference to the buffer */
+  texture = wlr_texture_from_buffer (self->wlr_renderer, buffer);
+  wlr_buffer_drop (buffer);
+
+  return texture;
+}
+
+static void
+update_view_frame_stats (PhocOutput *output, struct timespec *now)
+{
+  PhocDesktop *desktop = output->desktop;
+  gint64 now_us = now->tv_sec * G_USEC_PER_SEC + now->tv_nsec / 1000;
+  gint64 refresh_us = G_USEC_PER_SEC / 60;
+  PhocView *view;
+
+  if (output->wlr_output->refresh > 0)
+    refresh_us = (gint64)1000 * 1000 * 1000 / output->wlr_output->refresh;
+
+  wl_list_for_each (view, &desktop->views, link) {
+    /* Views spanning several outputs are accounted on their main output */
+    if (!phoc_desktop_view_is_visible (desktop, view) || phoc_view_get_output (view) != output)
+      continue;
+
+    phoc_view_notify_frame_done (view, now_us, refresh_us);
+  }
+}
+
+
 static void surface_send_frame_done_iterator(PhocOutput *output,
 		struct wlr_surface *surface, struct wlr_box *box, float rotation,
 		float scale, void *data) {
@@ -663,6 +897,86 @@ render_damage (PhocRenderer *self, PhocOutput *output)
 }
 
 
+/*
+ * Renders the layers, views and drag icons within @damage. @damage is
+ * in buffer coordinates.
+ */
+static void
+render_scene (PhocRenderer *self, PhocOutput *output, pixman_region32_t *damage)
+{
+  PhocServer *server = phoc_server_get_default ();
+  PhocDesktop *desktop = PHOC_DESKTOP (output->desktop);
+  PhocOutputFrameInfo *frame_info = phoc_output_get_frame_info (output);
+  float clear_color[] = COLOR_BLACK;
+  struct render_data data = {
+    .damage = damage,
+    .alpha = 1.0,
+  };
+  pixman_box32_t *rects;
+  int nrects;
+
+  // Output isn't damaged but might need buffer swap
+  if (!pixman_region32_not_empty (damage))
+    return;
+
+  rects = pixman_region32_rectangles (damage, &nrects);
+  for (int i = 0; i < nrects; ++i) {
+    scissor_output (output->wlr_output, &rects[i]);
+    wlr_renderer_clear (self->wlr_renderer, clear_color);
+    frame_info->damage_area += (guint64)(rects[i].x2 - rects[i].x1) *
+      (rects[i].y2 - rects[i].y1);
+  }
+
+  // If a view is fullscreen on this output, render it
+  if (output->fullscreen_view != NULL) {
+    PhocView *view = output->fullscreen_view;
+
+    render_view (output, view, &data);
+
+    // During normal rendering the xwayland window tree isn't traversed
+    // because all windows are rendered. Here we only want to render
+    // the fullscreen window's children so we have to traverse the tree.
+#ifdef PHOC_XWAYLAND
+    if (PHOC_IS_XWAYLAND_SURFACE (view)) {
+      struct wlr_xwayland_surface *xsurface =
+        phoc_xwayland_surface_get_wlr_surface (PHOC_XWAYLAND_SURFACE (view));
+      phoc_output_xwayland_children_for_each_surface (output,
+                                                      xsurface,
+                                                      render_surface_iterator,
+                                                      &data);
+    }
+#endif
+
+    if (phoc_output_has_shell_revealed (output)) {
+      // Render top layer above fullscreen view when requested
+      render_layer (output, damage, ZWLR_LAYER_SHELL_V1_LAYER_TOP);
+    }
+  } else {
+    PhocView *view;
+
+    // Render background and bottom layers under views
+    render_layer (output, damage, ZWLR_LAYER_SHELL_V1_LAYER_BACKGROUND);
+    render_layer (output, damage, ZWLR_LAYER_SHELL_V1_LAYER_BOTTOM);
+
+    // Render all views
+    wl_list_for_each_reverse (view, &desktop->views, link) {
+      if (phoc_desktop_view_is_visible (desktop, view))
+        render_view (output, view, &data);
+    }
+
+    // Render snapshots of animating views above the live ones
+    render_view_snapshots (output, &data);
+
+    // Render top layer above views
+    render_layer (output, damage, ZWLR_LAYER_SHELL_V1_LAYER_TOP);
+  }
+
+  render_drag_icons (output, damage, server->input);
+
+  render_layer (output, damage, ZWLR_LAYER_SHELL_V1_LAYER_OVERLAY);
+}
+
+
 /**
  * phoc_renderer_render_output:
  * @self: The renderer
@@ -672,13 +986,16 @@ render_damage (PhocRenderer *self, PhocOutput *output)
  */
 void phoc_renderer_render_output (PhocRenderer *self, PhocOutput *output) {
 	struct wlr_output *wlr_output = output->wlr_output;
-	PhocDesktop *desktop = PHOC_DESKTOP (output->desktop);
 	PhocServer *server = phoc_server_get_default ();
 	struct wlr_renderer *wlr_renderer;
 
         g_assert (PHOC_IS_RENDERER (self));
         wlr_renderer = self->wlr_renderer;
 
+	/* Reset first so a skipped frame doesn't report the last one again */
+	PhocOutputFrameInfo *frame_info = phoc_output_get_frame_info (output);
+	*frame_info = (PhocOutputFrameInfo) { 0 };
+
 	if (!wlr_output->enabled) {
 		return;
 	}
@@ -686,7 +1003,7 @@ void phoc_renderer_render_output (PhocRenderer *self, PhocOutput *output) {
 	struct timespec now;
 	clock_gettime(CLOCK_MONOTONIC, &now);
 
-	float clear_color[] = COLOR_BLACK;
+	gint64 start_us = g_get_monotonic_time ();
 
 	g_signal_emit (self, signals[RENDER_START], 0, output);
 
@@ -695,10 +1012,14 @@ void phoc_renderer_render_output (PhocRenderer *self, PhocOutput *output) {
 		bool scanned_out = scan_out_fullscreen_view(output);
 
 		if (scanned_out) {
+			phoc_output_notify_frame_committed (output, TRUE);
 			goto send_frame_done;
 		}
 	}
 
+	// Needs to happen before we start rendering to the output
+	update_scale_caches (self, output);
+
 	bool needs_frame;
 	pixman_region32_t buffer_damage;
 	pixman_region32_init(&buffer_damage);
@@ -707,11 +1028,6 @@ void phoc_renderer_render_output (PhocRenderer *self, PhocOutput *output) {
 		return;
 	}
 
-	struct render_data data = {
-		.damage = &buffer_damage,
-		.alpha = 1.0,
-	};
-
 	enum wl_output_transform transform =
 		wlr_output_transform_invert(wlr_output->transform);
 
@@ -732,64 +1048,24 @@ void phoc_renderer_render_output (PhocRenderer *self, PhocOutput *output) {
 
 	wlr_renderer_begin(wlr_renderer, wlr_output->width, wlr_output->height);
 
-	if (!pixman_region32_not_empty(&buffer_damage)) {
-		// Output isn't damaged but needs buffer swap
-		goto renderer_end;
+	render_scene (self, output, &buffer_damage);
+
+	/* Debug overlays are drawn on top of every frame. Repaint what's
+	 * below them without accounting it in the frame's statistics. */
+	pixman_region32_t overlay_damage, overlay_repaint;
+	pixman_region32_init (&overlay_damage);
+	pixman_region32_init (&overlay_repaint);
+	phoc_output_add_overlay_damage (output, &overlay_damage);
+	pixman_region32_subtract (&overlay_repaint, &overlay_damage, &buffer_damage);
+	if (pixman_region32_not_empty (&overlay_repaint)) {
+		PhocOutputFrameInfo info = *frame_info;
+
+		render_scene (self, output, &overlay_repaint);
+		*frame_info = info;
+		pixman_region32_union (&buffer_damage, &buffer_damage, &overlay_repaint);
 	}
+	pixman_region32_fini (&overlay_repaint);
 
-	int nrects;
-	pixman_box32_t *rects = pixman_region32_rectangles(&buffer_damage, &nrects);
-	for (int i = 0; i < nrects; ++i) {
-		scissor_output(output->wlr_output, &rects[i]);
-		wlr_renderer_clear(wlr_renderer, clear_color);
-	}
-
-	// If a view is fullscreen on this output, render it
-	if (output->fullscreen_view != NULL) {
-		PhocView *view = output->fullscreen_view;
-
-		render_view(output, view, &data);
-
-		// During normal rendering the xwayland window tree isn't traversed
-		// because all windows are rendered. Here we only want to render
-		// the fullscreen window's children so we have to traverse the tree.
-#ifdef PHOC_XWAYLAND
-		if (PHOC_IS_XWAYLAND_SURFACE (view)) {
-			struct wlr_xwayland_surface *xsurface =
-				phoc_xwayland_surface_get_wlr_surface (PHOC_XWAYLAND_SURFACE (view));
-			phoc_output_xwayland_children_for_each_surface(output,
-								       xsurface,
-								       render_surface_iterator,
-								       &data);
-		}
-#endif
-
-		if (phoc_output_has_shell_revealed (output)) {
-			// Render top layer above fullscreen view when requested
-			render_layer (output, &buffer_damage, ZWLR_LAYER_SHELL_V1_LAYER_TOP);
-		}
-	} else {
-		// Render background and bottom layers under views
-		render_layer (output, &buffer_damage, ZWLR_LAYER_SHELL_V1_LAYER_BACKGROUND);
-		render_layer (output, &buffer_damage, ZWLR_LAYER_SHELL_V1_LAYER_BOTTOM);
-
-		PhocView *view;
-			// Render all views
-		wl_list_for_each_reverse(view, &desktop->views, link) {
-			if (phoc_desktop_view_is_visible(desktop, view)) {
-				render_view(output, view, &data);
-			}
-		}
-
-		// Render top layer above views
-		render_layer (output, &buffer_damage, ZWLR_LAYER_SHELL_V1_LAYER_TOP);
-	}
-
-	render_drag_icons(output, &buffer_damage, server->input);
-
-	render_layer (output, &buffer_damage, ZWLR_LAYER_SHELL_V1_LAYER_OVERLAY);
-
-renderer_end:
 	wlr_output_render_software_cursors(wlr_output, &buffer_damage);
 	wlr_renderer_scissor(wlr_renderer, NULL);
 
@@ -808,18 +1084,25 @@ renderer_end:
 
 	wlr_region_transform(&frame_damage, &output->damage->current,
 		transform, width, height);
+	/* Let the display update the overlays too */
+	pixman_region32_union (&frame_damage, &frame_damage, &overlay_damage);
 
 	wlr_output_set_damage(wlr_output, &frame_damage);
 	pixman_region32_fini(&frame_damage);
+	pixman_region32_fini (&overlay_damage);
 
 	if (!wlr_output_commit(wlr_output)) {
 		goto buffer_damage_finish;
 	}
+	phoc_output_notify_frame_committed (output, FALSE);
 
 buffer_damage_finish:
 	pixman_region32_fini(&buffer_damage);
 
 send_frame_done:
+	frame_info->render_time_us = g_get_monotonic_time () - start_us;
+	update_view_frame_stats (output, &now);
+
 	// Send frame done events to all visible surfaces
 	phoc_output_for_each_surface(output, surface_send_frame_done_iterator, &now, true);
 
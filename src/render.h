@@ -25,5 +25,10 @@ gboolean      phoc_renderer_render_view_to_buffer (PhocRenderer           *self,
                                                    PhocView               *view,
                                                    struct wl_shm_buffer   *data,
                                                    uint32_t               *flags);
+struct wlr_texture *
+              phoc_renderer_render_view_to_texture (PhocRenderer *self,
+                                                    PhocView     *view,
+                                                    int           width,
+                                                    int           height);
 
 G_END_DECLS
@@ -19,8 +19,21 @@
 
 #include <errno.h>
 
+/* Run deferred initialization even if no output ever renders a frame */
+#define PHOC_SERVER_DEFERRED_INIT_TIMEOUT_S 5
+
+typedef struct {
+  const char *phase;
+  gint64      time_us;
+} PhocStartupPhase;
+
 typedef struct _PhocServerPrivate {
   GStrv dt_compatibles;
+
+  /* Startup tracing, dropped once the first frame got rendered */
+  GArray  *startup_phases;
+  gboolean first_frame_done;
+  guint    deferred_init_id;
 } PhocServerPrivate;
 
 static void phoc_server_initable_iface_init (GInitableIface *iface);
@@ -186,6 +199,58 @@ on_shell_state_changed (PhocServer *self, GParamSpec *pspec, PhocPhoshPrivate *p
 }
 
 
+static void
+log_startup_phases (PhocServer *self)
+{
+  PhocServerPrivate *priv = phoc_server_get_instance_private (self);
+  gint64 start, last;
+
+  if (priv->startup_phases->len == 0)
+    return;
+
+  start = last = g_array_index (priv->startup_phases, PhocStartupPhase, 0).time_us;
+  for (guint i = 0; i < priv->startup_phases->len; i++) {
+    PhocStartupPhase *phase = &g_array_index (priv->startup_phases, PhocStartupPhase, i);
+
+    g_message ("Startup: %-20s at %8.3f ms (+%.3f ms)", phase->phase,
+               (phase->time_us - start) / 1000.0,
+               (phase->time_us - last) / 1000.0);
+    last = phase->time_us;
+  }
+}
+
+
+static void
+run_deferred_init (PhocServer *self)
+{
+  PhocServerPrivate *priv = phoc_server_get_instance_private (self);
+
+  g_clear_handle_id (&priv->deferred_init_id, g_source_remove);
+
+  phoc_desktop_setup_deferred (self->desktop);
+  phoc_server_trace_startup (self, "deferred init done");
+
+  if (G_UNLIKELY (self->debug_flags & PHOC_SERVER_DEBUG_FLAG_STARTUP))
+    log_startup_phases (self);
+  g_clear_pointer (&priv->startup_phases, g_array_unref);
+}
+
+
+static gboolean
+on_deferred_init_timeout (gpointer data)
+{
+  PhocServer *self = PHOC_SERVER (data);
+  PhocServerPrivate *priv = phoc_server_get_instance_private (self);
+
+  g_debug ("No frame rendered yet, running deferred init");
+  priv->deferred_init_id = 0;
+  priv->first_frame_done = TRUE;
+  run_deferred_init (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+
 static gboolean
 phoc_server_initable_init (GInitable    *initable,
                            GCancellable *cancellable,
@@ -209,12 +274,14 @@ phoc_server_initable_init (GInitable    *initable,
                  "Could not create backend");
     return FALSE;
   }
+  phoc_server_trace_startup (self, "backend created");
 
   self->renderer = phoc_renderer_new (self->backend, error);
   if (self->renderer == NULL) {
     return FALSE;
   }
   wlr_renderer = phoc_renderer_get_wlr_renderer (self->renderer);
+  phoc_server_trace_startup (self, "renderer created");
 
   self->data_device_manager = wlr_data_device_manager_create(self->wl_display);
   wlr_renderer_init_wl_display(wlr_renderer, self->wl_display);
@@ -223,6 +290,7 @@ phoc_server_initable_init (GInitable    *initable,
                                            wlr_renderer);
   self->subcompositor = wlr_subcompositor_create (self->wl_display);
 
+  phoc_server_trace_startup (self, "server initialized");
   return TRUE;
 }
 
@@ -257,6 +325,8 @@ phoc_server_finalize (GObject *object)
   PhocServerPrivate *priv = phoc_server_get_instance_private (self);
 
   g_clear_pointer (&priv->dt_compatibles, g_strfreev);
+  g_clear_handle_id (&priv->deferred_init_id, g_source_remove);
+  g_clear_pointer (&priv->startup_phases, g_array_unref);
   g_clear_handle_id (&self->wl_source, g_source_remove);
   g_clear_object (&self->input);
   g_clear_object (&self->desktop);
@@ -289,6 +359,9 @@ phoc_server_init (PhocServer *self)
   PhocServerPrivate *priv = phoc_server_get_instance_private(self);
   g_autoptr (GError) err = NULL;
 
+  priv->startup_phases = g_array_new (FALSE, FALSE, sizeof (PhocStartupPhase));
+  phoc_server_trace_startup (self, "start");
+
   priv->dt_compatibles = gm_device_tree_get_compatibles (NULL, &err);
 }
 
@@ -339,6 +412,8 @@ phoc_server_setup (PhocServer *self, PhocConfig *config,
                    PhocServerFlags flags,
                    PhocServerDebugFlags debug_flags)
 {
+  PhocServerPrivate *priv = phoc_server_get_instance_private (self);
+
   g_assert (!self->inited);
 
   self->config = config;
@@ -347,7 +422,9 @@ phoc_server_setup (PhocServer *self, PhocConfig *config,
   self->mainloop = mainloop;
   self->exit_status = 1;
   self->desktop = phoc_desktop_new (self->config);
+  phoc_server_trace_startup (self, "desktop created");
   self->input = phoc_input_new ();
+  phoc_server_trace_startup (self, "input created");
   self->session = g_strdup (session);
   self->mainloop = mainloop;
 
@@ -366,6 +443,7 @@ phoc_server_setup (PhocServer *self, PhocConfig *config,
     wl_display_destroy(self->wl_display);
     return FALSE;
   }
+  phoc_server_trace_startup (self, "backend started");
 
   g_setenv("WAYLAND_DISPLAY", socket, true);
 #ifdef PHOC_XWAYLAND
@@ -387,6 +465,12 @@ phoc_server_setup (PhocServer *self, PhocConfig *config,
   phoc_wayland_init (self);
   if (self->session)
     phoc_startup_session (self);
+  phoc_server_trace_startup (self, "session started");
+
+  priv->deferred_init_id = g_timeout_add_seconds (PHOC_SERVER_DEFERRED_INIT_TIMEOUT_S,
+                                                  on_deferred_init_timeout,
+                                                  self);
+  g_source_set_name_by_id (priv->deferred_init_id, "[phoc] deferred init");
 
   self->inited = TRUE;
   return TRUE;
@@ -443,3 +527,52 @@ phoc_server_get_compatibles (PhocServer *self)
 
   return (const char * const *)priv->dt_compatibles;
 }
+
+/**
+ * phoc_server_trace_startup:
+ * @self: The server
+ * @phase: A static string describing the startup phase that just completed
+ *
+ * Records the time a startup phase completed. The phases are logged
+ * once the first frame got rendered when running with
+ * `PHOC_DEBUG=startup`. Does nothing after startup.
+ */
+void
+phoc_server_trace_startup (PhocServer *self, const char *phase)
+{
+  PhocServerPrivate *priv;
+  PhocStartupPhase entry;
+
+  g_assert (PHOC_IS_SERVER (self));
+  priv = phoc_server_get_instance_private (self);
+
+  if (priv->startup_phases == NULL)
+    return;
+
+  entry = (PhocStartupPhase) { .phase = phase, .time_us = g_get_monotonic_time () };
+  g_array_append_val (priv->startup_phases, entry);
+}
+
+/**
+ * phoc_server_notify_first_frame:
+ * @self: The server
+ *
+ * Notifies the server that an output rendered a frame. The first call
+ * runs the initialization that isn't needed to get the first frame on
+ * screen. Later calls do nothing.
+ */
+void
+phoc_server_notify_first_frame (PhocServer *self)
+{
+  PhocServerPrivate *priv;
+
+  g_assert (PHOC_IS_SERVER (self));
+  priv = phoc_server_get_instance_private (self);
+
+  if (G_LIKELY (priv->first_frame_done))
+    return;
+
+  priv->first_frame_done = TRUE;
+  phoc_server_trace_startup (self, "first frame");
+  run_deferred_init (self);
+}
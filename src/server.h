@@ -37,6 +37,10 @@ typedef enum _PhocServerDebugFlags {
   PHOC_SERVER_DEBUG_FLAG_LAYER_SHELL        = 1 << 4,
   PHOC_SERVER_DEBUG_FLAG_CUTOUTS            = 1 << 5,
   PHOC_SERVER_DEBUG_FLAG_DISABLE_ANIMATIONS = 1 << 6,
+  PHOC_SERVER_DEBUG_FLAG_ALLOC_STATS        = 1 << 7,
+  PHOC_SERVER_DEBUG_FLAG_STARTUP            = 1 << 8,
+  PHOC_SERVER_DEBUG_FLAG_FRAME_STATS        = 1 << 9,
+  PHOC_SERVER_DEBUG_FLAG_PERF_HUD           = 1 << 10,
 } PhocServerDebugFlags;
 
 /**
@@ -87,5 +91,7 @@ gint               phoc_server_get_session_exit_status (PhocServer *self);
 PhocRenderer      *phoc_server_get_renderer (PhocServer *self);
 PhocDesktop       *phoc_server_get_desktop (PhocServer *self);
 const char *const *phoc_server_get_compatibles (PhocServer *self);
+void               phoc_server_trace_startup (PhocServer *self, const char *phase);
+void               phoc_server_notify_first_frame (PhocServer *self);
 
 G_END_DECLS
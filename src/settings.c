@@ -104,6 +104,22 @@ config_ini_handler (PhocConfig *config, const char *section, const char *name, c
       } else {
         g_critical ("got unknown xwayland value: %s", value);
       }
+    } else if (strcmp (name, "resize-timeout") == 0) {
+      char *end;
+      guint64 timeout = g_ascii_strtoull (value, &end, 10);
+
+      if (*end == '\0' && end != value && timeout <= G_MAXUINT)
+        config->resize_timeout = timeout;
+      else
+        g_critical ("got invalid resize-timeout value: %s", value);
+    } else if (strcmp (name, "xwayland-idle-timeout") == 0) {
+      char *end;
+      guint64 timeout = g_ascii_strtoull (value, &end, 10);
+
+      if (*end == '\0' && end != value && timeout <= G_MAXUINT)
+        config->xwayland_idle_timeout = timeout;
+      else
+        g_critical ("got invalid xwayland-idle-timeout value: %s", value);
     } else {
       g_critical ("got unknown core config: %s", name);
     }
@@ -205,6 +221,7 @@ phoc_config_new_from_keyfile (GKeyFile *keyfile)
 
   config->xwayland = true;
   config->xwayland_lazy = true;
+  config->resize_timeout = PHOC_CONFIG_DEFAULT_RESIZE_TIMEOUT;
   config->keybindings = phoc_keybindings_new ();
 
   sections = g_key_file_get_groups (keyfile, NULL);
@@ -11,6 +11,7 @@
 G_BEGIN_DECLS
 
 #define PHOC_CONFIG_DEFAULT_SEAT_NAME "seat0"
+#define PHOC_CONFIG_DEFAULT_RESIZE_TIMEOUT 200 /* ms */
 
 typedef struct _PhocOutputModeConfig {
   drmModeModeInfo info;
@@ -33,6 +34,8 @@ typedef struct _PhocOutputConfig {
 typedef struct _PhocConfig {
   bool             xwayland;
   bool             xwayland_lazy;
+  guint            resize_timeout;
+  guint            xwayland_idle_timeout;
 
   PhocKeybindings *keybindings;
 
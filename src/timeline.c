@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phoc-timeline"
+
+#include "phoc-config.h"
+#include "timeline.h"
+
+/* The lower bits of an id are the slot, the upper ones a serial so
+ * stale ids of reused slots don't match */
+#define SLOT_BITS 16
+#define SLOT_MASK ((1 << SLOT_BITS) - 1)
+
+typedef struct {
+  PhocAnimatable    *animatable;
+  PhocFrameCallback  callback;
+  gpointer           user_data;
+  GDestroyNotify     notify;
+  guint              id;
+  guint              tick;
+} PhocTimelineEntry;
+
+/**
+ * PhocTimeline:
+ *
+ * The frame callbacks driving the animations on an output.
+ *
+ * Callbacks are kept in an array of slots. Freed slots get reused so
+ * the array stays compact and ids map directly to their slot making
+ * removal O(1). All callbacks of a tick get the same frame time so
+ * animations progress in lockstep with the frames that get displayed.
+ */
+struct _PhocTimeline {
+  GArray *entries;    /* PhocTimelineEntry */
+  GArray *free_slots; /* guint */
+  guint   n_callbacks;
+  guint   serial;
+  /* Incremented on each tick so callbacks added during it can be skipped */
+  guint   tick;
+};
+
+
+static PhocTimelineEntry *
+get_entry (PhocTimeline *self, guint id)
+{
+  guint slot = (id & SLOT_MASK) - 1;
+  PhocTimelineEntry *entry;
+
+  if (id == 0 || slot >= self->entries->len)
+    return NULL;
+
+  entry = &g_array_index (self->entries, PhocTimelineEntry, slot);
+  return entry->id == id ? entry : NULL;
+}
+
+
+PhocTimeline *
+phoc_timeline_new (void)
+{
+  PhocTimeline *self = g_new0 (PhocTimeline, 1);
+
+  self->entries = g_array_new (FALSE, TRUE, sizeof (PhocTimelineEntry));
+  self->free_slots = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  return self;
+}
+
+/**
+ * phoc_timeline_free:
+ * @self: The timeline
+ *
+ * Frees the timeline. The destroy notifiers of all remaining
+ * callbacks are invoked.
+ */
+void
+phoc_timeline_free (PhocTimeline *self)
+{
+  if (self == NULL)
+    return;
+
+  for (guint i = 0; i < self->entries->len; i++) {
+    PhocTimelineEntry *entry = &g_array_index (self->entries, PhocTimelineEntry, i);
+
+    if (entry->id)
+      phoc_timeline_remove (self, entry->id);
+  }
+
+  g_array_unref (self->entries);
+  g_array_unref (self->free_slots);
+  g_free (self);
+}
+
+/**
+ * phoc_timeline_add:
+ * @self: The timeline
+ * @animatable: The animatable the callback belongs to
+ * @callback: The callback to invoke on every frame
+ * @user_data: The user data passed to the callback
+ * @notify: Destroy notifier for the user data
+ *
+ * Adds a frame callback.
+ *
+ * Returns: The id of the frame callback.
+ */
+guint
+phoc_timeline_add (PhocTimeline      *self,
+                   PhocAnimatable    *animatable,
+                   PhocFrameCallback  callback,
+                   gpointer           user_data,
+                   GDestroyNotify     notify)
+{
+  PhocTimelineEntry *entry;
+  guint slot;
+
+  g_assert (self);
+  g_assert (callback);
+
+  if (self->free_slots->len) {
+    slot = g_array_index (self->free_slots, guint, self->free_slots->len - 1);
+    g_array_set_size (self->free_slots, self->free_slots->len - 1);
+  } else {
+    slot = self->entries->len;
+    g_assert (slot < SLOT_MASK);
+    g_array_set_size (self->entries, slot + 1);
+  }
+
+  /* Serial 0 together with slot 0 would give an invalid id */
+  self->serial++;
+  entry = &g_array_index (self->entries, PhocTimelineEntry, slot);
+  *entry = (PhocTimelineEntry) {
+    .animatable = animatable,
+    .callback = callback,
+    .user_data = user_data,
+    .notify = notify,
+    .id = (self->serial << SLOT_BITS) | (slot + 1),
+    .tick = self->tick,
+  };
+  self->n_callbacks++;
+
+  return entry->id;
+}
+
+/**
+ * phoc_timeline_remove:
+ * @self: The timeline
+ * @id: The id of the frame callback to remove
+ *
+ * Removes a frame callback invoking its destroy notifier.
+ *
+ * Returns: %TRUE if the callback was found
+ */
+gboolean
+phoc_timeline_remove (PhocTimeline *self, guint id)
+{
+  PhocTimelineEntry *entry, removed;
+  guint slot;
+
+  g_assert (self);
+
+  entry = get_entry (self, id);
+  if (entry == NULL)
+    return FALSE;
+
+  removed = *entry;
+  *entry = (PhocTimelineEntry) { 0 };
+  slot = (id & SLOT_MASK) - 1;
+  g_array_append_val (self->free_slots, slot);
+  self->n_callbacks--;
+
+  /* Might add or remove callbacks, so notify last */
+  if (removed.notify && removed.user_data)
+    removed.notify (removed.user_data);
+
+  return TRUE;
+}
+
+/**
+ * phoc_timeline_remove_by_animatable:
+ * @self: The timeline
+ * @animatable: The animatable
+ *
+ * Removes all frame callbacks of the given animatable.
+ *
+ * Returns: The number of removed callbacks
+ */
+guint
+phoc_timeline_remove_by_animatable (PhocTimeline *self, PhocAnimatable *animatable)
+{
+  guint n = 0;
+
+  g_assert (self);
+
+  for (guint i = 0; i < self->entries->len; i++) {
+    PhocTimelineEntry *entry = &g_array_index (self->entries, PhocTimelineEntry, i);
+
+    if (entry->id && entry->animatable == animatable)
+      n += phoc_timeline_remove (self, entry->id);
+  }
+
+  return n;
+}
+
+
+guint
+phoc_timeline_get_n_callbacks (PhocTimeline *self)
+{
+  g_assert (self);
+
+  return self->n_callbacks;
+}
+
+/**
+ * phoc_timeline_tick:
+ * @self: The timeline
+ * @frame_time: The time the frame is expected to be presented at in
+ *   microseconds (`CLOCK_MONOTONIC`)
+ *
+ * Invokes all frame callbacks, removing those that return
+ * `G_SOURCE_REMOVE`. Callbacks added during the tick are run on the
+ * next one.
+ */
+void
+phoc_timeline_tick (PhocTimeline *self, gint64 frame_time)
+{
+  guint len;
+
+  g_assert (self);
+
+  self->tick++;
+  len = self->entries->len;
+  for (guint i = 0; i < len; i++) {
+    /* Callbacks can add entries and hence move the array around */
+    PhocTimelineEntry entry = g_array_index (self->entries, PhocTimelineEntry, i);
+
+    /* Unused or added during this tick (possibly into a freed slot) */
+    if (entry.id == 0 || entry.tick == self->tick)
+      continue;
+
+    if (entry.callback (entry.animatable, frame_time, entry.user_data) == G_SOURCE_REMOVE)
+      phoc_timeline_remove (self, entry.id);
+  }
+}
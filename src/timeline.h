@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "animatable.h"
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _PhocTimeline PhocTimeline;
+
+PhocTimeline *phoc_timeline_new                   (void);
+void          phoc_timeline_free                  (PhocTimeline      *self);
+guint         phoc_timeline_add                   (PhocTimeline      *self,
+                                                   PhocAnimatable    *animatable,
+                                                   PhocFrameCallback  callback,
+                                                   gpointer           user_data,
+                                                   GDestroyNotify     notify);
+gboolean      phoc_timeline_remove                (PhocTimeline      *self,
+                                                   guint              id);
+guint         phoc_timeline_remove_by_animatable  (PhocTimeline      *self,
+                                                   PhocAnimatable    *animatable);
+guint         phoc_timeline_get_n_callbacks       (PhocTimeline      *self);
+void          phoc_timeline_tick                  (PhocTimeline      *self,
+                                                   gint64             frame_time);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (PhocTimeline, phoc_timeline_free)
+
+G_END_DECLS
@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phoc-touch-resampler"
+
+#include "phoc-config.h"
+#include "touch-resampler.h"
+
+/* Sample this much before the requested time to have a sample on
+ * both sides most of the time */
+#define RESAMPLE_LATENCY_US     (5 * 1000)
+/* Samples closer than this are too noisy to extrapolate from */
+#define RESAMPLE_MIN_DELTA_US   (2 * 1000)
+/* Samples further apart than this are too old to extrapolate from */
+#define RESAMPLE_MAX_DELTA_US   (20 * 1000)
+/* Never predict further into the future than this */
+#define RESAMPLE_MAX_PREDICTION_US (8 * 1000)
+
+/**
+ * PhocTouchResampler:
+ *
+ * Resamples the positions of a touch sequence to a given point in
+ * time, usually the time the next frame will be presented at.
+ *
+ * Touch screens and displays run at different rates. Applying each
+ * touch position as it arrives makes things that follow the finger
+ * move unevenly as sometimes two and sometimes no position update
+ * ends up in a frame. Resampling interpolates between the last two
+ * positions (or extrapolates a little bit) to get a position that
+ * matches the frame's presentation time instead.
+ */
+
+static void
+lerp (const PhocTouchSample *a, const PhocTouchSample *b, double alpha, double *x, double *y)
+{
+  *x = a->x + (b->x - a->x) * alpha;
+  *y = a->y + (b->y - a->y) * alpha;
+}
+
+/**
+ * phoc_touch_resampler_reset:
+ * @self: The resampler
+ *
+ * Drops all samples. Use this when a new touch sequence starts.
+ */
+void
+phoc_touch_resampler_reset (PhocTouchResampler *self)
+{
+  g_assert (self);
+
+  self->n_samples = 0;
+}
+
+/**
+ * phoc_touch_resampler_add_sample:
+ * @self: The resampler
+ * @time_us: The time of the sample in microseconds (`CLOCK_MONOTONIC`)
+ * @x: The x coordinate
+ * @y: The y coordinate
+ *
+ * Adds a new sample. Samples must be added in chronological
+ * order. Samples with the same timestamp replace the previous one.
+ */
+void
+phoc_touch_resampler_add_sample (PhocTouchResampler *self, gint64 time_us, double x, double y)
+{
+  PhocTouchSample sample = { .time = time_us, .x = x, .y = y };
+
+  g_assert (self);
+
+  if (self->n_samples && time_us <= self->samples[self->n_samples - 1].time) {
+    sample.time = self->samples[self->n_samples - 1].time;
+    self->samples[self->n_samples - 1] = sample;
+    return;
+  }
+
+  if (self->n_samples == G_N_ELEMENTS (self->samples)) {
+    self->samples[0] = self->samples[1];
+    self->n_samples--;
+  }
+
+  self->samples[self->n_samples++] = sample;
+}
+
+/**
+ * phoc_touch_resampler_get_position:
+ * @self: The resampler
+ * @time_us: The time in microseconds (`CLOCK_MONOTONIC`) to get the position for
+ * @x: (out): The resampled x coordinate
+ * @y: (out): The resampled y coordinate
+ *
+ * Gets the position of the touch point at the given time.
+ *
+ * Returns: %TRUE if a position could be determined, %FALSE if there
+ *   are no samples yet.
+ */
+gboolean
+phoc_touch_resampler_get_position (PhocTouchResampler *self, gint64 time_us, double *x, double *y)
+{
+  const PhocTouchSample *prev, *last;
+  gint64 target, delta, prediction;
+
+  g_assert (self);
+  g_assert (x && y);
+
+  if (self->n_samples == 0)
+    return FALSE;
+
+  last = &self->samples[self->n_samples - 1];
+  *x = last->x;
+  *y = last->y;
+
+  if (self->n_samples < 2)
+    return TRUE;
+
+  prev = &self->samples[0];
+  delta = last->time - prev->time;
+  target = time_us - RESAMPLE_LATENCY_US;
+
+  if (target < last->time) {
+    /* Interpolate */
+    if (target <= prev->time) {
+      *x = prev->x;
+      *y = prev->y;
+    } else {
+      lerp (prev, last, (double)(target - prev->time) / delta, x, y);
+    }
+    return TRUE;
+  }
+
+  /* Extrapolate, but only if the samples are recent and reliable */
+  if (delta < RESAMPLE_MIN_DELTA_US || delta > RESAMPLE_MAX_DELTA_US)
+    return TRUE;
+
+  if (target - last->time > RESAMPLE_MAX_DELTA_US)
+    return TRUE;
+
+  prediction = MIN (target - last->time, MIN (delta / 2, RESAMPLE_MAX_PREDICTION_US));
+  lerp (prev, last, 1.0 + (double)prediction / delta, x, y);
+
+  return TRUE;
+}
+
+/**
+ * phoc_touch_resampler_event_time_to_us:
+ * @time_msec: An input event's timestamp in milliseconds
+ * @now_us: The current time in microseconds (`CLOCK_MONOTONIC`)
+ *
+ * Input event timestamps are in milliseconds and wrap around after
+ * 32 bit. Convert them to the microsecond based monotonic clock used
+ * for frame and presentation times.
+ *
+ * Returns: The time of the event in microseconds
+ */
+gint64
+phoc_touch_resampler_event_time_to_us (guint32 time_msec, gint64 now_us)
+{
+  guint32 now_msec = (guint32)(now_us / 1000);
+  gint32 age_msec = (gint32)(now_msec - time_msec);
+
+  return (now_us / 1000 - age_msec) * 1000;
+}
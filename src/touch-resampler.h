@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _PhocTouchSample {
+  gint64 time;
+  double x;
+  double y;
+} PhocTouchSample;
+
+typedef struct _PhocTouchResampler {
+  PhocTouchSample samples[2];
+  guint           n_samples;
+} PhocTouchResampler;
+
+void     phoc_touch_resampler_reset        (PhocTouchResampler *self);
+void     phoc_touch_resampler_add_sample   (PhocTouchResampler *self,
+                                            gint64              time_us,
+                                            double              x,
+                                            double              y);
+gboolean phoc_touch_resampler_get_position (PhocTouchResampler *self,
+                                            gint64              time_us,
+                                            double             *x,
+                                            double             *y);
+gint64   phoc_touch_resampler_event_time_to_us (guint32 time_msec, gint64 now_us);
+
+G_END_DECLS
@@ -0,0 +1,381 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phoc-transaction"
+
+#include "phoc-config.h"
+
+#include "transaction.h"
+
+enum {
+  PROP_0,
+  PROP_TIMEOUT,
+  PROP_LAST_PROP
+};
+static GParamSpec *props[PROP_LAST_PROP];
+
+enum {
+  DONE,
+  N_SIGNALS
+};
+static guint signals[N_SIGNALS];
+
+/**
+ * PhocTransaction:
+ *
+ * Groups the configures sent to several views so their new geometry
+ * can be shown in a single frame.
+ *
+ * Configures sent between [method@Transaction.begin] and
+ * [method@Transaction.commit] are added via
+ * [method@Transaction.add_configure]. Once committed the transaction
+ * is pending until every view committed a buffer for its configure
+ * or the timeout expired. Then [signal@Transaction::done] is emitted.
+ */
+struct _PhocTransaction {
+  GObject     parent;
+
+  guint       timeout_ms;
+  guint       timeout_id;
+  guint       depth;
+  gboolean    done;
+
+  /* PhocView → serial of the last configure */
+  GHashTable *views;
+};
+
+G_DEFINE_TYPE (PhocTransaction, phoc_transaction, G_TYPE_OBJECT)
+
+
+static void
+emit_done (PhocTransaction *self)
+{
+  self->done = TRUE;
+  g_clear_handle_id (&self->timeout_id, g_source_remove);
+
+  /* Handlers usually drop their reference */
+  g_object_ref (self);
+  g_signal_emit (self, signals[DONE], 0);
+  g_object_unref (self);
+}
+
+
+static void
+check_done (PhocTransaction *self)
+{
+  if (self->done || self->depth)
+    return;
+
+  if (g_hash_table_size (self->views))
+    return;
+
+  emit_done (self);
+}
+
+
+static void
+on_view_finalized (gpointer data, GObject *where_the_object_was)
+{
+  PhocTransaction *self = PHOC_TRANSACTION (data);
+
+  g_hash_table_remove (self->views, where_the_object_was);
+  check_done (self);
+}
+
+
+static gboolean
+remove_view (PhocTransaction *self, PhocView *view)
+{
+  if (!g_hash_table_remove (self->views, view))
+    return FALSE;
+
+  g_object_weak_unref (G_OBJECT (view), on_view_finalized, self);
+  return TRUE;
+}
+
+
+static gboolean
+on_timeout (gpointer data)
+{
+  PhocTransaction *self = PHOC_TRANSACTION (data);
+
+  g_debug ("Transaction %p timed out waiting for %u views",
+           self, g_hash_table_size (self->views));
+
+  self->timeout_id = 0;
+  emit_done (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+phoc_transaction_set_property (GObject      *object,
+                               guint         property_id,
+                               const GValue *value,
+                               GParamSpec   *pspec)
+{
+  PhocTransaction *self = PHOC_TRANSACTION (object);
+
+  switch (property_id) {
+  case PROP_TIMEOUT:
+    self->timeout_ms = g_value_get_uint (value);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+phoc_transaction_get_property (GObject    *object,
+                               guint       property_id,
+                               GValue     *value,
+                               GParamSpec *pspec)
+{
+  PhocTransaction *self = PHOC_TRANSACTION (object);
+
+  switch (property_id) {
+  case PROP_TIMEOUT:
+    g_value_set_uint (value, self->timeout_ms);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+phoc_transaction_finalize (GObject *object)
+{
+  PhocTransaction *self = PHOC_TRANSACTION (object);
+  GHashTableIter iter;
+  gpointer view;
+
+  g_clear_handle_id (&self->timeout_id, g_source_remove);
+
+  g_hash_table_iter_init (&iter, self->views);
+  while (g_hash_table_iter_next (&iter, &view, NULL))
+    g_object_weak_unref (G_OBJECT (view), on_view_finalized, self);
+  g_clear_pointer (&self->views, g_hash_table_destroy);
+
+  G_OBJECT_CLASS (phoc_transaction_parent_class)->finalize (object);
+}
+
+
+static void
+phoc_transaction_class_init (PhocTransactionClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->get_property = phoc_transaction_get_property;
+  object_class->set_property = phoc_transaction_set_property;
+  object_class->finalize = phoc_transaction_finalize;
+
+  /**
+   * PhocTransaction:timeout:
+   *
+   * How long to wait in milliseconds for views to commit a buffer
+   * for their configure once the transaction got committed.
+   */
+  props[PROP_TIMEOUT] =
+    g_param_spec_uint ("timeout", "", "",
+                       0, G_MAXUINT, 100,
+                       G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
+
+  /**
+   * PhocTransaction::done:
+   *
+   * Emitted once all views committed a buffer for their configure or
+   * the timeout expired. The transaction can't be used afterwards.
+   */
+  signals[DONE] = g_signal_new ("done",
+                                G_TYPE_FROM_CLASS (klass),
+                                G_SIGNAL_RUN_LAST,
+                                0, NULL, NULL, NULL,
+                                G_TYPE_NONE, 0);
+}
+
+
+static void
+phoc_transaction_init (PhocTransaction *self)
+{
+  self->views = g_hash_table_new (g_direct_hash, g_direct_equal);
+}
+
+
+PhocTransaction *
+phoc_transaction_new (guint timeout_ms)
+{
+  return g_object_new (PHOC_TYPE_TRANSACTION, "timeout", timeout_ms, NULL);
+}
+
+/**
+ * phoc_transaction_begin:
+ * @self: The transaction
+ *
+ * Starts collecting configures. Calls can be nested, each needs to be
+ * balanced by [method@Transaction.commit].
+ */
+void
+phoc_transaction_begin (PhocTransaction *self)
+{
+  g_assert (PHOC_IS_TRANSACTION (self));
+  g_return_if_fail (!self->done);
+
+  self->depth++;
+}
+
+/**
+ * phoc_transaction_commit:
+ * @self: The transaction
+ *
+ * Stops collecting configures. If there are no views to wait for
+ * [signal@Transaction::done] is emitted right away, otherwise the
+ * timeout is started.
+ */
+void
+phoc_transaction_commit (PhocTransaction *self)
+{
+  g_assert (PHOC_IS_TRANSACTION (self));
+  g_return_if_fail (self->depth > 0);
+
+  self->depth--;
+  if (self->depth)
+    return;
+
+  if (g_hash_table_size (self->views) && self->timeout_id == 0)
+    self->timeout_id = g_timeout_add (self->timeout_ms, on_timeout, self);
+
+  check_done (self);
+}
+
+/**
+ * phoc_transaction_add_configure:
+ * @self: The transaction
+ * @view: The view the configure was sent to
+ * @serial: The configure's serial
+ *
+ * Makes the transaction wait for @view to commit a buffer for the
+ * configure with the given @serial.
+ */
+void
+phoc_transaction_add_configure (PhocTransaction *self, PhocView *view, guint32 serial)
+{
+  g_assert (PHOC_IS_TRANSACTION (self));
+  g_return_if_fail (self->depth > 0);
+
+  if (!g_hash_table_contains (self->views, view))
+    g_object_weak_ref (G_OBJECT (view), on_view_finalized, self);
+
+  g_hash_table_insert (self->views, view, GUINT_TO_POINTER (serial));
+}
+
+/**
+ * phoc_transaction_notify_commit:
+ * @self: The transaction
+ * @view: The view that committed
+ * @serial: The serial of the configure the commit is for
+ *
+ * Notifies the transaction that @view committed a buffer. Once all
+ * views committed a buffer for their configure the transaction is
+ * done.
+ */
+void
+phoc_transaction_notify_commit (PhocTransaction *self, PhocView *view, guint32 serial)
+{
+  gpointer pending_serial;
+
+  g_assert (PHOC_IS_TRANSACTION (self));
+
+  if (!g_hash_table_lookup_extended (self->views, view, NULL, &pending_serial))
+    return;
+
+  /* Serials wrap around */
+  if ((gint32) (serial - GPOINTER_TO_UINT (pending_serial)) < 0)
+    return;
+
+  remove_view (self, view);
+  check_done (self);
+}
+
+/**
+ * phoc_transaction_remove_view:
+ * @self: The transaction
+ * @view: The view
+ *
+ * Stops waiting for @view, e.g. because it got unmapped.
+ */
+void
+phoc_transaction_remove_view (PhocTransaction *self, PhocView *view)
+{
+  g_assert (PHOC_IS_TRANSACTION (self));
+
+  if (remove_view (self, view))
+    check_done (self);
+}
+
+/**
+ * phoc_transaction_is_collecting:
+ * @self: The transaction
+ *
+ * Returns: %TRUE if configures sent now should be added to the transaction
+ */
+gboolean
+phoc_transaction_is_collecting (PhocTransaction *self)
+{
+  g_assert (PHOC_IS_TRANSACTION (self));
+
+  return self->depth > 0;
+}
+
+/**
+ * phoc_transaction_is_pending:
+ * @self: The transaction
+ *
+ * Returns: %TRUE if the transaction got committed but views still need
+ *   to commit buffers for their configures.
+ */
+gboolean
+phoc_transaction_is_pending (PhocTransaction *self)
+{
+  g_assert (PHOC_IS_TRANSACTION (self));
+
+  return !self->done && self->depth == 0 && g_hash_table_size (self->views);
+}
+
+/**
+ * phoc_transaction_get_n_views:
+ * @self: The transaction
+ *
+ * Returns: The number of views the transaction waits for
+ */
+guint
+phoc_transaction_get_n_views (PhocTransaction *self)
+{
+  g_assert (PHOC_IS_TRANSACTION (self));
+
+  return g_hash_table_size (self->views);
+}
+
+/**
+ * phoc_transaction_get_views:
+ * @self: The transaction
+ *
+ * Returns: (transfer container) (element-type PhocView): The views the
+ *   transaction waits for
+ */
+GList *
+phoc_transaction_get_views (PhocTransaction *self)
+{
+  g_assert (PHOC_IS_TRANSACTION (self));
+
+  return g_hash_table_get_keys (self->views);
+}
@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "view.h"
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define PHOC_TYPE_TRANSACTION (phoc_transaction_get_type ())
+
+G_DECLARE_FINAL_TYPE (PhocTransaction, phoc_transaction, PHOC, TRANSACTION, GObject)
+
+PhocTransaction *phoc_transaction_new              (guint            timeout_ms);
+void             phoc_transaction_begin            (PhocTransaction *self);
+void             phoc_transaction_commit           (PhocTransaction *self);
+void             phoc_transaction_add_configure    (PhocTransaction *self,
+                                                    PhocView        *view,
+                                                    guint32          serial);
+void             phoc_transaction_notify_commit    (PhocTransaction *self,
+                                                    PhocView        *view,
+                                                    guint32          serial);
+void             phoc_transaction_remove_view      (PhocTransaction *self,
+                                                    PhocView        *view);
+gboolean         phoc_transaction_is_collecting    (PhocTransaction *self);
+gboolean         phoc_transaction_is_pending       (PhocTransaction *self);
+guint            phoc_transaction_get_n_views      (PhocTransaction *self);
+GList           *phoc_transaction_get_views        (PhocTransaction *self);
+
+G_END_DECLS
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phoc-velocity-tracker"
+
+#include "phoc-config.h"
+#include "velocity-tracker.h"
+
+/* Only consider points this recent for the velocity */
+#define VELOCITY_HORIZON_MS 100
+/* A pause this long means the pointer stopped, older points don't count */
+#define VELOCITY_ASSUME_STOPPED_MS 40
+
+/**
+ * PhocVelocityTracker:
+ *
+ * Estimates the velocity of a pointer or touch point from its recent
+ * positions.
+ *
+ * Rather than only looking at the first and last point the velocity
+ * is the slope of a least squares fit over the points in a short
+ * time window. This makes the result robust against the jitter of
+ * individual events and independent of the input device's event
+ * rate.
+ */
+
+static PhocVelocitySample *
+get_sample (PhocVelocityTracker *self, guint age)
+{
+  guint index = (self->head + PHOC_VELOCITY_TRACKER_N_SAMPLES - age) % PHOC_VELOCITY_TRACKER_N_SAMPLES;
+
+  return &self->samples[index];
+}
+
+/**
+ * phoc_velocity_tracker_reset:
+ * @self: The velocity tracker
+ *
+ * Drops all points. Use this when a new gesture starts.
+ */
+void
+phoc_velocity_tracker_reset (PhocVelocityTracker *self)
+{
+  g_assert (self);
+
+  self->head = 0;
+  self->n_samples = 0;
+}
+
+/**
+ * phoc_velocity_tracker_add_point:
+ * @self: The velocity tracker
+ * @time_msec: The event time in milliseconds
+ * @x: The x coordinate
+ * @y: The y coordinate
+ *
+ * Adds a new point. Points must be added in chronological order,
+ * a point with the same timestamp as the previous one replaces it.
+ */
+void
+phoc_velocity_tracker_add_point (PhocVelocityTracker *self, guint32 time_msec, double x, double y)
+{
+  PhocVelocitySample *sample;
+
+  g_assert (self);
+
+  if (self->n_samples && get_sample (self, 0)->time == time_msec) {
+    sample = get_sample (self, 0);
+  } else {
+    if (self->n_samples)
+      self->head = (self->head + 1) % PHOC_VELOCITY_TRACKER_N_SAMPLES;
+    self->n_samples = MIN (self->n_samples + 1, PHOC_VELOCITY_TRACKER_N_SAMPLES);
+    sample = get_sample (self, 0);
+  }
+
+  sample->time = time_msec;
+  sample->x = x;
+  sample->y = y;
+}
+
+/**
+ * phoc_velocity_tracker_get_velocity:
+ * @self: The velocity tracker
+ * @velocity_x: (out) (optional): The velocity along the x axis in pixels/sec
+ * @velocity_y: (out) (optional): The velocity along the y axis in pixels/sec
+ *
+ * Estimates the current velocity from the most recent points.
+ *
+ * Returns: %TRUE if there were enough points to estimate a velocity.
+ *   Otherwise the velocity is set to `0`.
+ */
+gboolean
+phoc_velocity_tracker_get_velocity (PhocVelocityTracker *self, double *velocity_x, double *velocity_y)
+{
+  PhocVelocitySample *newest;
+  double mean_t = 0, mean_x = 0, mean_y = 0;
+  double var_t = 0, cov_x = 0, cov_y = 0;
+  double t[PHOC_VELOCITY_TRACKER_N_SAMPLES];
+  guint n;
+
+  g_assert (self);
+
+  if (velocity_x)
+    *velocity_x = 0;
+  if (velocity_y)
+    *velocity_y = 0;
+
+  if (self->n_samples < 2)
+    return FALSE;
+
+  /* Time relative to the newest point, this also takes care of the
+   * 32bit event time wrapping around */
+  newest = get_sample (self, 0);
+  t[0] = 0;
+  for (n = 1; n < self->n_samples; n++) {
+    gint32 age = (gint32)(newest->time - get_sample (self, n)->time);
+    gint32 gap = (gint32)(get_sample (self, n - 1)->time - get_sample (self, n)->time);
+
+    if (age > VELOCITY_HORIZON_MS || gap > VELOCITY_ASSUME_STOPPED_MS)
+      break;
+
+    t[n] = -age;
+  }
+
+  if (n < 2)
+    return FALSE;
+
+  for (guint i = 0; i < n; i++) {
+    mean_t += t[i];
+    mean_x += get_sample (self, i)->x;
+    mean_y += get_sample (self, i)->y;
+  }
+  mean_t /= n;
+  mean_x /= n;
+  mean_y /= n;
+
+  for (guint i = 0; i < n; i++) {
+    double dt = t[i] - mean_t;
+
+    var_t += dt * dt;
+    cov_x += dt * (get_sample (self, i)->x - mean_x);
+    cov_y += dt * (get_sample (self, i)->y - mean_y);
+  }
+
+  if (var_t <= 0)
+    return FALSE;
+
+  /* Slope of the least squares line is in pixels/msec */
+  if (velocity_x)
+    *velocity_x = cov_x / var_t * 1000;
+  if (velocity_y)
+    *velocity_y = cov_y / var_t * 1000;
+
+  return TRUE;
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#define PHOC_VELOCITY_TRACKER_N_SAMPLES 20
+
+typedef struct _PhocVelocitySample {
+  guint32 time;
+  double  x;
+  double  y;
+} PhocVelocitySample;
+
+typedef struct _PhocVelocityTracker {
+  PhocVelocitySample samples[PHOC_VELOCITY_TRACKER_N_SAMPLES];
+  guint              head;
+  guint              n_samples;
+} PhocVelocityTracker;
+
+void     phoc_velocity_tracker_reset        (PhocVelocityTracker *self);
+void     phoc_velocity_tracker_add_point    (PhocVelocityTracker *self,
+                                             guint32              time_msec,
+                                             double               x,
+                                             double               y);
+gboolean phoc_velocity_tracker_get_velocity (PhocVelocityTracker *self,
+                                             double              *velocity_x,
+                                             double              *velocity_y);
+
+G_END_DECLS
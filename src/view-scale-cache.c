@@ -0,0 +1,283 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phoc-view-scale-cache"
+
+#include "phoc-config.h"
+
+#include "render-private.h"
+#include "view-scale-cache.h"
+
+#include <drm_fourcc.h>
+#include <wlr/render/allocator.h>
+#include <wlr/render/drm_format_set.h>
+#include <wlr/types/wlr_buffer.h>
+#include <wlr/types/wlr_matrix.h>
+#include <wlr/util/region.h>
+
+/**
+ * PhocViewScaleCache:
+ *
+ * A texture holding a view's surface tree already scaled to the size
+ * it's shown on the output.
+ *
+ * Views scaled to fit the output would otherwise have each of their
+ * (possibly huge) buffers sampled down on every frame. With the cache
+ * this only happens for the regions clients damaged and rendering the
+ * view becomes a 1:1 copy.
+ *
+ * The cache covers the extents of the surface tree, in surface
+ * coordinates. Damage is tracked in cache buffer coordinates.
+ */
+struct _PhocViewScaleCache {
+  struct wlr_buffer  *buffer;
+  struct wlr_texture *texture;
+  struct wlr_box      extents;
+  int                 width, height;
+
+  pixman_region32_t   damage;
+};
+
+typedef struct {
+  struct wlr_renderer *wlr_renderer;
+  PhocViewScaleCache  *cache;
+} PhocViewScaleCacheRenderData;
+
+
+static void
+get_scale (PhocViewScaleCache *self, float *scale_x, float *scale_y)
+{
+  *scale_x = self->width / (float)self->extents.width;
+  *scale_y = self->height / (float)self->extents.height;
+}
+
+
+static void
+render_iterator (struct wlr_surface *surface, int sx, int sy, void *_data)
+{
+  PhocViewScaleCacheRenderData *data = _data;
+  PhocViewScaleCache *self = data->cache;
+  struct wlr_texture *texture = wlr_surface_get_texture (surface);
+  struct wlr_fbox src_box;
+  float proj[9], mat[9];
+  float scale_x, scale_y;
+
+  if (texture == NULL)
+    return;
+
+  get_scale (self, &scale_x, &scale_y);
+  wlr_matrix_identity (proj);
+  wlr_matrix_scale (proj, scale_x, scale_y);
+  wlr_matrix_translate (proj, -self->extents.x, -self->extents.y);
+
+  wlr_surface_get_buffer_source_box (surface, &src_box);
+
+  struct wlr_box dst_box = {
+    .x = sx,
+    .y = sy,
+    .width = surface->current.width,
+    .height = surface->current.height,
+  };
+
+  wlr_matrix_project_box (mat, &dst_box,
+                          wlr_output_transform_invert (surface->current.transform), 0, proj);
+  wlr_render_subtexture_with_matrix (data->wlr_renderer, texture, &src_box, mat, 1.0);
+}
+
+
+static gboolean
+ensure_buffer (PhocViewScaleCache *self, PhocRenderer *renderer, int width, int height)
+{
+  struct wlr_allocator *wlr_allocator = phoc_renderer_get_wlr_allocator (renderer);
+  struct wlr_drm_format_set fmt_set = {};
+  const struct wlr_drm_format *fmt;
+
+  if (self->buffer && self->width == width && self->height == height)
+    return TRUE;
+
+  g_clear_pointer (&self->texture, wlr_texture_destroy);
+  g_clear_pointer (&self->buffer, wlr_buffer_drop);
+
+  wlr_drm_format_set_add (&fmt_set, DRM_FORMAT_ARGB8888, DRM_FORMAT_MOD_INVALID);
+  fmt = wlr_drm_format_set_get (&fmt_set, DRM_FORMAT_ARGB8888);
+  self->buffer = wlr_allocator_create_buffer (wlr_allocator, width, height, fmt);
+  wlr_drm_format_set_finish (&fmt_set);
+  if (self->buffer == NULL)
+    return FALSE;
+
+  self->width = width;
+  self->height = height;
+  return TRUE;
+}
+
+
+PhocViewScaleCache *
+phoc_view_scale_cache_new (void)
+{
+  PhocViewScaleCache *self = g_new0 (PhocViewScaleCache, 1);
+
+  pixman_region32_init (&self->damage);
+
+  return self;
+}
+
+
+void
+phoc_view_scale_cache_free (PhocViewScaleCache *self)
+{
+  g_clear_pointer (&self->texture, wlr_texture_destroy);
+  g_clear_pointer (&self->buffer, wlr_buffer_drop);
+  pixman_region32_fini (&self->damage);
+
+  g_free (self);
+}
+
+/**
+ * phoc_view_scale_cache_add_surface_damage:
+ * @self: The cache
+ * @surface: A surface of the cached surface tree
+ * @sx: The surface's x position relative to the tree's root
+ * @sy: The surface's y position relative to the tree's root
+ *
+ * Adds the surface's damage from its last commit to the regions that
+ * need to be updated.
+ */
+void
+phoc_view_scale_cache_add_surface_damage (PhocViewScaleCache *self,
+                                          struct wlr_surface *surface,
+                                          int                 sx,
+                                          int                 sy)
+{
+  pixman_region32_t damage;
+  float scale_x, scale_y;
+
+  /* Updated as a whole anyway */
+  if (self->buffer == NULL)
+    return;
+
+  pixman_region32_init (&damage);
+  wlr_surface_get_effective_damage (surface, &damage);
+  pixman_region32_translate (&damage, sx - self->extents.x, sy - self->extents.y);
+  get_scale (self, &scale_x, &scale_y);
+  wlr_region_scale_xy (&damage, &damage, scale_x, scale_y);
+  /* Linear filtering samples neighboring pixels */
+  wlr_region_expand (&damage, &damage, 1);
+  pixman_region32_union (&self->damage, &self->damage, &damage);
+  pixman_region32_fini (&damage);
+}
+
+/**
+ * phoc_view_scale_cache_damage_whole:
+ * @self: The cache
+ *
+ * Makes the next update render the whole surface tree again.
+ */
+void
+phoc_view_scale_cache_damage_whole (PhocViewScaleCache *self)
+{
+  pixman_region32_union_rect (&self->damage, &self->damage, 0, 0, self->width, self->height);
+}
+
+/**
+ * phoc_view_scale_cache_update:
+ * @self: The cache
+ * @renderer: The renderer
+ * @root: The root of the surface tree to cache
+ * @extents: The extents of the surface tree in surface coordinates
+ * @width: The width the surface tree is shown at on the output
+ * @height: The height the surface tree is shown at on the output
+ *
+ * Renders the damaged regions of the surface tree into the cache. If
+ * the extents or the size changed the whole tree is rendered. Must not
+ * be called while rendering an output.
+ *
+ * Returns: %TRUE if the cache is up to date
+ */
+gboolean
+phoc_view_scale_cache_update (PhocViewScaleCache   *self,
+                              PhocRenderer         *renderer,
+                              struct wlr_surface   *root,
+                              const struct wlr_box *extents,
+                              int                   width,
+                              int                   height)
+{
+  struct wlr_renderer *wlr_renderer = phoc_renderer_get_wlr_renderer (renderer);
+  PhocViewScaleCacheRenderData data = { .wlr_renderer = wlr_renderer, .cache = self };
+  pixman_box32_t *rects;
+  int nrects;
+
+  g_return_val_if_fail (width > 0 && height > 0, FALSE);
+  g_return_val_if_fail (!wlr_box_empty (extents), FALSE);
+
+  if (!ensure_buffer (self, renderer, width, height))
+    return FALSE;
+
+  if (self->texture == NULL || !wlr_box_equal (&self->extents, extents)) {
+    self->extents = *extents;
+    phoc_view_scale_cache_damage_whole (self);
+  }
+
+  pixman_region32_intersect_rect (&self->damage, &self->damage, 0, 0, width, height);
+  if (!pixman_region32_not_empty (&self->damage))
+    return TRUE;
+
+  if (!wlr_renderer_begin_with_buffer (wlr_renderer, self->buffer))
+    return FALSE;
+
+  rects = pixman_region32_rectangles (&self->damage, &nrects);
+  for (int i = 0; i < nrects; i++) {
+    struct wlr_box box = {
+      .x = rects[i].x1,
+      .y = rects[i].y1,
+      .width = rects[i].x2 - rects[i].x1,
+      .height = rects[i].y2 - rects[i].y1,
+    };
+
+    wlr_renderer_scissor (wlr_renderer, &box);
+    wlr_renderer_clear (wlr_renderer, (float[]){ 0.0f, 0.0f, 0.0f, 0.0f });
+    wlr_surface_for_each_surface (root, render_iterator, &data);
+  }
+  wlr_renderer_scissor (wlr_renderer, NULL);
+  wlr_renderer_end (wlr_renderer);
+  pixman_region32_clear (&self->damage);
+
+  /* Textures might copy the buffer's content so get a fresh one */
+  g_clear_pointer (&self->texture, wlr_texture_destroy);
+  self->texture = wlr_texture_from_buffer (wlr_renderer, self->buffer);
+
+  return self->texture != NULL;
+}
+
+/**
+ * phoc_view_scale_cache_get_texture:
+ * @self: The cache
+ * @extents: The extents of the surface tree in surface coordinates
+ * @width: The width the surface tree is shown at on the output
+ * @height: The height the surface tree is shown at on the output
+ *
+ * Gets the cached surface tree if it matches the given extents and
+ * size.
+ *
+ * Returns: (transfer none) (nullable): The cached texture
+ */
+struct wlr_texture *
+phoc_view_scale_cache_get_texture (PhocViewScaleCache   *self,
+                                   const struct wlr_box *extents,
+                                   int                   width,
+                                   int                   height)
+{
+  if (self->texture == NULL)
+    return NULL;
+
+  if (self->width != width || self->height != height || !wlr_box_equal (&self->extents, extents))
+    return NULL;
+
+  /* Not fully updated yet */
+  if (pixman_region32_not_empty (&self->damage))
+    return NULL;
+
+  return self->texture;
+}
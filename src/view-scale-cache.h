@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "render.h"
+
+#include <glib.h>
+#include <wlr/types/wlr_compositor.h>
+#include <wlr/util/box.h>
+
+G_BEGIN_DECLS
+
+typedef struct _PhocViewScaleCache PhocViewScaleCache;
+
+PhocViewScaleCache *phoc_view_scale_cache_new                (void);
+void                phoc_view_scale_cache_free               (PhocViewScaleCache   *self);
+void                phoc_view_scale_cache_add_surface_damage (PhocViewScaleCache   *self,
+                                                              struct wlr_surface   *surface,
+                                                              int                   sx,
+                                                              int                   sy);
+void                phoc_view_scale_cache_damage_whole       (PhocViewScaleCache   *self);
+gboolean            phoc_view_scale_cache_update             (PhocViewScaleCache   *self,
+                                                              PhocRenderer         *renderer,
+                                                              struct wlr_surface   *root,
+                                                              const struct wlr_box *extents,
+                                                              int                   width,
+                                                              int                   height);
+struct wlr_texture *phoc_view_scale_cache_get_texture        (PhocViewScaleCache   *self,
+                                                              const struct wlr_box *extents,
+                                                              int                   width,
+                                                              int                   height);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (PhocViewScaleCache, phoc_view_scale_cache_free)
+
+G_END_DECLS
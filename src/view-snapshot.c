@@ -0,0 +1,461 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phoc-view-snapshot"
+
+#include "phoc-config.h"
+
+#include "desktop.h"
+#include "server.h"
+#include "view-snapshot.h"
+
+#include <wlr/types/wlr_output_layout.h>
+
+enum {
+  PROP_0,
+  PROP_OUTPUT,
+  PROP_ALPHA,
+  PROP_PROGRESS,
+  PROP_LAST_PROP
+};
+static GParamSpec *props[PROP_LAST_PROP];
+
+/**
+ * PhocViewSnapshot:
+ *
+ * A snapshot of a view's content that can be animated independently
+ * of the view. This allows to animate views without waiting for the
+ * client to redraw and to keep animating once the client destroyed
+ * its buffers, e.g. when closing a window.
+ *
+ * The snapshot morphs from its initial box to a target box while
+ * fading out.
+ */
+struct _PhocViewSnapshot {
+  GObject             parent;
+
+  PhocOutput         *output;
+  struct wlr_texture *texture;
+  struct wlr_box      box;
+  struct wlr_box      target_box;
+
+  float               alpha;
+  float               progress;
+  PhocTimedAnimation *animation;
+};
+
+static void phoc_animatable_interface_init (PhocAnimatableInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (PhocViewSnapshot, phoc_view_snapshot, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (PHOC_TYPE_ANIMATABLE,
+                                                phoc_animatable_interface_init))
+
+static guint
+phoc_view_snapshot_add_frame_callback (PhocAnimatable   *iface,
+                                       PhocFrameCallback callback,
+                                       gpointer          user_data,
+                                       GDestroyNotify    notify)
+{
+  PhocViewSnapshot *self = PHOC_VIEW_SNAPSHOT (iface);
+
+  g_return_val_if_fail (self->output, 0);
+
+  return phoc_output_add_frame_callback (self->output, iface, callback, user_data, notify);
+}
+
+
+static void
+phoc_view_snapshot_remove_frame_callback (PhocAnimatable *iface, guint id)
+{
+  PhocViewSnapshot *self = PHOC_VIEW_SNAPSHOT (iface);
+
+  /* The output's frame callbacks are gone with the output */
+  if (self->output == NULL)
+    return;
+
+  phoc_output_remove_frame_callback (self->output, id);
+}
+
+
+/**
+ * phoc_view_snapshot_damage:
+ * @self: The snapshot
+ *
+ * Damages the area currently covered by the snapshot.
+ */
+void
+phoc_view_snapshot_damage (PhocViewSnapshot *self)
+{
+  struct wlr_box box;
+
+  if (phoc_view_snapshot_get_output_box (self, &box))
+    wlr_output_damage_add_box (self->output->damage, &box);
+}
+
+
+static void
+set_output (PhocViewSnapshot *self, PhocOutput *output)
+{
+  g_assert (output == NULL || PHOC_IS_OUTPUT (output));
+
+  if (self->output == output)
+    return;
+
+  g_set_weak_pointer (&self->output, output);
+}
+
+
+static void
+set_alpha (PhocViewSnapshot *self, float alpha)
+{
+  self->alpha = alpha;
+  phoc_view_snapshot_damage (self);
+}
+
+
+static void
+set_progress (PhocViewSnapshot *self, float progress)
+{
+  /* Damage where we were and where we are now */
+  phoc_view_snapshot_damage (self);
+  self->progress = progress;
+  phoc_view_snapshot_damage (self);
+}
+
+
+static void
+phoc_view_snapshot_set_property (GObject      *object,
+                                 guint         property_id,
+                                 const GValue *value,
+                                 GParamSpec   *pspec)
+{
+  PhocViewSnapshot *self = PHOC_VIEW_SNAPSHOT (object);
+
+  switch (property_id) {
+  case PROP_OUTPUT:
+    set_output (self, g_value_get_object (value));
+    break;
+  case PROP_ALPHA:
+    set_alpha (self, g_value_get_float (value));
+    break;
+  case PROP_PROGRESS:
+    set_progress (self, g_value_get_float (value));
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+phoc_view_snapshot_get_property (GObject    *object,
+                                 guint       property_id,
+                                 GValue     *value,
+                                 GParamSpec *pspec)
+{
+  PhocViewSnapshot *self = PHOC_VIEW_SNAPSHOT (object);
+
+  switch (property_id) {
+  case PROP_OUTPUT:
+    g_value_set_object (value, self->output);
+    break;
+  case PROP_ALPHA:
+    g_value_set_float (value, self->alpha);
+    break;
+  case PROP_PROGRESS:
+    g_value_set_float (value, self->progress);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static gboolean
+remove_from_output (gpointer data)
+{
+  PhocViewSnapshot *self = PHOC_VIEW_SNAPSHOT (data);
+
+  if (self->output)
+    phoc_output_remove_view_snapshot (self->output, self);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+on_animation_done (PhocViewSnapshot *self)
+{
+  /* Removing the snapshot might drop its last reference and with it
+   * the animation that is still emitting, so do it once that's done */
+  g_idle_add_full (G_PRIORITY_DEFAULT, remove_from_output,
+                   g_object_ref (self), g_object_unref);
+}
+
+
+static void
+phoc_view_snapshot_dispose (GObject *object)
+{
+  PhocViewSnapshot *self = PHOC_VIEW_SNAPSHOT (object);
+
+  if (self->animation) {
+    g_signal_handlers_disconnect_by_data (self->animation, self);
+    g_clear_object (&self->animation);
+  }
+
+  G_OBJECT_CLASS (phoc_view_snapshot_parent_class)->dispose (object);
+}
+
+
+static void
+phoc_view_snapshot_finalize (GObject *object)
+{
+  PhocViewSnapshot *self = PHOC_VIEW_SNAPSHOT (object);
+
+  set_output (self, NULL);
+  g_clear_pointer (&self->texture, wlr_texture_destroy);
+
+  G_OBJECT_CLASS (phoc_view_snapshot_parent_class)->finalize (object);
+}
+
+
+static void
+phoc_animatable_interface_init (PhocAnimatableInterface *iface)
+{
+  iface->add_frame_callback = phoc_view_snapshot_add_frame_callback;
+  iface->remove_frame_callback = phoc_view_snapshot_remove_frame_callback;
+}
+
+
+static void
+phoc_view_snapshot_class_init (PhocViewSnapshotClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->get_property = phoc_view_snapshot_get_property;
+  object_class->set_property = phoc_view_snapshot_set_property;
+  object_class->dispose = phoc_view_snapshot_dispose;
+  object_class->finalize = phoc_view_snapshot_finalize;
+
+  /**
+   * PhocViewSnapshot:output:
+   *
+   * The output the snapshot is shown on.
+   */
+  props[PROP_OUTPUT] =
+    g_param_spec_object ("output", "", "",
+                         PHOC_TYPE_OUTPUT,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+  /**
+   * PhocViewSnapshot:alpha:
+   *
+   * The current transparency of the snapshot.
+   */
+  props[PROP_ALPHA] =
+    g_param_spec_float ("alpha", "", "",
+                        0,
+                        1.0,
+                        1.0,
+                        G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+  /**
+   * PhocViewSnapshot:progress:
+   *
+   * How far the snapshot moved from its initial box towards the
+   * target box.
+   */
+  props[PROP_PROGRESS] =
+    g_param_spec_float ("progress", "", "",
+                        0,
+                        1.0,
+                        0,
+                        G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
+  phoc_property_easer_install_float_setter (props[PROP_ALPHA],
+                                            (PhocPropertyEaserFloatSetter)set_alpha);
+  phoc_property_easer_install_float_setter (props[PROP_PROGRESS],
+                                            (PhocPropertyEaserFloatSetter)set_progress);
+}
+
+
+static void
+phoc_view_snapshot_init (PhocViewSnapshot *self)
+{
+  self->alpha = 1.0;
+}
+
+/**
+ * phoc_view_snapshot_new:
+ * @view: The view to take the snapshot of
+ * @output: The output to show the snapshot on
+ * @box: The view's box in layout coordinates
+ *
+ * Captures the view's current content. The view needs to have a buffer
+ * attached.
+ *
+ * Returns: (transfer full) (nullable): The snapshot or %NULL if the
+ *   view's content couldn't be captured
+ */
+PhocViewSnapshot *
+phoc_view_snapshot_new (PhocView *view, PhocOutput *output, const struct wlr_box *box)
+{
+  PhocRenderer *renderer = phoc_server_get_renderer (phoc_server_get_default ());
+  g_autoptr (PhocViewSnapshot) self = NULL;
+  float scale;
+
+  g_assert (PHOC_IS_VIEW (view));
+  g_assert (PHOC_IS_OUTPUT (output));
+
+  if (wlr_box_empty (box))
+    return NULL;
+
+  self = g_object_new (PHOC_TYPE_VIEW_SNAPSHOT, "output", output, NULL);
+  self->box = self->target_box = *box;
+
+  /* Capture at the output's resolution so the snapshot isn't blurry */
+  scale = output->wlr_output->scale;
+  self->texture = phoc_renderer_render_view_to_texture (renderer, view,
+                                                        box->width * scale,
+                                                        box->height * scale);
+  if (self->texture == NULL) {
+    g_warning ("Failed to capture snapshot of %p", view);
+    return NULL;
+  }
+
+  return g_steal_pointer (&self);
+}
+
+/**
+ * phoc_view_snapshot_animate:
+ * @self: The snapshot
+ * @target_box: The box in layout coordinates to move the snapshot to
+ * @easing: The easing function
+ * @duration: The duration of the animation in ms
+ *
+ * Shows the snapshot on its output and morphs it into @target_box
+ * while fading it out. Once done the snapshot is removed from the
+ * output.
+ */
+void
+phoc_view_snapshot_animate (PhocViewSnapshot     *self,
+                            const struct wlr_box *target_box,
+                            PhocEasing            easing,
+                            guint                 duration)
+{
+  g_autoptr (PhocPropertyEaser) easer = NULL;
+
+  g_return_if_fail (PHOC_IS_VIEW_SNAPSHOT (self));
+  g_return_if_fail (self->animation == NULL);
+
+  if (self->output == NULL)
+    return;
+
+  self->target_box = *target_box;
+
+  easer = g_object_new (PHOC_TYPE_PROPERTY_EASER,
+                        "target", self,
+                        "easing", easing,
+                        NULL);
+  phoc_property_easer_set_props (easer,
+                                 "alpha", 1.0, 0.0,
+                                 "progress", 0.0, 1.0,
+                                 NULL);
+  self->animation = g_object_new (PHOC_TYPE_TIMED_ANIMATION,
+                                  "animatable", self,
+                                  "duration", duration,
+                                  "property-easer", easer,
+                                  NULL);
+  g_signal_connect_swapped (self->animation, "done",
+                            G_CALLBACK (on_animation_done),
+                            self);
+
+  phoc_output_add_view_snapshot (self->output, self);
+  phoc_timed_animation_play (self->animation);
+}
+
+
+/**
+ * phoc_view_snapshot_set_box:
+ * @self: The snapshot
+ * @box: The box in layout coordinates
+ *
+ * Moves the snapshot to @box right away scaling its content to fit.
+ */
+void
+phoc_view_snapshot_set_box (PhocViewSnapshot *self, const struct wlr_box *box)
+{
+  g_return_if_fail (PHOC_IS_VIEW_SNAPSHOT (self));
+  g_return_if_fail (self->animation == NULL);
+
+  phoc_view_snapshot_damage (self);
+  self->box = self->target_box = *box;
+  self->progress = 0.0;
+  phoc_view_snapshot_damage (self);
+}
+
+
+struct wlr_texture *
+phoc_view_snapshot_get_texture (PhocViewSnapshot *self)
+{
+  g_return_val_if_fail (PHOC_IS_VIEW_SNAPSHOT (self), NULL);
+
+  return self->texture;
+}
+
+
+PhocOutput *
+phoc_view_snapshot_get_output (PhocViewSnapshot *self)
+{
+  g_return_val_if_fail (PHOC_IS_VIEW_SNAPSHOT (self), NULL);
+
+  return self->output;
+}
+
+
+float
+phoc_view_snapshot_get_alpha (PhocViewSnapshot *self)
+{
+  g_return_val_if_fail (PHOC_IS_VIEW_SNAPSHOT (self), 0.0);
+
+  return self->alpha;
+}
+
+/**
+ * phoc_view_snapshot_get_output_box:
+ * @self: The snapshot
+ * @box: (out): The snapshot's current box
+ *
+ * Gets the area currently covered by the snapshot in output buffer
+ * coordinates.
+ *
+ * Returns: %TRUE if the snapshot is still on an output
+ */
+gboolean
+phoc_view_snapshot_get_output_box (PhocViewSnapshot *self, struct wlr_box *box)
+{
+  struct wlr_output *wlr_output;
+  double x, y;
+
+  g_return_val_if_fail (PHOC_IS_VIEW_SNAPSHOT (self), FALSE);
+
+  if (self->output == NULL)
+    return FALSE;
+
+  wlr_output = self->output->wlr_output;
+  x = self->box.x + (self->target_box.x - self->box.x) * self->progress;
+  y = self->box.y + (self->target_box.y - self->box.y) * self->progress;
+  box->width = self->box.width + (self->target_box.width - self->box.width) * self->progress;
+  box->height = self->box.height + (self->target_box.height - self->box.height) * self->progress;
+
+  wlr_output_layout_output_coords (self->output->desktop->layout, wlr_output, &x, &y);
+  box->x = x;
+  box->y = y;
+  phoc_output_scale_box (self->output, box, wlr_output->scale);
+
+  return TRUE;
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "output.h"
+#include "phoc-animation.h"
+#include "view.h"
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define PHOC_TYPE_VIEW_SNAPSHOT (phoc_view_snapshot_get_type ())
+
+G_DECLARE_FINAL_TYPE (PhocViewSnapshot, phoc_view_snapshot, PHOC, VIEW_SNAPSHOT, GObject)
+
+PhocViewSnapshot   *phoc_view_snapshot_new            (PhocView               *view,
+                                                       PhocOutput             *output,
+                                                       const struct wlr_box   *box);
+void                phoc_view_snapshot_animate        (PhocViewSnapshot       *self,
+                                                       const struct wlr_box   *target_box,
+                                                       PhocEasing              easing,
+                                                       guint                   duration);
+void                phoc_view_snapshot_set_box        (PhocViewSnapshot       *self,
+                                                       const struct wlr_box   *box);
+void                phoc_view_snapshot_damage         (PhocViewSnapshot       *self);
+struct wlr_texture *phoc_view_snapshot_get_texture    (PhocViewSnapshot       *self);
+PhocOutput         *phoc_view_snapshot_get_output     (PhocViewSnapshot       *self);
+float               phoc_view_snapshot_get_alpha      (PhocViewSnapshot       *self);
+gboolean            phoc_view_snapshot_get_output_box (PhocViewSnapshot       *self,
+                                                       struct wlr_box         *box);
+
+G_END_DECLS
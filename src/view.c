@@ -5,6 +5,7 @@
 #ifndef _POSIX_C_SOURCE
 #define _POSIX_C_SOURCE 200809L
 #endif
+#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 #include <wlr/types/wlr_output_layout.h>
@@ -16,8 +17,13 @@
 #include "utils.h"
 #include "timed-animation.h"
 #include "view-private.h"
+#include "view-scale-cache.h"
+#include "view-snapshot.h"
 
 #define PHOC_ANIM_DURATION_WINDOW_FADE 150
+#define PHOC_ANIM_DURATION_WINDOW_MAXIMIZE 200
+/* Closing windows shrink to this fraction of their size */
+#define PHOC_ANIM_WINDOW_CLOSE_SCALE 0.9
 
 enum {
   PROP_0,
@@ -35,6 +41,15 @@ enum {
 };
 static guint signals[N_SIGNALS] = { 0 };
 
+/* Views rarely span more outputs, if they do all outputs get damaged */
+#define VIEW_MAX_OUTPUTS 4
+
+typedef struct {
+  PhocOutput *outputs[VIEW_MAX_OUTPUTS];
+  guint       n_outputs;
+  gboolean    all;
+} PhocViewOutputs;
+
 typedef struct _PhocViewPrivate {
   char          *title;
   char          *app_id;
@@ -66,6 +81,30 @@ typedef struct _PhocViewPrivate {
   /* Subsurface and popups */
   struct wl_listener surface_new_subsurface;
   struct wl_list child_surfaces; // PhocViewChild::link
+
+  /* Content captured before the client dropped its buffer */
+  struct wl_listener surface_client_commit;
+  PhocViewSnapshot  *unmap_snapshot;
+
+  /* Outputs the view (including decorations) intersects, not owned */
+  PhocViewOutputs    outputs;
+  /* Outputs damaged last time so content left behind there gets repainted */
+  PhocViewOutputs    damaged_outputs;
+  /* Whether children changed and the outputs need to be recomputed */
+  gboolean           outputs_dirty;
+  int                outputs_surface_width;
+  int                outputs_surface_height;
+
+  /* Old content shown while the client resizes */
+  PhocViewSnapshot  *saved_content;
+  guint              saved_content_timeout_id;
+
+  /* Surface tree scaled down to fit the output */
+  PhocViewScaleCache *scale_cache;
+
+  PhocViewFrameStats frame_stats;
+  /* When the client got its last frame done event, 0 once it committed */
+  gint64             frame_done_us;
 } PhocViewPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (PhocView, phoc_view, G_TYPE_OBJECT)
@@ -274,8 +313,91 @@ view_update_output (PhocView *view, const struct wlr_box *before)
       }
     }
   }
+
+  phoc_view_update_intersecting_outputs (view);
+}
+
+static gboolean
+view_want_animations (PhocView *self)
+{
+  return phoc_desktop_get_enable_animations (self->desktop) && self->parent == NULL;
+}
+
+/* The area covered by the view's content in layout coordinates */
+static void
+view_get_content_box (PhocView *self, struct wlr_box *box)
+{
+  PhocViewPrivate *priv = phoc_view_get_instance_private (self);
+  struct wlr_box geom;
+
+  phoc_view_get_geometry (self, &geom);
+  box->x = self->box.x + geom.x * priv->scale;
+  box->y = self->box.y + geom.y * priv->scale;
+  box->width = geom.width * priv->scale;
+  box->height = geom.height * priv->scale;
+}
+
+
+static PhocViewSnapshot *
+view_take_snapshot (PhocView *self)
+{
+  PhocOutput *output;
+  struct wlr_box box;
+
+  if (!view_want_animations (self))
+    return NULL;
+
+  if (self->wlr_surface == NULL || !wlr_surface_has_buffer (self->wlr_surface))
+    return NULL;
+
+  if (!phoc_desktop_view_is_visible (self->desktop, self))
+    return NULL;
+
+  output = phoc_view_get_output (self);
+  if (output == NULL)
+    return NULL;
+
+  view_get_content_box (self, &box);
+  return phoc_view_snapshot_new (self, output, &box);
+}
+
+
+static void
+view_fade_in (PhocView *self)
+{
+  g_autoptr (PhocTimedAnimation) fade_anim = NULL;
+  g_autoptr (PhocPropertyEaser) easer = NULL;
+
+  easer = g_object_new (PHOC_TYPE_PROPERTY_EASER,
+                        "target", self,
+                        "easing", PHOC_EASING_EASE_OUT_QUAD,
+                        NULL);
+  phoc_property_easer_set_props (easer, "alpha", 0.0, 1.0, NULL);
+  fade_anim = g_object_new (PHOC_TYPE_TIMED_ANIMATION,
+                            "animatable", phoc_view_get_output (self),
+                            "duration", PHOC_ANIM_DURATION_WINDOW_FADE,
+                            "property-easer", easer,
+                            "dispose-on-done", TRUE,
+                            NULL);
+  phoc_timed_animation_play (fade_anim);
+}
+
+/*
+ * Cross fade from the snapshot of the old geometry to the live view in
+ * its new geometry. This doesn't wait for the client to redraw.
+ */
+static void
+view_animate_geometry_change (PhocView *self, PhocViewSnapshot *snapshot, const struct wlr_box *box)
+{
+  if (wlr_box_empty (box))
+    return;
+
+  phoc_view_snapshot_animate (snapshot, box, PHOC_EASING_EASE_OUT_CUBIC,
+                              PHOC_ANIM_DURATION_WINDOW_MAXIMIZE);
+  view_fade_in (self);
 }
 
+
 static void
 view_save(PhocView *view)
 {
@@ -381,6 +503,27 @@ static struct wlr_output *view_get_output(PhocView *view) {
 		output_y);
 }
 
+static gboolean
+view_get_maximized_box (PhocView *view, struct wlr_output *output, struct wlr_box *box)
+{
+  PhocOutput *phoc_output;
+  struct wlr_box output_box;
+
+  if (!output)
+    output = view_get_output (view);
+
+  if (!output)
+    return FALSE;
+
+  phoc_output = output->data;
+  wlr_output_layout_get_box (view->desktop->layout, output, &output_box);
+  *box = phoc_output->usable_area;
+  box->x += output_box.x;
+  box->y += output_box.y;
+
+  return TRUE;
+}
+
 void view_arrange_maximized(PhocView *view, struct wlr_output *output) {
         PhocViewPrivate *priv;
 
@@ -390,19 +533,10 @@ void view_arrange_maximized(PhocView *view, struct wlr_output *output) {
 	if (view_is_fullscreen (view))
 		return;
 
-	if (!output)
-		output = view_get_output(view);
-
-	if (!output)
+	struct wlr_box usable_area;
+	if (!view_get_maximized_box (view, output, &usable_area))
 		return;
 
-	PhocOutput *phoc_output = output->data;
-	struct wlr_box output_box;
-	wlr_output_layout_get_box (view->desktop->layout, output, &output_box);
-	struct wlr_box usable_area = phoc_output->usable_area;
-	usable_area.x += output_box.x;
-	usable_area.y += output_box.y;
-
 	struct wlr_box geom;
 	phoc_view_get_geometry (view, &geom);
 	phoc_view_move_resize (view,
@@ -473,6 +607,11 @@ void view_maximize(PhocView *view, struct wlr_output *output) {
 		return;
 	}
 
+	g_autoptr (PhocViewSnapshot) snapshot = NULL;
+	/* No need to animate in auto maximize mode as views can't be restored */
+	if (!phoc_view_want_auto_maximize (view))
+		snapshot = view_take_snapshot (view);
+
 	PHOC_VIEW_GET_CLASS (view)->set_tiled (view, false);
 	PHOC_VIEW_GET_CLASS (view)->set_maximized (view, true);
 
@@ -484,6 +623,10 @@ void view_maximize(PhocView *view, struct wlr_output *output) {
 
 	priv->state = PHOC_VIEW_STATE_MAXIMIZED;
 	view_arrange_maximized(view, output);
+
+	struct wlr_box box;
+	if (snapshot && view_get_maximized_box (view, output, &box))
+		view_animate_geometry_change (view, snapshot, &box);
 }
 
 /*
@@ -510,6 +653,7 @@ view_restore(PhocView *view)
   if (phoc_view_want_auto_maximize (view))
     return;
 
+  g_autoptr (PhocViewSnapshot) snapshot = view_take_snapshot (view);
   struct wlr_box geom;
   phoc_view_get_geometry (view, &geom);
 
@@ -528,6 +672,9 @@ view_restore(PhocView *view)
 
   PHOC_VIEW_GET_CLASS (view)->set_maximized (view, false);
   PHOC_VIEW_GET_CLASS (view)->set_tiled (view, false);
+
+  if (snapshot)
+    view_animate_geometry_change (view, snapshot, &view->saved);
 }
 
 /**
@@ -942,6 +1089,27 @@ phoc_view_handle_surface_new_subsurface (struct wl_listener *listener, void *dat
   phoc_view_subsurface_create (self, wlr_subsurface);
 }
 
+static void
+phoc_view_handle_surface_client_commit (struct wl_listener *listener, void *data)
+{
+  PhocViewPrivate *priv = wl_container_of (listener, priv, surface_client_commit);
+  PhocView *self = PHOC_VIEW_SELF (priv);
+  struct wlr_surface_state *pending = &self->wlr_surface->pending;
+
+  priv->frame_stats.n_commits++;
+  if (priv->frame_done_us) {
+    priv->frame_stats.latency_sum_us += g_get_monotonic_time () - priv->frame_done_us;
+    priv->frame_stats.n_latencies++;
+    priv->frame_done_us = 0;
+  }
+
+  /* The client is about to drop its buffer and unmap, grab the
+   * content for the unmap animation while it's still there */
+  if (priv->unmap_snapshot == NULL &&
+      (pending->committed & WLR_SURFACE_STATE_BUFFER) && pending->buffer == NULL)
+    priv->unmap_snapshot = view_take_snapshot (self);
+}
+
 static gchar *
 munge_app_id (const gchar *app_id)
 {
@@ -996,6 +1164,9 @@ view_update_scale (PhocView *view)
     priv->scale = 1.0;
   }
 
+  if (priv->scale == 1.0)
+    g_clear_pointer (&priv->scale_cache, phoc_view_scale_cache_free);
+
   if (priv->scale != oldscale) {
     if (view_is_maximized(view)) {
       view_arrange_maximized (view, NULL);
@@ -1004,6 +1175,8 @@ view_update_scale (PhocView *view)
     } else {
       view_center (view, NULL);
     }
+    /* The position might not have changed but the size did */
+    phoc_view_update_intersecting_outputs (view);
   }
 }
 
@@ -1036,6 +1209,11 @@ phoc_view_map (PhocView *self, struct wlr_surface *surface)
   priv->surface_new_subsurface.notify = phoc_view_handle_surface_new_subsurface;
   wl_signal_add (&self->wlr_surface->events.new_subsurface, &priv->surface_new_subsurface);
 
+  priv->frame_stats = (PhocViewFrameStats) { 0 };
+  priv->frame_done_us = 0;
+  priv->surface_client_commit.notify = phoc_view_handle_surface_client_commit;
+  wl_signal_add (&self->wlr_surface->events.client_commit, &priv->surface_client_commit);
+
   if (self->desktop->maximize) {
     phoc_view_appear_activated (self, true);
 
@@ -1050,6 +1228,7 @@ phoc_view_map (PhocView *self, struct wlr_surface *surface)
   }
 
   wl_list_insert(&self->desktop->views, &self->link);
+  phoc_view_update_intersecting_outputs (self);
   phoc_view_damage_whole (self);
   phoc_input_update_cursor_focus(server->input);
   priv->pid = PHOC_VIEW_GET_CLASS (self)->get_pid (self);
@@ -1065,24 +1244,8 @@ phoc_view_map (PhocView *self, struct wlr_surface *surface)
   if (priv->activation_token)
     phoc_view_activate (self, TRUE);
 
-  if (phoc_desktop_get_enable_animations (self->desktop)
-      && self->parent == NULL
-      && !phoc_view_want_auto_maximize (self)) {
-    g_autoptr (PhocTimedAnimation) fade_anim = NULL;
-    g_autoptr (PhocPropertyEaser) easer = NULL;
-    easer = g_object_new (PHOC_TYPE_PROPERTY_EASER,
-                          "target", self,
-                          "easing", PHOC_EASING_EASE_OUT_QUAD,
-                          NULL);
-    phoc_property_easer_set_props (easer, "alpha", 0.0, 1.0, NULL);
-    fade_anim = g_object_new (PHOC_TYPE_TIMED_ANIMATION,
-                              "animatable", phoc_view_get_output (self),
-                              "duration", PHOC_ANIM_DURATION_WINDOW_FADE,
-                              "property-easer", easer,
-                              "dispose-on-done", TRUE,
-                              NULL);
-    phoc_timed_animation_play (fade_anim);
-  }
+  if (view_want_animations (self) && !phoc_view_want_auto_maximize (self))
+    view_fade_in (self);
 
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_IS_MAPPED]);
 }
@@ -1094,9 +1257,26 @@ void view_unmap(PhocView *view) {
 
 	bool was_visible = phoc_desktop_view_is_visible(view->desktop, view);
 
+	// Animate the view's last content out, the client might be gone already
+	g_autoptr (PhocViewSnapshot) snapshot = g_steal_pointer (&priv->unmap_snapshot);
+	if (snapshot == NULL)
+		snapshot = view_take_snapshot (view);
+	if (snapshot) {
+		struct wlr_box box;
+
+		view_get_content_box (view, &box);
+		box.x += box.width * (1.0 - PHOC_ANIM_WINDOW_CLOSE_SCALE) / 2;
+		box.y += box.height * (1.0 - PHOC_ANIM_WINDOW_CLOSE_SCALE) / 2;
+		box.width *= PHOC_ANIM_WINDOW_CLOSE_SCALE;
+		box.height *= PHOC_ANIM_WINDOW_CLOSE_SCALE;
+		phoc_view_snapshot_animate (snapshot, &box, PHOC_EASING_EASE_OUT_QUAD,
+					    PHOC_ANIM_DURATION_WINDOW_FADE);
+	}
+
 	phoc_view_damage_whole (view);
 
 	wl_list_remove (&priv->surface_new_subsurface.link);
+	wl_list_remove (&priv->surface_client_commit.link);
 
 	PhocViewChild *child, *tmp;
 	wl_list_for_each_safe(child, tmp, &priv->child_surfaces, link) {
@@ -1109,7 +1289,11 @@ void view_unmap(PhocView *view) {
 		priv->fullscreen_output = NULL;
 	}
 
+	phoc_view_drop_saved_content (view);
+	g_clear_pointer (&priv->scale_cache, phoc_view_scale_cache_free);
 	wl_list_remove(&view->link);
+	priv->outputs = (PhocViewOutputs) { 0 };
+	priv->damaged_outputs = (PhocViewOutputs) { 0 };
 
 	if (was_visible && view->desktop->maximize && !wl_list_empty(&view->desktop->views)) {
 		// damage the newly activated stack as well since it may have just become visible
@@ -1195,6 +1379,90 @@ void view_setup(PhocView *view) {
 	wlr_foreign_toplevel_handle_v1_set_parent(priv->toplevel_handle, toplevel_handle);
 }
 
+/*
+ * Position of a surface in the subsurface tree of the view's surface.
+ * Returns %FALSE if it's not part of that tree (e.g. a popup).
+ */
+static gboolean
+view_get_subsurface_pos (PhocView *self, struct wlr_surface *surface, int *sx, int *sy)
+{
+  *sx = *sy = 0;
+
+  while (surface != self->wlr_surface) {
+    struct wlr_subsurface *subsurface;
+
+    if (surface == NULL || !wlr_surface_is_subsurface (surface))
+      return FALSE;
+
+    subsurface = wlr_subsurface_from_wlr_surface (surface);
+    if (subsurface == NULL)
+      return FALSE;
+
+    *sx += subsurface->current.x;
+    *sy += subsurface->current.y;
+    surface = subsurface->parent;
+  }
+
+  return TRUE;
+}
+
+static gboolean
+view_outputs_contain (const PhocViewOutputs *outputs, PhocOutput *output)
+{
+  if (outputs->all)
+    return TRUE;
+
+  for (guint i = 0; i < outputs->n_outputs; i++) {
+    if (outputs->outputs[i] == output)
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
+
+static void
+view_outputs_add (PhocViewOutputs *outputs, PhocOutput *output)
+{
+  if (outputs->n_outputs == VIEW_MAX_OUTPUTS) {
+    outputs->all = TRUE;
+    return;
+  }
+
+  outputs->outputs[outputs->n_outputs++] = output;
+}
+
+
+static void
+view_outputs_remove (PhocViewOutputs *outputs, PhocOutput *output)
+{
+  for (guint i = 0; i < outputs->n_outputs; i++) {
+    if (outputs->outputs[i] == output) {
+      outputs->outputs[i] = outputs->outputs[--outputs->n_outputs];
+      return;
+    }
+  }
+}
+
+/*
+ * Damages the outputs the view is on and the ones it was on when
+ * damaged last time.
+ */
+static void
+view_damage_outputs (PhocView *self, gboolean whole)
+{
+  PhocViewPrivate *priv = phoc_view_get_instance_private (self);
+  PhocOutput *output;
+
+  wl_list_for_each (output, &self->desktop->outputs, link) {
+    if (view_outputs_contain (&priv->outputs, output) ||
+        view_outputs_contain (&priv->damaged_outputs, output))
+      phoc_output_damage_from_view (output, self, whole);
+  }
+
+  priv->damaged_outputs = priv->outputs;
+}
+
 /**
  * phoc_view_apply_damage:
  * @view: A view
@@ -1205,10 +1473,21 @@ void view_setup(PhocView *view) {
 void
 phoc_view_apply_damage (PhocView *view)
 {
-  PhocOutput *output;
+  PhocViewPrivate *priv = phoc_view_get_instance_private (view);
+
+  if (priv->scale_cache && view->wlr_surface)
+    phoc_view_scale_cache_add_surface_damage (priv->scale_cache, view->wlr_surface, 0, 0);
+
+  /* The extents change with the content, e.g. when popups show up or
+   * the client resizes its buffer */
+  if (view->wlr_surface &&
+      (priv->outputs_dirty ||
+       priv->outputs_surface_width != view->wlr_surface->current.width ||
+       priv->outputs_surface_height != view->wlr_surface->current.height)) {
+    phoc_view_update_intersecting_outputs (view);
+  }
 
-  wl_list_for_each (output, &view->desktop->outputs, link)
-    phoc_output_damage_from_view (output, view, false);
+  view_damage_outputs (view, false);
 }
 
 /**
@@ -1223,9 +1502,250 @@ phoc_view_apply_damage (PhocView *view)
 void
 phoc_view_damage_whole (PhocView *view)
 {
+  PhocViewPrivate *priv = phoc_view_get_instance_private (view);
+
+  if (priv->scale_cache)
+    phoc_view_scale_cache_damage_whole (priv->scale_cache);
+
+  /* Used when moving, resizing or unmapping so this also covers the
+   * outputs the view isn't on anymore */
+  view_damage_outputs (view, true);
+}
+
+typedef struct {
+  struct wlr_box *extents;
+  float           scale;
+} PhocViewExtentsData;
+
+
+static void
+box_union (struct wlr_box *dest, const struct wlr_box *box)
+{
+  int x2, y2;
+
+  if (wlr_box_empty (box))
+    return;
+
+  if (wlr_box_empty (dest)) {
+    *dest = *box;
+    return;
+  }
+
+  x2 = MAX (dest->x + dest->width, box->x + box->width);
+  y2 = MAX (dest->y + dest->height, box->y + box->height);
+  dest->x = MIN (dest->x, box->x);
+  dest->y = MIN (dest->y, box->y);
+  dest->width = x2 - dest->x;
+  dest->height = y2 - dest->y;
+}
+
+
+static void
+view_extents_iterator (struct wlr_surface *surface, int sx, int sy, void *_data)
+{
+  PhocViewExtentsData *data = _data;
+  struct wlr_box box;
+
+  if (!wlr_surface_has_buffer (surface))
+    return;
+
+  box = (struct wlr_box) {
+    .x = floor ((sx + surface->sx) * data->scale),
+    .y = floor ((sy + surface->sy) * data->scale),
+    .width = ceil (surface->current.width * data->scale) + 1,
+    .height = ceil (surface->current.height * data->scale) + 1,
+  };
+  box_union (data->extents, &box);
+}
+
+/*
+ * The area covered by the view's surfaces including popups, CSD
+ * shadows and server side decorations in layout coordinates.
+ */
+static void
+view_get_extents (PhocView *self, struct wlr_box *extents)
+{
+  struct wlr_box surfaces = { 0 };
+  PhocViewExtentsData data = { .extents = &surfaces, .scale = phoc_view_get_scale (self) };
+
+  view_get_deco_box (self, extents);
+
+  phoc_view_for_each_surface (self, view_extents_iterator, &data);
+  surfaces.x += self->box.x;
+  surfaces.y += self->box.y;
+  box_union (extents, &surfaces);
+}
+
+/**
+ * phoc_view_update_intersecting_outputs:
+ * @self: A view
+ *
+ * Updates the set of outputs the @self's surfaces (including popups
+ * and window decorations) intersect. Damage of the view's surfaces is
+ * only added to these outputs so this needs to be called whenever the
+ * box or the output layout changes. Changes of the view's content are
+ * picked up on commit.
+ */
+void
+phoc_view_update_intersecting_outputs (PhocView *self)
+{
+  PhocViewPrivate *priv;
+  PhocOutput *output;
+  struct wlr_box box;
+
+  g_assert (PHOC_IS_VIEW (self));
+  priv = phoc_view_get_instance_private (self);
+
+  priv->outputs = (PhocViewOutputs) { 0 };
+  priv->outputs_dirty = FALSE;
+  if (!phoc_view_is_mapped (self))
+    return;
+
+  priv->outputs_surface_width = self->wlr_surface->current.width;
+  priv->outputs_surface_height = self->wlr_surface->current.height;
+
+  view_get_extents (self, &box);
+  wl_list_for_each (output, &self->desktop->outputs, link) {
+    if (wlr_output_layout_intersects (self->desktop->layout, output->wlr_output, &box))
+      view_outputs_add (&priv->outputs, output);
+  }
+}
+
+static gboolean
+on_saved_content_timeout (gpointer data)
+{
+  PhocView *self = PHOC_VIEW (data);
+  PhocViewPrivate *priv = phoc_view_get_instance_private (self);
+
+  g_debug ("View %p didn't resize in time", self);
+  priv->saved_content_timeout_id = 0;
+  phoc_view_drop_saved_content (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+/**
+ * phoc_view_save_content:
+ * @self: A view
+ * @box: The box the view is being resized to, in the same coordinates
+ *   as the view's box
+ *
+ * Keeps showing the view's current content scaled into @box until
+ * [method@View.drop_saved_content] is called or the configured resize
+ * timeout expires. This makes resizes appear instant while waiting
+ * for the client to redraw at the new size. Calling this again while
+ * content is saved moves the saved content to the new @box.
+ */
+void
+phoc_view_save_content (PhocView *self, const struct wlr_box *box)
+{
+  PhocViewPrivate *priv;
+  guint timeout = self->desktop->config->resize_timeout;
+  struct wlr_box content_box, target_box, geom;
   PhocOutput *output;
-  wl_list_for_each(output, &view->desktop->outputs, link)
-    phoc_output_damage_from_view (output, view, true);
+
+  g_assert (PHOC_IS_VIEW (self));
+  priv = phoc_view_get_instance_private (self);
+
+  if (timeout == 0)
+    return;
+
+  /* Keep the client side decorations' extent */
+  phoc_view_get_geometry (self, &geom);
+  target_box = (struct wlr_box) {
+    .x = box->x + geom.x * priv->scale,
+    .y = box->y + geom.y * priv->scale,
+    .width = box->width * priv->scale,
+    .height = box->height * priv->scale,
+  };
+  if (wlr_box_empty (&target_box))
+    return;
+
+  if (priv->saved_content) {
+    phoc_view_snapshot_set_box (priv->saved_content, &target_box);
+    return;
+  }
+
+  if (self->wlr_surface == NULL || !wlr_surface_has_buffer (self->wlr_surface))
+    return;
+
+  if (!phoc_desktop_view_is_visible (self->desktop, self))
+    return;
+
+  output = phoc_view_get_output (self);
+  if (output == NULL)
+    return;
+
+  view_get_content_box (self, &content_box);
+  priv->saved_content = phoc_view_snapshot_new (self, output, &content_box);
+  if (priv->saved_content == NULL)
+    return;
+
+  phoc_view_snapshot_set_box (priv->saved_content, &target_box);
+  priv->saved_content_timeout_id = g_timeout_add (timeout, on_saved_content_timeout, self);
+}
+
+/**
+ * phoc_view_drop_saved_content:
+ * @self: A view
+ *
+ * Stops showing the content saved via [method@View.save_content] and
+ * shows the view's surfaces again.
+ */
+void
+phoc_view_drop_saved_content (PhocView *self)
+{
+  PhocViewPrivate *priv;
+
+  g_assert (PHOC_IS_VIEW (self));
+  priv = phoc_view_get_instance_private (self);
+
+  if (priv->saved_content == NULL)
+    return;
+
+  g_clear_handle_id (&priv->saved_content_timeout_id, g_source_remove);
+  phoc_view_snapshot_damage (priv->saved_content);
+  g_clear_object (&priv->saved_content);
+  phoc_view_damage_whole (self);
+}
+
+/**
+ * phoc_view_get_saved_content:
+ * @self: A view
+ *
+ * Returns: (transfer none) (nullable): The content saved via
+ *   [method@View.save_content] that should be shown instead of the
+ *   view's surfaces.
+ */
+PhocViewSnapshot *
+phoc_view_get_saved_content (PhocView *self)
+{
+  PhocViewPrivate *priv;
+
+  g_assert (PHOC_IS_VIEW (self));
+  priv = phoc_view_get_instance_private (self);
+
+  return priv->saved_content;
+}
+
+/**
+ * phoc_view_remove_intersecting_output:
+ * @self: A view
+ * @output: The output to remove
+ *
+ * Removes @output from the outputs the view intersects, e.g. because
+ * it is going away.
+ */
+void
+phoc_view_remove_intersecting_output (PhocView *self, PhocOutput *output)
+{
+  PhocViewPrivate *priv;
+
+  g_assert (PHOC_IS_VIEW (self));
+  priv = phoc_view_get_instance_private (self);
+
+  view_outputs_remove (&priv->outputs, output);
+  view_outputs_remove (&priv->damaged_outputs, output);
 }
 
 
@@ -1548,9 +2068,13 @@ phoc_view_finalize (GObject *object)
     priv->fullscreen_output->fullscreen_view = NULL;
   }
 
+  g_clear_handle_id (&priv->saved_content_timeout_id, g_source_remove);
+  g_clear_object (&priv->saved_content);
+  g_clear_pointer (&priv->scale_cache, phoc_view_scale_cache_free);
   g_clear_pointer (&priv->title, g_free);
   g_clear_pointer (&priv->app_id, g_free);
   g_clear_pointer (&priv->activation_token, g_free);
+  g_clear_object (&priv->unmap_snapshot);
   g_clear_object (&priv->settings);
 
   G_OBJECT_CLASS (phoc_view_parent_class)->finalize (object);
@@ -1718,6 +2242,8 @@ phoc_view_class_init (PhocViewClass *klass)
                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
 
   g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
+  phoc_property_easer_install_float_setter (props[PROP_ALPHA],
+                                            (PhocPropertyEaserFloatSetter)phoc_view_set_alpha);
 
   /**
    * PhocView:surface-destroy:
@@ -1870,10 +2396,23 @@ phoc_view_child_destroy (PhocViewChild *child)
 void
 phoc_view_child_apply_damage (PhocViewChild *child)
 {
+  PhocViewPrivate *priv;
+  PhocOutput *output;
+  int sx, sy;
+
   if (!child || !phoc_view_child_is_mapped (child) || !phoc_view_is_mapped (child->view))
     return;
 
-  phoc_view_apply_damage (child->view);
+  priv = phoc_view_get_instance_private (child->view);
+  if (priv->scale_cache && view_get_subsurface_pos (child->view, child->wlr_surface, &sx, &sy))
+    phoc_view_scale_cache_add_surface_damage (priv->scale_cache, child->wlr_surface, sx, sy);
+
+  /* The child might have moved or changed size */
+  priv->outputs_dirty = TRUE;
+
+  /* Children like popups can extend beyond the view so consider all outputs */
+  wl_list_for_each (output, &child->view->desktop->outputs, link)
+    phoc_output_damage_from_view (output, child->view, false);
 }
 
 /**
@@ -1886,9 +2425,18 @@ phoc_view_child_apply_damage (PhocViewChild *child)
 void
 phoc_view_child_damage_whole (PhocViewChild *child)
 {
+  PhocViewPrivate *priv;
+
   if (!child || !phoc_view_child_is_mapped (child) || !phoc_view_is_mapped (child->view))
     return;
 
+  priv = phoc_view_get_instance_private (child->view);
+  if (priv->scale_cache)
+    phoc_view_scale_cache_damage_whole (priv->scale_cache);
+
+  /* Called on map and unmap so the view's extents change */
+  priv->outputs_dirty = TRUE;
+
   if (child->impl->get_pos) {
     PhocOutput *output;
     int sx, sy;
@@ -1906,8 +2454,12 @@ phoc_view_child_damage_whole (PhocViewChild *child)
 
     }
   } else {
+    PhocOutput *output;
+
     /* TODO: Implement impl->get_pos for subsurfaces too */
-    phoc_view_damage_whole (child->view);
+    /* Children can extend beyond the view so consider all outputs */
+    wl_list_for_each (output, &child->view->desktop->outputs, link)
+      phoc_output_damage_from_view (output, child->view, true);
   }
 }
 
@@ -2035,6 +2587,33 @@ phoc_view_get_scale (PhocView *self)
   return priv->scale;
 }
 
+/**
+ * phoc_view_get_scale_cache:
+ * @self: A view
+ *
+ * Gets the cache holding the view's surface tree scaled down to fit
+ * the output. The cache is only available while the view is mapped
+ * and scaled.
+ *
+ * Returns: (transfer none) (nullable): The scale cache
+ */
+PhocViewScaleCache *
+phoc_view_get_scale_cache (PhocView *self)
+{
+  PhocViewPrivate *priv;
+
+  g_assert (PHOC_IS_VIEW (self));
+  priv = phoc_view_get_instance_private (self);
+
+  if (!phoc_view_is_mapped (self) || priv->scale == 1.0)
+    return NULL;
+
+  if (priv->scale_cache == NULL)
+    priv->scale_cache = phoc_view_scale_cache_new ();
+
+  return priv->scale_cache;
+}
+
 /**
  * phoc_view_set_decoration
  * @self: The view
@@ -2061,6 +2640,8 @@ phoc_view_set_decoration (PhocView *self, gboolean decorated, int titlebar_heigh
     priv->titlebar_height = 0;
     priv->border_width = 0;
   }
+
+  phoc_view_update_intersecting_outputs (self);
 }
 
 
@@ -2166,3 +2747,56 @@ phoc_view_get_pid (PhocView *self)
 
   return priv->pid;
 }
+
+/**
+ * phoc_view_notify_frame_done:
+ * @self: A view
+ * @now_us: The time the frame done events get sent
+ * @refresh_us: The refresh period of the view's output
+ *
+ * Updates the view's frame statistics before its surfaces get their
+ * frame done events. If the client asked for a frame last time but
+ * didn't commit since that frame is counted as missed. Frames only go
+ * out when the output repaints so this is only the case if the last
+ * frame done event was sent about one refresh period ago. Otherwise
+ * the client likely just had nothing to draw.
+ */
+void
+phoc_view_notify_frame_done (PhocView *self, gint64 now_us, gint64 refresh_us)
+{
+  PhocViewPrivate *priv;
+
+  g_assert (PHOC_IS_VIEW (self));
+  priv = phoc_view_get_instance_private (self);
+
+  if (self->wlr_surface == NULL)
+    return;
+
+  if (priv->frame_done_us && now_us - priv->frame_done_us <= refresh_us * 3 / 2)
+    priv->frame_stats.n_missed++;
+
+  /* Only clients waiting for a frame are expected to commit */
+  if (wl_list_empty (&self->wlr_surface->current.frame_callback_list))
+    priv->frame_done_us = 0;
+  else
+    priv->frame_done_us = now_us;
+}
+
+/**
+ * phoc_view_get_frame_stats:
+ * @self: A view
+ *
+ * Gets the view's frame statistics.
+ *
+ * Returns: (transfer none): The frame statistics
+ */
+const PhocViewFrameStats *
+phoc_view_get_frame_stats (PhocView *self)
+{
+  PhocViewPrivate *priv;
+
+  g_assert (PHOC_IS_VIEW (self));
+  priv = phoc_view_get_instance_private (self);
+
+  return &priv->frame_stats;
+}
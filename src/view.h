@@ -13,6 +13,8 @@ G_BEGIN_DECLS
 typedef struct _PhocView PhocView;
 typedef struct _PhocDesktop PhocDesktop;
 typedef struct _PhocOutput PhocOutput;
+typedef struct _PhocViewSnapshot PhocViewSnapshot;
+typedef struct _PhocViewScaleCache PhocViewScaleCache;
 
 typedef enum {
   PHOC_VIEW_TILE_NONE  = 0,
@@ -63,6 +65,23 @@ struct _PhocView {
 	struct wlr_surface *wlr_surface; // set only when the surface is mapped
 };
 
+/**
+ * PhocViewFrameStats:
+ * @n_commits: Commits of the view's surface
+ * @n_missed: Frames the client asked for but didn't commit in time for
+ * @latency_sum_us: Sum of the delays between frame done events and
+ *   the following commits
+ * @n_latencies: Number of delays summed up in @latency_sum_us
+ *
+ * Frame statistics of a view since it got mapped.
+ */
+typedef struct _PhocViewFrameStats {
+  guint64 n_commits;
+  guint64 n_missed;
+  guint64 latency_sum_us;
+  guint64 n_latencies;
+} PhocViewFrameStats;
+
 /**
  * PhocViewClass:
  * @parent_class: The object class structure needs to be the first
@@ -159,6 +178,11 @@ typedef struct _PhocViewChild {
 void phoc_view_appear_activated (PhocView *view, bool activated);
 void phoc_view_activate (PhocView *view, bool activate);
 void phoc_view_damage_whole (PhocView *view);
+void phoc_view_update_intersecting_outputs (PhocView *self);
+void phoc_view_remove_intersecting_output (PhocView *self, PhocOutput *output);
+void phoc_view_save_content (PhocView *self, const struct wlr_box *box);
+void phoc_view_drop_saved_content (PhocView *self);
+PhocViewSnapshot *phoc_view_get_saved_content (PhocView *self);
 gboolean view_is_floating(PhocView *view);
 gboolean view_is_maximized(PhocView *view);
 gboolean view_is_tiled(PhocView *view);
@@ -183,6 +207,8 @@ void phoc_view_close (PhocView *self);
 bool view_center(PhocView *view, struct wlr_output *output);
 void phoc_view_set_app_id (PhocView *view, const char *app_id);
 const char *phoc_view_get_app_id (PhocView *self);
+void phoc_view_notify_frame_done (PhocView *self, gint64 now_us, gint64 refresh_us);
+const PhocViewFrameStats *phoc_view_get_frame_stats (PhocView *self);
 void view_get_deco_box(PhocView *view, struct wlr_box *box);
 void phoc_view_for_each_surface (PhocView                    *self,
                                  wlr_surface_iterator_func_t  iterator,
@@ -205,6 +231,7 @@ void                 phoc_view_set_activation_token (PhocView *self, const char*
 const char          *phoc_view_get_activation_token (PhocView *self);
 float                phoc_view_get_alpha (PhocView *self);
 float                phoc_view_get_scale (PhocView *self);
+PhocViewScaleCache  *phoc_view_get_scale_cache (PhocView *self);
 void                 phoc_view_set_decoration (PhocView *self,
                                                gboolean  decorated,
                                                int       titlebar_height,
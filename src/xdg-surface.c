@@ -171,8 +171,19 @@ move_resize (PhocView *view, double x, double y, uint32_t width, uint32_t height
       wlr_xdg_surface->toplevel->scheduled.height == constrained_height) {
     view_update_position (view, x, y);
   } else {
+    PhocTransaction *transaction = phoc_desktop_get_transaction (view->desktop);
+    struct wlr_box box = { x, y, constrained_width, constrained_height };
+
+    /* Show the old content at the new size until the client redrew */
+    phoc_view_save_content (view, &box);
+
     self->pending_move_resize_configure_serial =
       wlr_xdg_toplevel_set_size (wlr_xdg_surface->toplevel, constrained_width, constrained_height);
+
+    if (transaction && phoc_transaction_is_collecting (transaction)) {
+      phoc_transaction_add_configure (transaction, view,
+                                      self->pending_move_resize_configure_serial);
+    }
   }
 
   view_send_frame_done_if_not_visible (view);
@@ -309,6 +320,7 @@ handle_surface_commit (struct wl_listener *listener, void *data)
   PhocXdgSurface *self = wl_container_of (listener, self, surface_commit);
   PhocView *view = PHOC_VIEW (self);
   struct wlr_xdg_surface *surface = self->xdg_surface;
+  PhocTransaction *transaction;
 
   if (!surface->mapped)
     return;
@@ -338,10 +350,16 @@ handle_surface_commit (struct wl_listener *listener, void *data)
     }
     view_update_position (view, x, y);
 
-    if (pending_serial == surface->current.configure_serial)
+    if (pending_serial == surface->current.configure_serial) {
       self->pending_move_resize_configure_serial = 0;
+      phoc_view_drop_saved_content (view);
+    }
   }
 
+  transaction = phoc_desktop_get_transaction (view->desktop);
+  if (transaction)
+    phoc_transaction_notify_commit (transaction, view, surface->current.configure_serial);
+
   struct wlr_box geometry;
   phoc_xdg_surface_get_geometry (self, &geometry);
   if (self->saved_geometry.x != geometry.x || self->saved_geometry.y != geometry.y) {
@@ -386,7 +404,14 @@ static void
 handle_unmap (struct wl_listener *listener, void *data)
 {
   PhocXdgSurface *self = wl_container_of (listener, self, unmap);
-  view_unmap (PHOC_VIEW (self));
+  PhocView *view = PHOC_VIEW (self);
+  PhocTransaction *transaction = phoc_desktop_get_transaction (view->desktop);
+
+  /* Don't hold off repaints for a view that is gone */
+  if (transaction)
+    phoc_transaction_remove_view (transaction, view);
+
+  view_unmap (view);
 }
 
 
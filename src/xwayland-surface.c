@@ -65,6 +65,10 @@ is_moveable (PhocView *view)
   if (xwayland_surface->window_type == NULL)
     return true;
 
+  /* Can't tell the window types apart until the atoms got resolved */
+  if (!server->desktop->xwayland_atoms_resolved)
+    return true;
+
   for (guint i = 0; i < xwayland_surface->window_type_len; i++)
     if (xwayland_surface->window_type[i] != server->desktop->xwayland_atoms[NET_WM_WINDOW_TYPE_NORMAL] &&
         xwayland_surface->window_type[i] != server->desktop->xwayland_atoms[NET_WM_WINDOW_TYPE_DIALOG])
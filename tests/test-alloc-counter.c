@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ * SPDX-License-Identifier: GPL-3.0+
+ */
+
+#include "alloc-counter.h"
+
+#define N_THREAD_ALLOCS 1000
+
+static gpointer
+allocate_in_thread (gpointer data)
+{
+  guint64 before = phoc_alloc_counter_get_n_allocs ();
+
+  for (guint i = 0; i < N_THREAD_ALLOCS; i++)
+    g_free (g_malloc (16));
+
+  return GUINT_TO_POINTER (phoc_alloc_counter_get_n_allocs () - before);
+}
+
+
+static void
+test_phoc_alloc_counter_count (void)
+{
+  guint64 before, after;
+  gpointer mem;
+
+  if (!phoc_alloc_counter_is_enabled ()) {
+    g_assert_cmpuint (phoc_alloc_counter_get_n_allocs (), ==, 0);
+    g_test_skip ("Allocation counter not enabled");
+    return;
+  }
+
+  before = phoc_alloc_counter_get_n_allocs ();
+  mem = g_malloc (16);
+  mem = g_realloc (mem, 32);
+  g_free (mem);
+  g_free (g_malloc0 (16));
+  after = phoc_alloc_counter_get_n_allocs ();
+
+  g_assert_cmpuint (after - before, ==, 3);
+}
+
+
+static void
+test_phoc_alloc_counter_per_thread (void)
+{
+  g_autoptr (GThread) thread = NULL;
+  guint64 before, n_thread_allocs;
+
+  if (!phoc_alloc_counter_is_enabled ()) {
+    g_test_skip ("Allocation counter not enabled");
+    return;
+  }
+
+  before = phoc_alloc_counter_get_n_allocs ();
+  thread = g_thread_new ("alloc", allocate_in_thread, NULL);
+  n_thread_allocs = GPOINTER_TO_UINT (g_thread_join (g_steal_pointer (&thread)));
+
+  /* The other thread's allocations don't count here */
+  g_assert_cmpuint (n_thread_allocs, ==, N_THREAD_ALLOCS);
+  g_assert_cmpuint (phoc_alloc_counter_get_n_allocs () - before, <, N_THREAD_ALLOCS);
+}
+
+
+gint
+main (gint argc, gchar *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/phoc/alloc-counter/count", test_phoc_alloc_counter_count);
+  g_test_add_func ("/phoc/alloc-counter/per-thread", test_phoc_alloc_counter_per_thread);
+
+  return g_test_run ();
+}
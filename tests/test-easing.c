@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ * SPDX-License-Identifier: GPL-3.0+
+ */
+
+#include "anim/easing.h"
+
+#define N_VALUES 1001
+/* Maximum deviation of the lookup tables from the exact curves */
+#define LUT_EPSILON 0.001
+
+
+static void
+test_phoc_easing_fast (void)
+{
+  for (PhocEasing easing = PHOC_EASING_NONE; easing <= PHOC_EASING_EASE_IN_OUT_BOUNCE; easing++) {
+    g_assert_cmpfloat (phoc_easing_ease_fast (easing, 0.0), ==, phoc_easing_ease (easing, 0.0));
+    g_assert_cmpfloat (phoc_easing_ease_fast (easing, 1.0), ==, phoc_easing_ease (easing, 1.0));
+
+    for (guint i = 0; i < N_VALUES; i++) {
+      double value = (double) i / (N_VALUES - 1);
+
+      g_assert_cmpfloat_with_epsilon (phoc_easing_ease_fast (easing, value),
+                                      phoc_easing_ease (easing, value),
+                                      LUT_EPSILON);
+    }
+  }
+}
+
+
+static void
+test_phoc_easing_batch (void)
+{
+  double values[N_VALUES], results[N_VALUES];
+
+  for (guint i = 0; i < N_VALUES; i++)
+    values[i] = (double) i / (N_VALUES - 1);
+
+  for (PhocEasing easing = PHOC_EASING_NONE; easing <= PHOC_EASING_EASE_IN_OUT_BOUNCE; easing++) {
+    phoc_easing_ease_batch (easing, values, results, N_VALUES);
+
+    for (guint i = 0; i < N_VALUES; i++)
+      g_assert_cmpfloat (results[i], ==, phoc_easing_ease_fast (easing, values[i]));
+  }
+
+  /* In place */
+  phoc_easing_ease_batch (PHOC_EASING_EASE_OUT_CUBIC, values, values, N_VALUES);
+  g_assert_cmpfloat (values[0], ==, 0.0);
+  g_assert_cmpfloat (values[N_VALUES - 1], ==, 1.0);
+  g_assert_cmpfloat (values[(N_VALUES - 1) / 2], ==, 0.875);
+}
+
+
+gint
+main (gint argc, gchar *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/phoc/easing/fast", test_phoc_easing_fast);
+  g_test_add_func ("/phoc/easing/batch", test_phoc_easing_batch);
+
+  return g_test_run ();
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ * SPDX-License-Identifier: GPL-3.0+
+ */
+
+#include "pressed-keysyms.h"
+
+#define N_KEYBOARDS 64
+#define N_EVENTS    200000
+
+
+static void
+test_phoc_pressed_keysyms_add_remove (void)
+{
+  PhocPressedKeysyms pressed = { 0 };
+
+  g_assert_cmpint (phoc_pressed_keysyms_get_length (&pressed), ==, 0);
+
+  phoc_pressed_keysyms_add (&pressed, XKB_KEY_c);
+  phoc_pressed_keysyms_add (&pressed, XKB_KEY_a);
+  phoc_pressed_keysyms_add (&pressed, XKB_KEY_b);
+  /* Duplicates are ignored */
+  phoc_pressed_keysyms_add (&pressed, XKB_KEY_a);
+  /* So is NoSymbol */
+  phoc_pressed_keysyms_add (&pressed, XKB_KEY_NoSymbol);
+
+  g_assert_cmpint (phoc_pressed_keysyms_get_length (&pressed), ==, 3);
+  g_assert_cmpint (pressed.keysyms[0], ==, XKB_KEY_a);
+  g_assert_cmpint (pressed.keysyms[1], ==, XKB_KEY_b);
+  g_assert_cmpint (pressed.keysyms[2], ==, XKB_KEY_c);
+  g_assert_true (phoc_pressed_keysyms_contains (&pressed, XKB_KEY_b));
+  g_assert_false (phoc_pressed_keysyms_contains (&pressed, XKB_KEY_d));
+
+  phoc_pressed_keysyms_remove (&pressed, XKB_KEY_b);
+  g_assert_cmpint (phoc_pressed_keysyms_get_length (&pressed), ==, 2);
+  g_assert_false (phoc_pressed_keysyms_contains (&pressed, XKB_KEY_b));
+  g_assert_cmpint (pressed.keysyms[0], ==, XKB_KEY_a);
+  g_assert_cmpint (pressed.keysyms[1], ==, XKB_KEY_c);
+
+  /* Removing what isn't there is a noop */
+  phoc_pressed_keysyms_remove (&pressed, XKB_KEY_b);
+  g_assert_cmpint (phoc_pressed_keysyms_get_length (&pressed), ==, 2);
+
+  phoc_pressed_keysyms_remove (&pressed, XKB_KEY_a);
+  phoc_pressed_keysyms_remove (&pressed, XKB_KEY_c);
+  g_assert_cmpint (phoc_pressed_keysyms_get_length (&pressed), ==, 0);
+}
+
+
+static void
+test_phoc_pressed_keysyms_capacity (void)
+{
+  PhocPressedKeysyms pressed = { 0 };
+
+  for (int i = 0; i < PHOC_PRESSED_KEYSYMS_CAP + 5; i++)
+    phoc_pressed_keysyms_add (&pressed, XKB_KEY_A + i);
+
+  g_assert_cmpint (phoc_pressed_keysyms_get_length (&pressed), ==, PHOC_PRESSED_KEYSYMS_CAP);
+  g_assert_true (phoc_pressed_keysyms_contains (&pressed, XKB_KEY_A));
+  g_assert_false (phoc_pressed_keysyms_contains (&pressed, XKB_KEY_A + PHOC_PRESSED_KEYSYMS_CAP));
+}
+
+
+static void
+test_phoc_pressed_keysyms_update (void)
+{
+  PhocPressedKeysyms pressed = { 0 };
+  xkb_keysym_t keysyms[] = { XKB_KEY_Shift_L, XKB_KEY_a, XKB_KEY_Super_L };
+
+  phoc_pressed_keysyms_update (&pressed, keysyms, G_N_ELEMENTS (keysyms), TRUE);
+  /* Modifiers aren't tracked */
+  g_assert_cmpint (phoc_pressed_keysyms_get_length (&pressed), ==, 1);
+  g_assert_true (phoc_pressed_keysyms_contains (&pressed, XKB_KEY_a));
+
+  phoc_pressed_keysyms_update (&pressed, keysyms, G_N_ELEMENTS (keysyms), FALSE);
+  g_assert_cmpint (phoc_pressed_keysyms_get_length (&pressed), ==, 0);
+}
+
+/*
+ * Feed random key presses and releases from many keyboards. This
+ * only runs in perf mode (`-m perf`).
+ */
+static void
+test_phoc_pressed_keysyms_perf (void)
+{
+  g_autofree PhocPressedKeysyms *keyboards = g_new0 (PhocPressedKeysyms, N_KEYBOARDS);
+  g_autoptr (GRand) rand = g_rand_new_with_seed (0xcafe);
+  gdouble elapsed, per_event;
+  guint total = 0;
+
+  if (!g_test_perf ())
+    return;
+
+  g_test_timer_start ();
+  for (int i = 0; i < N_EVENTS; i++) {
+    for (int k = 0; k < N_KEYBOARDS; k++) {
+      xkb_keysym_t keysym = XKB_KEY_A + g_rand_int_range (rand, 0, 16);
+      gboolean press = g_rand_boolean (rand);
+
+      phoc_pressed_keysyms_update (&keyboards[k], &keysym, 1, press);
+      total += phoc_pressed_keysyms_get_length (&keyboards[k]);
+    }
+  }
+  elapsed = g_test_timer_elapsed ();
+
+  g_assert_cmpint (total, >, 0);
+  per_event = elapsed * G_USEC_PER_SEC * 1000 / ((gdouble)N_EVENTS * N_KEYBOARDS);
+  g_test_minimized_result (per_event, "Key event handling: %.2f ns per event", per_event);
+}
+
+
+gint
+main (gint argc, gchar *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/phoc/pressed-keysyms/add_remove", test_phoc_pressed_keysyms_add_remove);
+  g_test_add_func ("/phoc/pressed-keysyms/capacity", test_phoc_pressed_keysyms_capacity);
+  g_test_add_func ("/phoc/pressed-keysyms/update", test_phoc_pressed_keysyms_update);
+  g_test_add_func ("/phoc/pressed-keysyms/perf", test_phoc_pressed_keysyms_perf);
+
+  return g_test_run ();
+}
@@ -14,6 +14,7 @@ enum {
   PROP_0,
   PROP_I,
   PROP_F,
+  PROP_FAST,
   PROP_LAST_PROP
 };
 static GParamSpec *props[PROP_LAST_PROP];
@@ -23,10 +24,20 @@ struct _PhocTestObj {
 
   int                   prop_i;
   float                 prop_f;
+  float                 prop_fast;
+  guint                 n_fast_set;
 };
 G_DEFINE_TYPE (PhocTestObj, phoc_test_obj, G_TYPE_OBJECT)
 
 
+static void
+phoc_test_obj_set_prop_fast (PhocTestObj *self, float value)
+{
+  self->prop_fast = value;
+  self->n_fast_set++;
+}
+
+
 static void
 phoc_test_obj_set_property (GObject      *object,
                      guint         property_id,
@@ -42,6 +53,9 @@ phoc_test_obj_set_property (GObject      *object,
   case PROP_F:
     self->prop_f = g_value_get_float (value);
     break;
+  case PROP_FAST:
+    self->prop_fast = g_value_get_float (value);
+    break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     break;
@@ -64,6 +78,9 @@ phoc_test_obj_get_property (GObject    *object,
   case PROP_F:
     g_value_set_float (value, self->prop_f);
     break;
+  case PROP_FAST:
+    g_value_set_float (value, self->prop_fast);
+    break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     break;
@@ -92,7 +109,16 @@ phoc_test_obj_class_init (PhocTestObjClass *klass)
                         0.0,
                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
 
+  props[PROP_FAST] =
+    g_param_spec_float ("prop-fast", "", "",
+                        -1000.0,
+                        1000.0,
+                        0.0,
+                        G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
+  phoc_property_easer_install_float_setter (props[PROP_FAST],
+                                            (PhocPropertyEaserFloatSetter)phoc_test_obj_set_prop_fast);
 }
 
 
@@ -172,6 +198,37 @@ test_phoc_property_easer_props_variant (void)
 }
 
 
+static void
+test_phoc_property_easer_float_setter (void)
+{
+  g_autoptr (PhocTestObj) obj = phoc_test_obj_new ();
+  g_autoptr (PhocPropertyEaser) easer = NULL;
+
+  easer = g_object_new (PHOC_TYPE_PROPERTY_EASER,
+                        "target", obj,
+                        NULL);
+
+  phoc_property_easer_set_props (easer,
+                                 "prop-fast", 0.0, 10.0,
+                                 "prop-f", 0.0, 100.0,
+                                 NULL);
+  g_assert_cmpint (obj->n_fast_set, ==, 1);
+
+  phoc_property_easer_set_progress (easer, 0.5);
+  g_assert_cmpint (obj->n_fast_set, ==, 2);
+  g_assert_cmpfloat_with_epsilon (obj->prop_fast, 5.0, FLT_EPSILON);
+  g_assert_cmpfloat_with_epsilon (obj->prop_f, 50.0, FLT_EPSILON);
+
+  /* Setting a property again replaces it */
+  phoc_property_easer_set_props (easer, "prop-fast", 10.0, 20.0, NULL);
+  g_assert_cmpfloat_with_epsilon (obj->prop_fast, 10.0, FLT_EPSILON);
+
+  phoc_property_easer_set_progress (easer, 1.0);
+  g_assert_cmpfloat_with_epsilon (obj->prop_fast, 20.0, FLT_EPSILON);
+  g_assert_cmpfloat_with_epsilon (obj->prop_f, 100.0, FLT_EPSILON);
+}
+
+
 gint
 main (gint argc, gchar *argv[])
 {
@@ -179,6 +236,7 @@ main (gint argc, gchar *argv[])
 
   g_test_add_func("/phoc/propety-easer/va-list", test_phoc_property_easer_props_va_list);
   g_test_add_func("/phoc/propety-easer/variant", test_phoc_property_easer_props_variant);
+  g_test_add_func("/phoc/propety-easer/float-setter", test_phoc_property_easer_float_setter);
 
   return g_test_run();
 }
@@ -15,6 +15,8 @@ test_phoc_config_defaults (void)
 
   g_assert_true (config->xwayland);
   g_assert_true (config->xwayland_lazy);
+  g_assert_cmpint (config->resize_timeout, ==, PHOC_CONFIG_DEFAULT_RESIZE_TIMEOUT);
+  g_assert_cmpint (config->xwayland_idle_timeout, ==, 0);
   g_assert_cmpint (g_slist_length (config->outputs), ==, 0);
   g_assert_null (config->config_path);
 }
@@ -57,6 +59,32 @@ test_phoc_config_modelines (void)
 }
 
 
+static void
+test_phoc_config_resize_timeout (void)
+{
+  g_autoptr (PhocConfig) config1 = phoc_config_new_from_data (
+    "[core]\n"
+    "resize-timeout = 0\n");
+  g_autoptr (PhocConfig) config2 = phoc_config_new_from_data (
+    "[core]\n"
+    "resize-timeout = 500\n");
+
+  g_assert_cmpint (config1->resize_timeout, ==, 0);
+  g_assert_cmpint (config2->resize_timeout, ==, 500);
+}
+
+
+static void
+test_phoc_config_xwayland_idle_timeout (void)
+{
+  g_autoptr (PhocConfig) config = phoc_config_new_from_data (
+    "[core]\n"
+    "xwayland-idle-timeout = 30\n");
+
+  g_assert_cmpint (config->xwayland_idle_timeout, ==, 30);
+}
+
+
 gint
 main (gint argc, gchar *argv[])
 {
@@ -65,6 +93,9 @@ main (gint argc, gchar *argv[])
   g_test_add_func ("/phoc/config/simple", test_phoc_config_defaults);
   g_test_add_func ("/phoc/config/output", test_phoc_config_output);
   g_test_add_func ("/phoc/config/modelines", test_phoc_config_modelines);
+  g_test_add_func ("/phoc/config/resize-timeout", test_phoc_config_resize_timeout);
+  g_test_add_func ("/phoc/config/xwayland-idle-timeout",
+                   test_phoc_config_xwayland_idle_timeout);
 
   return g_test_run();
 }
@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ * SPDX-License-Identifier: GPL-3.0+
+ */
+
+#include "timeline.h"
+
+/* The timeline never dereferences the animatable */
+#define ANIMATABLE(x) ((PhocAnimatable *)GINT_TO_POINTER (x))
+
+typedef struct {
+  PhocTimeline *timeline;
+  guint         n_calls;
+  guint64       frame_time;
+  guint         remove_id;
+  gboolean      ret;
+} TestData;
+
+
+static gboolean
+on_frame (PhocAnimatable *animatable, guint64 frame_time, gpointer user_data)
+{
+  TestData *data = user_data;
+
+  data->n_calls++;
+  data->frame_time = frame_time;
+  if (data->remove_id)
+    g_assert_true (phoc_timeline_remove (data->timeline, data->remove_id));
+
+  return data->ret;
+}
+
+
+static void
+on_notify (gpointer user_data)
+{
+  guint *n_notified = user_data;
+
+  (*n_notified)++;
+}
+
+
+static void
+test_phoc_timeline_tick (void)
+{
+  g_autoptr (PhocTimeline) timeline = phoc_timeline_new ();
+  TestData data1 = { .timeline = timeline, .ret = G_SOURCE_CONTINUE };
+  TestData data2 = { .timeline = timeline, .ret = G_SOURCE_REMOVE };
+
+  phoc_timeline_add (timeline, ANIMATABLE (1), on_frame, &data1, NULL);
+  phoc_timeline_add (timeline, ANIMATABLE (1), on_frame, &data2, NULL);
+  g_assert_cmpint (phoc_timeline_get_n_callbacks (timeline), ==, 2);
+
+  phoc_timeline_tick (timeline, 1000);
+  g_assert_cmpint (data1.n_calls, ==, 1);
+  g_assert_cmpint (data2.n_calls, ==, 1);
+  /* All callbacks see the same frame time */
+  g_assert_cmpint (data1.frame_time, ==, 1000);
+  g_assert_cmpint (data2.frame_time, ==, 1000);
+  g_assert_cmpint (phoc_timeline_get_n_callbacks (timeline), ==, 1);
+
+  phoc_timeline_tick (timeline, 2000);
+  g_assert_cmpint (data1.n_calls, ==, 2);
+  g_assert_cmpint (data2.n_calls, ==, 1);
+  g_assert_cmpint (data1.frame_time, ==, 2000);
+}
+
+
+static void
+test_phoc_timeline_remove (void)
+{
+  g_autoptr (PhocTimeline) timeline = phoc_timeline_new ();
+  TestData data = { .timeline = timeline, .ret = G_SOURCE_CONTINUE };
+  TestData data3 = { .timeline = timeline, .ret = G_SOURCE_CONTINUE };
+  guint n_notified = 0;
+  guint id1, id2, id3;
+
+  id1 = phoc_timeline_add (timeline, ANIMATABLE (1), on_frame, &n_notified, on_notify);
+  id2 = phoc_timeline_add (timeline, ANIMATABLE (1), on_frame, &data, NULL);
+  g_assert_cmpint (id1, !=, 0);
+  g_assert_cmpint (id1, !=, id2);
+
+  g_assert_true (phoc_timeline_remove (timeline, id1));
+  g_assert_cmpint (n_notified, ==, 1);
+  g_assert_false (phoc_timeline_remove (timeline, id1));
+  g_assert_false (phoc_timeline_remove (timeline, 0));
+
+  /* The slot gets reused but the old id stays invalid */
+  id3 = phoc_timeline_add (timeline, ANIMATABLE (1), on_frame, &data3, NULL);
+  g_assert_cmpint (id3, !=, id1);
+  g_assert_false (phoc_timeline_remove (timeline, id1));
+  g_assert_cmpint (phoc_timeline_get_n_callbacks (timeline), ==, 2);
+
+  /* A callback removing another one during a tick */
+  data.remove_id = id3;
+  phoc_timeline_tick (timeline, 1000);
+  g_assert_cmpint (data.n_calls, ==, 1);
+  g_assert_cmpint (data3.n_calls, ==, 1);
+  g_assert_cmpint (phoc_timeline_get_n_callbacks (timeline), ==, 1);
+
+  g_assert_true (phoc_timeline_remove (timeline, id2));
+  g_assert_cmpint (phoc_timeline_get_n_callbacks (timeline), ==, 0);
+}
+
+
+typedef struct {
+  PhocTimeline *timeline;
+  TestData     *added;
+  guint         n_calls;
+} AddData;
+
+
+static gboolean
+on_frame_add (PhocAnimatable *animatable, guint64 frame_time, gpointer user_data)
+{
+  AddData *data = user_data;
+
+  data->n_calls++;
+  phoc_timeline_add (data->timeline, animatable, on_frame, data->added, NULL);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+test_phoc_timeline_add_during_tick (void)
+{
+  g_autoptr (PhocTimeline) timeline = phoc_timeline_new ();
+  TestData data1 = { .timeline = timeline, .ret = G_SOURCE_REMOVE };
+  TestData data2 = { .timeline = timeline, .ret = G_SOURCE_CONTINUE };
+  AddData add_data = { .timeline = timeline, .added = &data2 };
+
+  /* The first callback frees its slot, the second one adds a callback
+   * that reuses it */
+  phoc_timeline_add (timeline, ANIMATABLE (1), on_frame, &data1, NULL);
+  phoc_timeline_add (timeline, ANIMATABLE (1), on_frame_add, &add_data, NULL);
+
+  phoc_timeline_tick (timeline, 1000);
+  g_assert_cmpint (data1.n_calls, ==, 1);
+  g_assert_cmpint (add_data.n_calls, ==, 1);
+  g_assert_cmpint (data2.n_calls, ==, 0);
+  g_assert_cmpint (phoc_timeline_get_n_callbacks (timeline), ==, 1);
+
+  phoc_timeline_tick (timeline, 2000);
+  g_assert_cmpint (data2.n_calls, ==, 1);
+  g_assert_cmpint (data2.frame_time, ==, 2000);
+}
+
+
+static void
+test_phoc_timeline_remove_by_animatable (void)
+{
+  g_autoptr (PhocTimeline) timeline = phoc_timeline_new ();
+  TestData data = { .timeline = timeline, .ret = G_SOURCE_CONTINUE };
+  guint n_notified = 0;
+
+  phoc_timeline_add (timeline, ANIMATABLE (1), on_frame, &n_notified, on_notify);
+  phoc_timeline_add (timeline, ANIMATABLE (2), on_frame, &data, NULL);
+  phoc_timeline_add (timeline, ANIMATABLE (1), on_frame, &n_notified, on_notify);
+
+  g_assert_cmpint (phoc_timeline_remove_by_animatable (timeline, ANIMATABLE (1)), ==, 2);
+  g_assert_cmpint (n_notified, ==, 2);
+  g_assert_cmpint (phoc_timeline_get_n_callbacks (timeline), ==, 1);
+
+  phoc_timeline_tick (timeline, 1000);
+  g_assert_cmpint (data.n_calls, ==, 1);
+}
+
+
+static void
+test_phoc_timeline_free (void)
+{
+  PhocTimeline *timeline = phoc_timeline_new ();
+  guint n_notified = 0;
+
+  phoc_timeline_add (timeline, ANIMATABLE (1), on_frame, &n_notified, on_notify);
+  phoc_timeline_add (timeline, ANIMATABLE (2), on_frame, &n_notified, on_notify);
+
+  phoc_timeline_free (timeline);
+  g_assert_cmpint (n_notified, ==, 2);
+}
+
+
+gint
+main (gint argc, gchar *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/phoc/timeline/tick", test_phoc_timeline_tick);
+  g_test_add_func ("/phoc/timeline/remove", test_phoc_timeline_remove);
+  g_test_add_func ("/phoc/timeline/add_during_tick", test_phoc_timeline_add_during_tick);
+  g_test_add_func ("/phoc/timeline/remove_by_animatable", test_phoc_timeline_remove_by_animatable);
+  g_test_add_func ("/phoc/timeline/free", test_phoc_timeline_free);
+
+  return g_test_run ();
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ * SPDX-License-Identifier: GPL-3.0+
+ */
+
+#include "touch-resampler.h"
+
+#define MS(x) ((gint64)(x) * 1000)
+
+
+static void
+test_phoc_touch_resampler_empty (void)
+{
+  PhocTouchResampler resampler = { 0 };
+  double x = -1, y = -1;
+
+  g_assert_false (phoc_touch_resampler_get_position (&resampler, MS (10), &x, &y));
+
+  phoc_touch_resampler_add_sample (&resampler, MS (10), 5, 6);
+  g_assert_true (phoc_touch_resampler_get_position (&resampler, MS (100), &x, &y));
+  g_assert_cmpfloat (x, ==, 5);
+  g_assert_cmpfloat (y, ==, 6);
+
+  phoc_touch_resampler_reset (&resampler);
+  g_assert_false (phoc_touch_resampler_get_position (&resampler, MS (10), &x, &y));
+}
+
+
+static void
+test_phoc_touch_resampler_interpolate (void)
+{
+  PhocTouchResampler resampler = { 0 };
+  double x, y;
+
+  phoc_touch_resampler_add_sample (&resampler, MS (0), 0, 0);
+  phoc_touch_resampler_add_sample (&resampler, MS (10), 100, 10);
+  phoc_touch_resampler_add_sample (&resampler, MS (20), 200, 20);
+
+  /* Resampling happens 5ms before the target time */
+  g_assert_true (phoc_touch_resampler_get_position (&resampler, MS (20), &x, &y));
+  g_assert_cmpfloat_with_epsilon (x, 150, 0.001);
+  g_assert_cmpfloat_with_epsilon (y, 15, 0.001);
+
+  /* Older than the oldest sample */
+  g_assert_true (phoc_touch_resampler_get_position (&resampler, MS (10), &x, &y));
+  g_assert_cmpfloat (x, ==, 100);
+  g_assert_cmpfloat (y, ==, 10);
+}
+
+
+static void
+test_phoc_touch_resampler_extrapolate (void)
+{
+  PhocTouchResampler resampler = { 0 };
+  double x, y;
+
+  phoc_touch_resampler_add_sample (&resampler, MS (0), 0, 0);
+  phoc_touch_resampler_add_sample (&resampler, MS (10), 100, 0);
+
+  /* 2ms after the last sample */
+  g_assert_true (phoc_touch_resampler_get_position (&resampler, MS (17), &x, &y));
+  g_assert_cmpfloat_with_epsilon (x, 120, 0.001);
+
+  /* Prediction is capped at half the sample interval */
+  g_assert_true (phoc_touch_resampler_get_position (&resampler, MS (30), &x, &y));
+  g_assert_cmpfloat_with_epsilon (x, 150, 0.001);
+
+  /* Stale samples aren't extrapolated */
+  g_assert_true (phoc_touch_resampler_get_position (&resampler, MS (100), &x, &y));
+  g_assert_cmpfloat (x, ==, 100);
+
+  /* Neither are samples too far apart */
+  phoc_touch_resampler_add_sample (&resampler, MS (50), 200, 0);
+  g_assert_true (phoc_touch_resampler_get_position (&resampler, MS (60), &x, &y));
+  g_assert_cmpfloat (x, ==, 200);
+}
+
+
+static void
+test_phoc_touch_resampler_same_time (void)
+{
+  PhocTouchResampler resampler = { 0 };
+  double x, y;
+
+  phoc_touch_resampler_add_sample (&resampler, MS (0), 0, 0);
+  phoc_touch_resampler_add_sample (&resampler, MS (10), 100, 0);
+  /* Replaces the last sample */
+  phoc_touch_resampler_add_sample (&resampler, MS (10), 50, 0);
+
+  g_assert_cmpint (resampler.n_samples, ==, 2);
+  g_assert_true (phoc_touch_resampler_get_position (&resampler, MS (10), &x, &y));
+  g_assert_cmpfloat_with_epsilon (x, 25, 0.001);
+}
+
+
+static void
+test_phoc_touch_resampler_event_time (void)
+{
+  gint64 now = MS (G_MAXUINT32) + MS (5);
+
+  g_assert_cmpint (phoc_touch_resampler_event_time_to_us (1000, MS (1010)), ==, MS (1000));
+  /* Event time wrapped around but the monotonic clock didn't */
+  g_assert_cmpint (phoc_touch_resampler_event_time_to_us (2, now), ==, now - MS (2));
+  /* Event from just before the wrap around */
+  g_assert_cmpint (phoc_touch_resampler_event_time_to_us (G_MAXUINT32, now), ==,
+                   MS (G_MAXUINT32));
+}
+
+
+gint
+main (gint argc, gchar *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/phoc/touch-resampler/empty", test_phoc_touch_resampler_empty);
+  g_test_add_func ("/phoc/touch-resampler/interpolate", test_phoc_touch_resampler_interpolate);
+  g_test_add_func ("/phoc/touch-resampler/extrapolate", test_phoc_touch_resampler_extrapolate);
+  g_test_add_func ("/phoc/touch-resampler/same-time", test_phoc_touch_resampler_same_time);
+  g_test_add_func ("/phoc/touch-resampler/event-time", test_phoc_touch_resampler_event_time);
+
+  return g_test_run ();
+}
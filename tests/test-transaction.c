@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ * SPDX-License-Identifier: GPL-3.0+
+ */
+
+#include "transaction.h"
+
+/* The transaction only uses views as GObjects */
+#define VIEW(x) ((PhocView *)(x))
+
+
+static void
+on_done (PhocTransaction *transaction, gpointer user_data)
+{
+  guint *n_done = user_data;
+
+  (*n_done)++;
+}
+
+
+static void
+test_phoc_transaction_commit (void)
+{
+  g_autoptr (PhocTransaction) transaction = phoc_transaction_new (1000);
+  g_autoptr (GObject) view1 = g_object_new (G_TYPE_OBJECT, NULL);
+  g_autoptr (GObject) view2 = g_object_new (G_TYPE_OBJECT, NULL);
+  g_autoptr (GList) views = NULL;
+  guint n_done = 0;
+
+  g_signal_connect (transaction, "done", G_CALLBACK (on_done), &n_done);
+
+  phoc_transaction_begin (transaction);
+  g_assert_true (phoc_transaction_is_collecting (transaction));
+  phoc_transaction_add_configure (transaction, VIEW (view1), 10);
+  phoc_transaction_add_configure (transaction, VIEW (view2), 20);
+  /* A later configure replaces the earlier one */
+  phoc_transaction_add_configure (transaction, VIEW (view1), 11);
+  g_assert_false (phoc_transaction_is_pending (transaction));
+  phoc_transaction_commit (transaction);
+
+  g_assert_false (phoc_transaction_is_collecting (transaction));
+  g_assert_true (phoc_transaction_is_pending (transaction));
+  g_assert_cmpint (phoc_transaction_get_n_views (transaction), ==, 2);
+
+  /* Commit for an older configure */
+  phoc_transaction_notify_commit (transaction, VIEW (view1), 10);
+  g_assert_cmpint (phoc_transaction_get_n_views (transaction), ==, 2);
+
+  phoc_transaction_notify_commit (transaction, VIEW (view1), 11);
+  g_assert_cmpint (phoc_transaction_get_n_views (transaction), ==, 1);
+  views = phoc_transaction_get_views (transaction);
+  g_assert_cmpint (g_list_length (views), ==, 1);
+  g_assert_true (views->data == view2);
+  g_assert_cmpint (n_done, ==, 0);
+
+  phoc_transaction_notify_commit (transaction, VIEW (view2), 21);
+  g_assert_cmpint (phoc_transaction_get_n_views (transaction), ==, 0);
+  g_assert_false (phoc_transaction_is_pending (transaction));
+  g_assert_cmpint (n_done, ==, 1);
+}
+
+
+static void
+test_phoc_transaction_empty (void)
+{
+  g_autoptr (PhocTransaction) transaction = phoc_transaction_new (1000);
+  guint n_done = 0;
+
+  g_signal_connect (transaction, "done", G_CALLBACK (on_done), &n_done);
+
+  /* Nothing to wait for, done right away */
+  phoc_transaction_begin (transaction);
+  phoc_transaction_begin (transaction);
+  phoc_transaction_commit (transaction);
+  g_assert_cmpint (n_done, ==, 0);
+  phoc_transaction_commit (transaction);
+  g_assert_cmpint (n_done, ==, 1);
+  g_assert_false (phoc_transaction_is_pending (transaction));
+}
+
+
+static void
+test_phoc_transaction_remove (void)
+{
+  g_autoptr (PhocTransaction) transaction = phoc_transaction_new (1000);
+  g_autoptr (GObject) view1 = g_object_new (G_TYPE_OBJECT, NULL);
+  GObject *view2 = g_object_new (G_TYPE_OBJECT, NULL);
+  guint n_done = 0;
+
+  g_signal_connect (transaction, "done", G_CALLBACK (on_done), &n_done);
+
+  phoc_transaction_begin (transaction);
+  phoc_transaction_add_configure (transaction, VIEW (view1), 1);
+  phoc_transaction_add_configure (transaction, VIEW (view2), 1);
+  phoc_transaction_commit (transaction);
+
+  phoc_transaction_remove_view (transaction, VIEW (view1));
+  g_assert_cmpint (n_done, ==, 0);
+
+  /* Views going away don't hold up the transaction */
+  g_object_unref (view2);
+  g_assert_cmpint (n_done, ==, 1);
+}
+
+
+static void
+test_phoc_transaction_timeout (void)
+{
+  g_autoptr (PhocTransaction) transaction = phoc_transaction_new (10);
+  g_autoptr (GObject) view = g_object_new (G_TYPE_OBJECT, NULL);
+  guint n_done = 0;
+
+  g_signal_connect (transaction, "done", G_CALLBACK (on_done), &n_done);
+
+  phoc_transaction_begin (transaction);
+  phoc_transaction_add_configure (transaction, VIEW (view), 1);
+  phoc_transaction_commit (transaction);
+  g_assert_true (phoc_transaction_is_pending (transaction));
+
+  while (n_done == 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmpint (n_done, ==, 1);
+  g_assert_false (phoc_transaction_is_pending (transaction));
+
+  /* A late commit is ignored */
+  phoc_transaction_notify_commit (transaction, VIEW (view), 1);
+  g_assert_cmpint (n_done, ==, 1);
+}
+
+
+gint
+main (gint argc, gchar *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/phoc/transaction/commit", test_phoc_transaction_commit);
+  g_test_add_func ("/phoc/transaction/empty", test_phoc_transaction_empty);
+  g_test_add_func ("/phoc/transaction/remove", test_phoc_transaction_remove);
+  g_test_add_func ("/phoc/transaction/timeout", test_phoc_transaction_timeout);
+
+  return g_test_run ();
+}
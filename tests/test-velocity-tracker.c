@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2023 The Phosh Developers
+ * SPDX-License-Identifier: GPL-3.0+
+ */
+
+#include "velocity-tracker.h"
+
+
+static void
+test_phoc_velocity_tracker_not_enough_points (void)
+{
+  PhocVelocityTracker tracker = { 0 };
+  double vx = -1, vy = -1;
+
+  g_assert_false (phoc_velocity_tracker_get_velocity (&tracker, &vx, &vy));
+  g_assert_cmpfloat (vx, ==, 0);
+  g_assert_cmpfloat (vy, ==, 0);
+
+  phoc_velocity_tracker_add_point (&tracker, 100, 10, 10);
+  g_assert_false (phoc_velocity_tracker_get_velocity (&tracker, &vx, &vy));
+
+  /* Same timestamp replaces the point */
+  phoc_velocity_tracker_add_point (&tracker, 100, 20, 20);
+  g_assert_cmpint (tracker.n_samples, ==, 1);
+  g_assert_false (phoc_velocity_tracker_get_velocity (&tracker, &vx, &vy));
+}
+
+
+static void
+test_phoc_velocity_tracker_linear (void)
+{
+  PhocVelocityTracker tracker = { 0 };
+  double vx, vy;
+
+  /* 1px/ms along x, -2px/ms along y, more points than we keep */
+  for (int i = 0; i < 50; i++)
+    phoc_velocity_tracker_add_point (&tracker, 1000 + i * 8, i * 8, -i * 16);
+
+  g_assert_true (phoc_velocity_tracker_get_velocity (&tracker, &vx, &vy));
+  g_assert_cmpfloat_with_epsilon (vx, 1000, 0.001);
+  g_assert_cmpfloat_with_epsilon (vy, -2000, 0.001);
+}
+
+
+static void
+test_phoc_velocity_tracker_jitter (void)
+{
+  PhocVelocityTracker tracker = { 0 };
+  double vx;
+
+  /* Alternating +-2px noise shouldn't matter much */
+  for (int i = 0; i < 12; i++)
+    phoc_velocity_tracker_add_point (&tracker, i * 8, i * 4 + ((i % 2) ? 2 : -2), 0);
+
+  g_assert_true (phoc_velocity_tracker_get_velocity (&tracker, &vx, NULL));
+  g_assert_cmpfloat_with_epsilon (vx, 500, 50);
+}
+
+
+static void
+test_phoc_velocity_tracker_stopped (void)
+{
+  PhocVelocityTracker tracker = { 0 };
+  double vx;
+
+  for (int i = 0; i < 10; i++)
+    phoc_velocity_tracker_add_point (&tracker, i * 10, i * 10, 0);
+
+  /* Pause before the last point: the finger stopped */
+  phoc_velocity_tracker_add_point (&tracker, 200, 90, 0);
+  g_assert_false (phoc_velocity_tracker_get_velocity (&tracker, &vx, NULL));
+  g_assert_cmpfloat (vx, ==, 0);
+
+  /* Old points fall out of the window */
+  phoc_velocity_tracker_reset (&tracker);
+  phoc_velocity_tracker_add_point (&tracker, 0, 0, 0);
+  for (int i = 0; i < 10; i++)
+    phoc_velocity_tracker_add_point (&tracker, 30 + i * 30, 1000 + i * 30, 0);
+  g_assert_true (phoc_velocity_tracker_get_velocity (&tracker, &vx, NULL));
+  g_assert_cmpfloat_with_epsilon (vx, 1000, 0.001);
+}
+
+
+static void
+test_phoc_velocity_tracker_wrap (void)
+{
+  PhocVelocityTracker tracker = { 0 };
+  double vx;
+
+  for (int i = 0; i < 10; i++)
+    phoc_velocity_tracker_add_point (&tracker, G_MAXUINT32 - 40 + i * 10, i * 5, 0);
+
+  g_assert_true (phoc_velocity_tracker_get_velocity (&tracker, &vx, NULL));
+  g_assert_cmpfloat_with_epsilon (vx, 500, 0.001);
+}
+
+
+gint
+main (gint argc, gchar *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/phoc/velocity-tracker/not-enough-points",
+                   test_phoc_velocity_tracker_not_enough_points);
+  g_test_add_func ("/phoc/velocity-tracker/linear", test_phoc_velocity_tracker_linear);
+  g_test_add_func ("/phoc/velocity-tracker/jitter", test_phoc_velocity_tracker_jitter);
+  g_test_add_func ("/phoc/velocity-tracker/stopped", test_phoc_velocity_tracker_stopped);
+  g_test_add_func ("/phoc/velocity-tracker/wrap", test_phoc_velocity_tracker_wrap);
+
+  return g_test_run ();
+}
@@ -152,9 +152,6 @@ output_handle_mode (void *data, struct wl_output *wl_output,
   PhocTestOutput *output = data;
 
   if ((flags & WL_OUTPUT_MODE_CURRENT) != 0) {
-    /* Make sure we got the right mode to not mess up screenshot comparisons */
-    g_assert_cmpint (width, ==, 1024);
-    g_assert_cmpint (height, ==, 768);
     output->width = width;
     output->height = height;
   }
@@ -330,6 +327,9 @@ static void registry_handle_global(void *data, struct wl_registry *registry,
   } else if (!g_strcmp0 (interface, zxdg_decoration_manager_v1_interface.name)) {
     globals->decoration_manager = wl_registry_bind (registry, name,
                                                      &zxdg_decoration_manager_v1_interface, 1);
+  } else if (!g_strcmp0 (interface, zwlr_virtual_pointer_manager_v1_interface.name)) {
+    globals->virtual_pointer_manager = wl_registry_bind (registry, name,
+                                                         &zwlr_virtual_pointer_manager_v1_interface, 1);
   }
 }
 
@@ -371,6 +371,7 @@ wl_client_run (GTask *task, gpointer source,
   else
     success = TRUE;
 
+  g_clear_pointer (&globals.virtual_pointer_manager, zwlr_virtual_pointer_manager_v1_destroy);
   g_clear_pointer (&globals.decoration_manager, zxdg_decoration_manager_v1_destroy);
   wl_proxy_destroy ((struct wl_proxy *)globals.gtk_shell1);
   wl_proxy_destroy ((struct wl_proxy *)globals.phosh);
@@ -594,7 +595,13 @@ PhocTestBuffer *
 phoc_test_client_capture_output (PhocTestClientGlobals *globals,
                                  PhocTestOutput *output)
 {
-  struct zwlr_screencopy_frame_v1 *handle = zwlr_screencopy_manager_v1_capture_output (globals->screencopy_manager, FALSE, output->output);
+  struct zwlr_screencopy_frame_v1 *handle;
+
+  /* Make sure we got the right mode to not mess up screenshot comparisons */
+  g_assert_cmpint (output->width, ==, 1024);
+  g_assert_cmpint (output->height, ==, 768);
+
+  handle = zwlr_screencopy_manager_v1_capture_output (globals->screencopy_manager, FALSE, output->output);
   phoc_test_client_capture_frame (globals, &output->screenshot, handle);
 
   g_assert_cmpint (output->screenshot.buffer.width, ==, output->width);
@@ -946,17 +953,21 @@ phoc_test_xdg_update_buffer (PhocTestClientGlobals      *globals,
  *
  * Sets up a test environment for the with compositor and access to DBus.
  * function is meant to be used with g_test_add().
+ *
+ * The compositor uses the x11 backend. If `PHOC_TEST_HEADLESS` is set or
+ * there's no X server it renders offscreen using the headless backend
+ * and the pixman renderer instead.
  */
 void
 phoc_test_setup (PhocTestFixture *fixture, gconstpointer data)
 {
-  const char *display;
+  g_autofree char *display = NULL;
   g_autoptr (GError) err = NULL;
 
   fixture->bus = g_test_dbus_new (G_TEST_DBUS_NONE);
 
   /* Preserve x11 display for xvfb-run */
-  display = g_getenv ("DISPLAY");
+  display = g_strdup (g_getenv ("DISPLAY"));
 
   g_test_dbus_up (fixture->bus);
 
@@ -966,8 +977,15 @@ phoc_test_setup (PhocTestFixture *fixture, gconstpointer data)
   g_assert_no_error (err);
 
   g_setenv ("XDG_RUNTIME_DIR", fixture->tmpdir, TRUE);
-  g_setenv ("DISPLAY", display, TRUE);
-  g_setenv ("WLR_BACKENDS", "x11", TRUE);
+
+  /* Render offscreen when asked to or when there's no X server */
+  if (g_getenv ("PHOC_TEST_HEADLESS") || display == NULL) {
+    g_setenv ("WLR_BACKENDS", "headless", TRUE);
+    g_setenv ("WLR_RENDERER", "pixman", TRUE);
+  } else {
+    g_setenv ("DISPLAY", display, TRUE);
+    g_setenv ("WLR_BACKENDS", "x11", TRUE);
+  }
 }
 
 static void
@@ -1010,17 +1028,18 @@ phoc_test_remove_tree (GFile *file)
 void
 phoc_test_teardown (PhocTestFixture *fixture, gconstpointer unused)
 {
-  const char *display;
+  g_autofree char *display = NULL;
 
   g_autoptr (GFile) file = g_file_new_for_path (fixture->tmpdir);
 
   /* Preserve x11 display for xvfb-run */
-  display = g_getenv ("DISPLAY");
+  display = g_strdup (g_getenv ("DISPLAY"));
 
   g_test_dbus_down (fixture->bus);
   g_clear_object (&fixture->bus);
 
-  g_setenv ("DISPLAY", display, TRUE);
+  if (display)
+    g_setenv ("DISPLAY", display, TRUE);
   phoc_test_remove_tree (file);
   g_free (fixture->tmpdir);
 }
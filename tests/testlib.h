@@ -12,6 +12,7 @@
 #include "wlr-foreign-toplevel-management-unstable-v1-client-protocol.h"
 #include "wlr-layer-shell-unstable-v1-client-protocol.h"
 #include "wlr-screencopy-unstable-v1-client-protocol.h"
+#include "wlr-virtual-pointer-unstable-v1-client-protocol.h"
 #include "phosh-private-client-protocol.h"
 #include "phoc-layer-shell-effects-unstable-v1-client-protocol.h"
 
@@ -52,6 +53,7 @@ typedef struct _PhocTestWlGlobals {
   struct zwlr_screencopy_manager_v1 *screencopy_manager;
   struct zwlr_foreign_toplevel_manager_v1 *foreign_toplevel_manager;
   struct zxdg_decoration_manager_v1 *decoration_manager;
+  struct zwlr_virtual_pointer_manager_v1 *virtual_pointer_manager;
   GSList *foreign_toplevels;
   struct phosh_private *phosh;
   struct gtk_shell1 *gtk_shell1;